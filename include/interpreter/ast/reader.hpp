@@ -0,0 +1,530 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include "interpreter/lexer/tokens.hpp"
+#include "visitor.hpp"
+
+namespace interpreter::ast {
+
+namespace details {
+
+using LexType = lexer::LexType;
+
+struct ParseResult {
+ public:
+  enum { FAILURE = false, SUCCESS = true };
+  constexpr ParseResult(bool result) noexcept : result(result) {}
+
+  [[nodiscard]] constexpr operator bool() const noexcept { return result; }
+  bool result;
+};
+
+// TODO: Is that ok?
+[[nodiscard]] constexpr VariableType MapType(LexType type) {
+  switch (type) {
+    case LexType::TYPE_INT:
+      return VariableType::INT;
+    case LexType::TYPE_REAL:
+      return VariableType::REAL;
+    case LexType::TYPE_STR:
+      return VariableType::STR;
+    case LexType::TYPE_BOOL:
+      return VariableType::BOOL;
+    default:
+      break;
+  }
+
+  throw SyntaxError{"Unexpected lexeme"};
+}
+
+[[nodiscard]] constexpr CompareType MapCompare(LexType type) {
+  switch (type) {
+    case LexType::LT:
+      return CompareType::LT;
+    case LexType::GT:
+      return CompareType::GT;
+    case LexType::LE:
+      return CompareType::LE;
+    case LexType::GE:
+      return CompareType::GE;
+    case LexType::EQ:
+      return CompareType::EQ;
+    case LexType::NE:
+      return CompareType::NE;
+    default:
+      break;
+  }
+
+  throw SyntaxError{"Unexpected lexeme"};
+}
+
+[[nodiscard]] constexpr MulType MapMul(LexType type) {
+  switch (type) {
+    case LexType::MUL:
+      return MulType::MUL;
+    case LexType::DIV:
+      return MulType::DIV;
+    case LexType::MOD:
+      return MulType::MOD;
+    default:
+      break;
+  }
+
+  throw SyntaxError{"Unexpected lexeme"};
+}
+
+constexpr LexType Validated(LexType type, LexType required_type) {
+  // TODO: looks like clang-format bug, fix this
+  if (type != required_type) [[unlikely]] {
+      throw SyntaxError{"Unexpected Lexeme"};
+    }
+  return type;
+}
+
+template <typename TPredicate>
+constexpr LexType Validated(LexType type, TPredicate&& predicate) {
+  if (!std::forward<TPredicate>(predicate)(type)) [[unlikely]] {
+      throw SyntaxError{"Unexpected Lexeme"};
+    }
+  return type;
+}
+
+// Walks the lexems of the program by the index, the names are interned by
+// the lexer
+class ModelReader {
+ public:
+  explicit ModelReader() = delete;
+  explicit constexpr ModelReader(const lexer::TokenBuffer& tokens,
+                                 ModelVisitor& visitor)
+      : tokens_{tokens}, visitor_{visitor} {}
+
+  // Stays at the constant
+  constexpr Constant GetConstant() const {
+    // waiting for c++20 using enums
+    switch (Validated(Current(), lexer::IsConstant)) {
+      case LexType::VALUE_INT:
+        return {VariableType::INT, tokens_.GetInt(position_)};
+      case LexType::VALUE_REAL:
+        return {VariableType::REAL, tokens_.GetReal(position_)};
+      case LexType::VALUE_STR:
+        return {VariableType::STR,
+                lexer::Unescape(tokens_.GetString(position_))};
+      default:
+        return {VariableType::BOOL, Current() == LexType::TRUE};
+    }
+  }
+
+  constexpr ParseResult VisitAtom() {
+    if (Current() == LexType::OPENING_PARENTHESIS) {
+      MoveNext();
+      if (VisitExpression() == ParseResult::FAILURE) {
+        throw ParseExpressionError{"Expression parse error"};
+      }
+      Validated(Current(), LexType::CLOSING_PARENTHESIS);
+      MoveNext();
+
+      return ParseResult::SUCCESS;
+    }
+
+    if (Current() == LexType::ID) {
+      const auto symbol = tokens_.GetSymbol(position_);
+      visitor_.VisitVariableInvokation(symbol, tokens_.GetName(symbol));
+      MoveNext();
+      return ParseResult::SUCCESS;
+    }
+
+    if (lexer::IsConstant(Current())) {
+      visitor_.VisitConstantInvokation(GetConstant());
+      MoveNext();
+      return ParseResult::SUCCESS;
+    }
+
+    return ParseResult::FAILURE;
+  }
+
+  constexpr ParseResult VisitNot() {
+    bool has_not = false;
+    if (Current() == LexType::NOT) {
+      has_not = true;
+      MoveNext();
+    }
+
+    const auto atom_result = VisitAtom();
+    if (has_not && atom_result == ParseResult::FAILURE) {
+      throw ParseExpressionError{"Missing expression after not"};
+    }
+    if (has_not) {
+      visitor_.VisitNot();
+    }
+    return atom_result;
+  }
+
+  constexpr ParseResult VisitMul() {
+    if (VisitNot() == ParseResult::FAILURE) {
+      return ParseResult::FAILURE;
+    }
+
+    while (Current() == LexType::MUL || Current() == LexType::DIV ||
+           Current() == LexType::MOD) {
+      const auto mul_type = MapMul(Current());
+      MoveNext();
+      if (VisitNot() == ParseResult::FAILURE) {
+        throw ParseExpressionError{"Expression parse error"};
+      }
+      visitor_.VisitMul(mul_type);
+    }
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitAdd() {
+    if (VisitMul() == ParseResult::FAILURE) {
+      return ParseResult::FAILURE;
+    }
+
+    while (Current() == LexType::PLUS ||
+           Current() == LexType::MINUS) {
+      const auto add_type =
+          Current() == LexType::PLUS ? AddType::PLUS : AddType::MINUS;
+
+      MoveNext();
+      if (VisitMul() == ParseResult::FAILURE) {
+        throw ParseExpressionError{"Expression parse error"};
+      }
+      visitor_.VisitAdd(add_type);
+    }
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitCompare() {
+    if (VisitAdd() == ParseResult::FAILURE) {
+      return ParseResult::FAILURE;
+    }
+
+    while (lexer::IsCompare(Current())) {
+      const auto compare_type = MapCompare(Current());
+      MoveNext();
+      if (VisitAdd() == ParseResult::FAILURE) {
+        throw ParseExpressionError{"Expression parse error"};
+      }
+      visitor_.VisitCompare(compare_type);
+    }
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitAnd() {
+    if (VisitCompare() == ParseResult::FAILURE) {
+      return ParseResult::FAILURE;
+    }
+
+    while (Current() == LexType::AND) {
+      MoveNext();
+      visitor_.VisitAndRightOperand();
+      if (VisitCompare() == ParseResult::FAILURE) {
+        throw ParseExpressionError{"Expression parse error"};
+      }
+      visitor_.VisitAnd();
+    }
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitOr() {
+    if (VisitAnd() == ParseResult::FAILURE) {
+      return ParseResult::FAILURE;
+    }
+
+    while (Current() == LexType::OR) {
+      MoveNext();
+      visitor_.VisitOrRightOperand();
+      if (VisitAnd() == ParseResult::FAILURE) {
+        throw ParseExpressionError{"Expression parse error"};
+      }
+      visitor_.VisitOr();
+    }
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitAssign() {
+    if (VisitOr() == ParseResult::FAILURE) {
+      return ParseResult::FAILURE;
+    }
+
+    size_t assign_count = 0;
+    while (Current() == LexType::ASSIGN) {
+      MoveNext();
+      if (VisitOr() == ParseResult::FAILURE) {
+        throw ParseExpressionError{"Expression parse error"};
+      }
+      ++assign_count;
+    }
+
+    while (assign_count--) {
+      visitor_.VisitAssign();
+    }
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitExpression() { return VisitAssign(); }
+
+  constexpr ParseResult VisitExpressionOperator() {
+    if (VisitExpression() == ParseResult::FAILURE) {
+      return ParseResult::FAILURE;
+    }
+    Validated(Current(), LexType::SEMICOLON);
+
+    visitor_.VisitExpressionOperator();
+
+    MoveNext();
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitCompoundOperator() {
+    if (Current() != LexType::OPENING_BRACE) {
+      return ParseResult::FAILURE;
+    }
+    MoveNext();
+    VisitOperators();
+    Validated(Current(), LexType::CLOSING_BRACE);
+    MoveNext();
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitWrite() {
+    if (Current() != LexType::WRITE) {
+      return ParseResult::FAILURE;
+    }
+
+    Validated(MoveNext(), LexType::OPENING_PARENTHESIS);
+
+    do {
+      MoveNext();
+      if (VisitExpression() == ParseResult::FAILURE) {
+        throw ParseExpressionError{"Expression parse error"};
+      }
+      visitor_.VisitWrite();
+    } while (Current() == LexType::COMMA);
+
+    Validated(Current(), LexType::CLOSING_PARENTHESIS);
+    Validated(MoveNext(), LexType::SEMICOLON);
+    MoveNext();
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitRead() {
+    if (Current() != LexType::READ) {
+      return ParseResult::FAILURE;
+    }
+
+    Validated(MoveNext(), LexType::OPENING_PARENTHESIS);
+
+    Validated(MoveNext(), LexType::ID);
+    const auto symbol = tokens_.GetSymbol(position_);
+    visitor_.VisitRead(symbol, tokens_.GetName(symbol));
+
+    Validated(MoveNext(), LexType::CLOSING_PARENTHESIS);
+    Validated(MoveNext(), LexType::SEMICOLON);
+
+    MoveNext();
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitContinue() {
+    if (Current() != LexType::CONTINUE) {
+      return ParseResult::FAILURE;
+    }
+    Validated(MoveNext(), LexType::SEMICOLON);
+    visitor_.VisitContinue();
+    MoveNext();
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitBreak() {
+    if (Current() != LexType::BREAK) {
+      return ParseResult::FAILURE;
+    }
+    Validated(MoveNext(), LexType::SEMICOLON);
+    visitor_.VisitBreak();
+    MoveNext();
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitDoWhile() {
+    if (Current() != LexType::DO) {
+      return ParseResult::FAILURE;
+    }
+    visitor_.VisitDoWhile();
+
+    MoveNext();
+    if (VisitOperator() == ParseResult::FAILURE) {
+      throw ParseOperatorError{"Failed to parse do-while operator"};
+    }
+
+    Validated(Current(), LexType::WHILE);
+    Validated(MoveNext(), LexType::OPENING_PARENTHESIS);
+
+    MoveNext();
+    if (VisitExpression() == ParseResult::FAILURE) {
+      throw ParseOperatorError{"Failed to parse do-while expression"};
+    }
+
+    Validated(Current(), LexType::CLOSING_PARENTHESIS);
+    Validated(MoveNext(), LexType::SEMICOLON);
+    visitor_.VisitDoWhileEnd();
+
+    MoveNext();
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitWhile() {
+    if (Current() != LexType::WHILE) {
+      return ParseResult::FAILURE;
+    }
+    visitor_.VisitWhile();
+
+    Validated(MoveNext(), LexType::OPENING_PARENTHESIS);
+    MoveNext();
+    if (VisitExpression() == ParseResult::FAILURE) {
+      throw ParseOperatorError{"Failed to parse while expression"};
+    }
+    Validated(Current(), LexType::CLOSING_PARENTHESIS);
+
+    visitor_.VisitWhileBody();
+    MoveNext();
+    if (VisitOperator() == ParseResult::FAILURE) {
+      throw ParseOperatorError{"Failed to parse while body"};
+    }
+    visitor_.VisitEndWhile();
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitIf() {
+    if (Current() != LexType::IF) {
+      return ParseResult::FAILURE;
+    }
+
+    Validated(MoveNext(), LexType::OPENING_PARENTHESIS);
+    MoveNext();
+    if (VisitExpression() == ParseResult::FAILURE) {
+      throw ParseOperatorError{"Failed to parse if expression"};
+    }
+    Validated(Current(), LexType::CLOSING_PARENTHESIS);
+
+    visitor_.VisitIf();
+    MoveNext();
+    if (VisitOperator() == ParseResult::FAILURE) {
+      throw ParseOperatorError{"Failed to parse if(true) operation"};
+    }
+
+    if (Current() == LexType::ELSE) {
+      visitor_.VisitElse();
+      MoveNext();
+      if (VisitOperator() == ParseResult::FAILURE) {
+        throw ParseOperatorError{"Failed to parse if(false) operation"};
+      }
+    }
+    visitor_.VisitEndIf();
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr ParseResult VisitOperator() {
+    // using lazy evaluation here
+    if (VisitIf() || VisitWhile() || VisitDoWhile() || VisitBreak() ||
+        VisitContinue() || VisitRead() || VisitWrite() ||
+        VisitCompoundOperator() || VisitExpressionOperator()) {
+      return ParseResult::SUCCESS;
+    }
+
+    return ParseResult::FAILURE;
+  }
+
+  constexpr void VisitOperators() {
+    visitor_.VisitOperators();
+
+    while (VisitOperator() == ParseResult::SUCCESS) {
+      // Just visit while it lets us visit
+    }
+  }
+
+  constexpr void VisitVariableDeclaration(VariableType variable_type) {
+    Validated(Current(), LexType::ID);
+    const auto symbol = tokens_.GetSymbol(position_);
+
+    std::optional<Constant> default_value;
+    if (MoveNext() == LexType::ASSIGN) {
+      MoveNext();
+      default_value.emplace(GetConstant());
+      MoveNext();
+    }
+
+    visitor_.VisitVariableDeclaration(variable_type, symbol,
+                                      tokens_.GetName(symbol),
+                                      std::move(default_value));
+  }
+
+  constexpr ParseResult VisitDeclaration() {
+    const auto lex_type = Current();
+    if (!lexer::IsVariableType(lex_type)) [[unlikely]] {
+        return ParseResult::FAILURE;
+      }
+    const auto variable_type = MapType(lex_type);
+
+    do {
+      MoveNext();
+      VisitVariableDeclaration(variable_type);
+    } while (Current() == LexType::COMMA);
+
+    return ParseResult::SUCCESS;
+  }
+
+  constexpr void VisitDeclarations() {
+    visitor_.VisitDeclarations();
+
+    while (VisitDeclaration() == ParseResult::SUCCESS) {
+      Validated(Current(), LexType::SEMICOLON);
+      MoveNext();
+    }
+  }
+
+  constexpr void VisitProgram() {
+    Validated(Current(), LexType::PROGRAM);
+    Validated(MoveNext(), LexType::OPENING_BRACE);
+    visitor_.VisitProgram();
+
+    MoveNext();
+    VisitDeclarations();
+    VisitOperators();
+
+    Validated(Current(), LexType::CLOSING_BRACE);
+  }
+
+ private:
+  // TODO: add end() checks
+  constexpr LexType Current() const { return tokens_.GetType(position_); }
+
+  constexpr LexType MoveNext() { return tokens_.GetType(++position_); }
+
+  const lexer::TokenBuffer& tokens_;
+  size_t position_ = 0;
+  ModelVisitor& visitor_;
+};
+
+}  // namespace details
+
+// Reads the source in memory, the program is scanned before it's parsed.
+// Works in the constant evaluation when the visitor does.
+constexpr void VisitCode(std::string_view code, ModelVisitor& visitor) {
+  const auto tokens = lexer::Tokenize(code);
+  details::ModelReader(tokens, visitor).VisitProgram();
+}
+
+}  // namespace interpreter::ast
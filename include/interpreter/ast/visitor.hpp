@@ -3,8 +3,9 @@
 #include <iosfwd>
 #include <optional>
 #include <stdexcept>
-#include <string>
+#include <string_view>
 
+#include "interpreter/lexer/symbols.hpp"
 #include "types.hpp"
 
 namespace interpreter::ast {
@@ -32,18 +33,20 @@ enum class AddType { PLUS, MINUS };
 
 enum class MulType { MUL, DIV, MOD };
 
+// The variables are the symbols of their names, the names themselves are
+// given for the messages and are valid only during the call
 class ModelVisitor {
  public:
-  virtual ~ModelVisitor() = default;
+  constexpr virtual ~ModelVisitor() = default;
 
   virtual void VisitProgram() = 0;
   virtual void VisitDeclarations() = 0;
   virtual void VisitVariableDeclaration(
-      VariableType type, std::string&& name,
+      VariableType type, lexer::Symbol symbol, std::string_view name,
       std::optional<Constant>&& initial_value = std::nullopt) = 0;
   virtual void VisitOperators() = 0;
 
-  virtual void VisitRead(std::string&& name) = 0;
+  virtual void VisitRead(lexer::Symbol symbol, std::string_view name) = 0;
   virtual void VisitWrite() = 0;
   virtual void VisitExpressionOperator() = 0;
 
@@ -63,14 +66,18 @@ class ModelVisitor {
 
   // Expression states
   virtual void VisitAssign() = 0;
+  // before the right operand, it may be skipped by the short-circuit
+  virtual void VisitOrRightOperand() = 0;
   virtual void VisitOr() = 0;
+  virtual void VisitAndRightOperand() = 0;
   virtual void VisitAnd() = 0;
   virtual void VisitCompare(CompareType compare_type) = 0;
   virtual void VisitAdd(AddType add_type) = 0;
   virtual void VisitMul(MulType mul_type) = 0;
   virtual void VisitNot() = 0;
 
-  virtual void VisitVariableInvokation(std::string&& variable_name) = 0;
+  virtual void VisitVariableInvokation(lexer::Symbol symbol,
+                                       std::string_view name) = 0;
   virtual void VisitConstantInvokation(Constant&& constant) = 0;
 };
 
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "interpreter/ast/visitor.hpp"
+#include "interpreter/instructions/instructions.hpp"
+
+namespace interpreter::closures {
+
+struct CompileError : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+struct TypeError : public CompileError {
+  using CompileError::CompileError;
+};
+
+using instructions::ExecutionContext;
+using instructions::SlotIndex;
+using instructions::ValueT;
+namespace types = instructions::types;
+
+// How the control leaves the statement
+enum class Flow { NEXT, BREAK, CONTINUE };
+
+using Statement = std::function<Flow(ExecutionContext&)>;
+
+using Action = std::function<void(ExecutionContext&)>;
+
+template <ValueT T>
+using Expression = std::function<T(ExecutionContext&)>;
+
+namespace details {
+
+// Operands of the expression being compiled. The variables and the constants
+// are read in place by the closure of the operation which uses them, so they
+// don't cost a call
+
+template <ValueT T>
+struct VariableOperand {
+  SlotIndex index;
+
+  inline const T& operator()(ExecutionContext& context) const noexcept {
+    return context.frame.Get<T>(index);
+  }
+};
+
+template <ValueT T>
+struct ConstantOperand {
+  T value;
+
+  inline const T& operator()(ExecutionContext&) const noexcept {
+    return value;
+  }
+};
+
+template <ValueT T>
+struct ClosureOperand {
+  Expression<T> evaluate;
+  // the same, when the value is not used: the assignment doesn't copy it
+  Action execute{};
+  // s + a + b where s is the variable: the slot of s and the closure which
+  // appends a and b to the string in place
+  std::optional<SlotIndex> concatenated{};
+  std::function<void(ExecutionContext&, T&)> append{};
+
+  inline T operator()(ExecutionContext& context) const {
+    return evaluate(context);
+  }
+};
+
+template <ValueT T>
+using Operand =
+    std::variant<VariableOperand<T>, ConstantOperand<T>, ClosureOperand<T>>;
+
+using AnyOperand = std::variant<Operand<types::Bool>, Operand<types::Int>,
+                                Operand<types::Real>, Operand<types::Str>>;
+
+}  // namespace details
+
+// The program compiled to the tree of closures: every node calls its children
+// directly and reads the variables by the resolved slots, there is neither
+// dispatch loop nor operand stack
+class ClosureProgram {
+ public:
+  ClosureProgram(instructions::FrameLayout frame_layout, Statement body);
+
+  void Execute(ExecutionContext& context) const;
+
+ private:
+  instructions::FrameLayout frame_layout_;
+  Statement body_;
+};
+
+// Alternative backend built right from the events of the parser, the types
+// of the expressions are checked while compiling. Throws TypeError on the
+// operations which are not defined for the operands.
+class ClosureCompiler : public ast::ModelVisitor {
+ public:
+  void VisitProgram() override;
+  void VisitDeclarations() override;
+  void VisitVariableDeclaration(
+      ast::VariableType type, lexer::Symbol symbol, std::string_view name,
+      std::optional<ast::Constant>&& initial_value = std::nullopt) override;
+  void VisitOperators() override;
+  void VisitRead(lexer::Symbol symbol, std::string_view name) override;
+  void VisitWrite() override;
+  void VisitExpressionOperator() override;
+
+  void VisitIf() override;
+  void VisitElse() override;
+  void VisitEndIf() override;
+
+  void VisitWhile() override;
+  void VisitWhileBody() override;
+  void VisitEndWhile() override;
+
+  void VisitDoWhile() override;
+  void VisitDoWhileEnd() override;
+
+  void VisitBreak() override;
+  void VisitContinue() override;
+
+  // Expression States
+  void VisitAssign() override;
+  void VisitOrRightOperand() override;
+  void VisitOr() override;
+  void VisitAndRightOperand() override;
+  void VisitAnd() override;
+  void VisitCompare(ast::CompareType compare_type) override;
+  void VisitAdd(ast::AddType add_type) override;
+  void VisitMul(ast::MulType mul_type) override;
+  void VisitNot() override;
+  void VisitVariableInvokation(lexer::Symbol symbol,
+                               std::string_view name) override;
+  void VisitConstantInvokation(ast::Constant&& constant) override;
+
+  [[nodiscard]] ClosureProgram MakeProgram();
+
+ private:
+  struct Block {
+    std::vector<Statement> statements;
+    // condition of the if or the while
+    Expression<types::Bool> condition{};
+    // set when the else branch of the if is compiled
+    std::optional<Statement> then_branch{};
+  };
+
+  template <typename Op>
+  void CompileBinary();
+  template <typename Op>
+  void CompileUnary();
+  template <typename Op>
+  void CompileLogical();
+
+  details::AnyOperand PopOperand();
+  Expression<types::Bool> PopCondition();
+  void AddStatement(Statement statement);
+
+  instructions::FrameLayout frame_layout_;
+  std::vector<details::AnyOperand> operands_;
+  // the first one is the body of the program
+  std::vector<Block> blocks_ = std::vector<Block>(1);
+  size_t loops_depth_ = 0;
+};
+
+}  // namespace interpreter::closures
@@ -0,0 +1,422 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "interpreter/ast/reader.hpp"
+#include "interpreter/instructions/operations.hpp"
+#include "interpreter/instructions/writer.hpp"
+#include "interpreter/utils/decimal.hpp"
+#include "interpreter/utils/fixed_string.hpp"
+#include "interpreter/utils/format.hpp"
+
+// The programs embedded in the C++ code as the string literals, they are
+// parsed and compiled during the compilation of the C++ code. The programs
+// which don't read anything are evaluated there too.
+namespace interpreter::compile_time {
+
+using instructions::CodeUnit;
+using instructions::Label;
+using instructions::OpCode;
+using instructions::Slot;
+using instructions::Value;
+
+// The program reads the input, it's known only at runtime
+struct EvaluationError : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+// The generic code of the stack machine as InstructionsWriter writes it,
+// before the optimizations
+[[nodiscard]] constexpr instructions::Bytecode Compile(
+    std::string_view source) {
+  instructions::InstructionsWriter writer;
+  ast::VisitCode(source, writer);
+  return writer.TakeBytecode();
+}
+
+namespace details {
+
+// Operand of the stack: the value or the variable, which is read by the
+// operation as in the generic instructions of the stack machine
+using Operand = std::variant<Value, Slot>;
+
+class Evaluator {
+ public:
+  explicit constexpr Evaluator(const instructions::Bytecode& program)
+      : program_{program} {
+    LoadBank<instructions::types::Bool>();
+    LoadBank<instructions::types::Int>();
+    LoadBank<instructions::types::Real>();
+    LoadBank<instructions::types::Str>();
+  }
+
+  constexpr std::string Run() {
+    namespace op_type = instructions::op_type;
+
+    for (Label pc = 0;;) {
+      const auto op_code = static_cast<OpCode>(program_.code[pc]);
+      const auto* const operands = program_.code.data() + pc + 1;
+      pc += instructions::GetInstructionSize(op_code);
+
+      // waiting for c++20 using enums
+      switch (op_code) {
+        case OpCode::NOP:
+        case OpCode::LOOP_HEADER:
+          break;
+        case OpCode::HALT:
+          return std::move(output_);
+        case OpCode::READ:
+          throw EvaluationError{"The program reads the input"};
+        case OpCode::WRITE:
+          output_ += FormatValue(PopValue());
+          break;
+        case OpCode::POP:
+          stack_.pop_back();
+          break;
+        case OpCode::INVOKE_CONSTANT:
+          stack_.emplace_back(program_.constants[operands[0]]);
+          break;
+        case OpCode::INVOKE_VARIABLE:
+          stack_.emplace_back(
+              Slot{static_cast<ast::VariableType>(operands[0]), operands[1]});
+          break;
+        case OpCode::GOTO:
+          pc = operands[0];
+          break;
+        case OpCode::JUMP_FALSE:
+          if (!ToBool(PopValue())) pc = operands[0];
+          break;
+        case OpCode::JUMP_TRUE:
+          if (ToBool(PopValue())) pc = operands[0];
+          break;
+        case OpCode::JUMP_FALSE_OR_POP:
+          if (!ToBool(TopValue())) {
+            pc = operands[0];
+          } else {
+            stack_.pop_back();
+          }
+          break;
+        case OpCode::JUMP_TRUE_OR_POP:
+          if (ToBool(TopValue())) {
+            pc = operands[0];
+          } else {
+            stack_.pop_back();
+          }
+          break;
+        case OpCode::ASSIGN:
+          ExecuteBinary<op_type::Assign>();
+          break;
+        case OpCode::PLUS:
+          ExecuteBinary<op_type::Plus>();
+          break;
+        case OpCode::MINUS:
+          ExecuteBinary<op_type::Minus>();
+          break;
+        case OpCode::MUL:
+          ExecuteBinary<op_type::Mul>();
+          break;
+        case OpCode::DIV:
+          ExecuteBinary<op_type::Div>();
+          break;
+        case OpCode::MOD:
+          ExecuteBinary<op_type::Mod>();
+          break;
+        case OpCode::EQUALS:
+          ExecuteBinary<op_type::Equals>();
+          break;
+        case OpCode::NOT_EQUALS:
+          ExecuteBinary<op_type::NotEquals>();
+          break;
+        case OpCode::LESS:
+          ExecuteBinary<op_type::Less>();
+          break;
+        case OpCode::GREATER:
+          ExecuteBinary<op_type::Greater>();
+          break;
+        case OpCode::LESS_OR_EQ:
+          ExecuteBinary<op_type::LessOrEq>();
+          break;
+        case OpCode::GREATER_OR_EQ:
+          ExecuteBinary<op_type::GreaterOrEq>();
+          break;
+        case OpCode::NOT:
+          stack_.back() = std::get<Value>(
+              instructions::PerformOperation<op_type::Not>(TakeTop()));
+          break;
+        default:
+          throw EvaluationError{"The instruction isn't generic"};
+      }
+    }
+  }
+
+ private:
+  [[nodiscard]] static constexpr std::string FormatValue(const Value& value) {
+    return std::visit(
+        []<typename T>(const T& value) -> std::string {
+          if constexpr (std::is_same_v<T, instructions::types::Str>) {
+            return value;
+          } else if constexpr (std::is_same_v<T, instructions::types::Real>) {
+            return utils::FormatReal(value);
+          } else {
+            return utils::FormatInt(value);
+          }
+        },
+        value);
+  }
+
+  [[nodiscard]] static constexpr bool ToBool(const Value& value) {
+    return std::visit(instructions::ToBoolVisitor{}, value);
+  }
+
+  [[nodiscard]] constexpr std::vector<Value>& GetBank(ast::VariableType type) {
+    return banks_[static_cast<size_t>(type)];
+  }
+
+  template <typename T>
+  constexpr void LoadBank() {
+    const auto& values = program_.frame_layout.GetInitialValues<T>();
+    GetBank(ast::EnumByType<T>::value).assign(values.begin(), values.end());
+  }
+
+  [[nodiscard]] constexpr Value& GetVariable(Slot slot) {
+    return GetBank(slot.type)[slot.index];
+  }
+
+  [[nodiscard]] constexpr Value TopValue() {
+    if (const auto* slot = std::get_if<Slot>(&stack_.back())) {
+      return GetVariable(*slot);
+    }
+    return std::get<Value>(stack_.back());
+  }
+
+  [[nodiscard]] constexpr Value PopValue() {
+    auto value = TopValue();
+    stack_.pop_back();
+    return value;
+  }
+
+  // The variables are read by the operation, after all its operands are
+  // evaluated
+  [[nodiscard]] constexpr instructions::OperationValue TakeTop() {
+    if (const auto* slot = std::get_if<Slot>(&stack_.back())) {
+      return instructions::details::ToReference(GetVariable(*slot));
+    }
+    return std::get<Value>(std::move(stack_.back()));
+  }
+
+  template <instructions::OperationT Op>
+  constexpr void ExecuteBinary() {
+    auto rhs = TakeTop();
+    stack_.pop_back();
+    stack_.back() = std::get<Value>(
+        instructions::PerformOperation<Op>(TakeTop(), std::move(rhs)));
+  }
+
+  const instructions::Bytecode& program_;
+  std::array<std::vector<Value>, static_cast<size_t>(ast::VariableType::_END)>
+      banks_;
+  std::vector<Operand> stack_;
+  std::string output_;
+};
+
+}  // namespace details
+
+// Runs the program which doesn't read anything and returns its output
+[[nodiscard]] constexpr std::string Evaluate(
+    const instructions::Bytecode& program) {
+  return details::Evaluator{program}.Run();
+}
+
+// Program compiled in the constant evaluation, it's kept in the arrays
+// which are the static storage
+
+struct ProgramSizes {
+  size_t code = 0;
+  size_t constants = 0;
+  size_t variables = 0;
+  size_t chars = 0;
+};
+
+// Value of the static storage, the strings are kept in the chars of the
+// program
+struct StaticValue {
+  size_t type_index = 0;
+  instructions::types::Bool bool_value = false;
+  instructions::types::Int int_value = 0;
+  instructions::types::Real real_value = 0;
+  size_t chars_offset = 0;
+  size_t chars_size = 0;
+};
+
+struct ProgramView {
+  std::span<const CodeUnit> code;
+  std::span<const StaticValue> constants;
+  // the initial values of the variables by the banks of FrameLayout
+  std::span<const StaticValue> variables;
+  std::string_view chars;
+};
+
+// The code of the program optimized for the stack machine, without the
+// parsing. The optimization passes are the ones of InstructionsWriter.
+[[nodiscard]] instructions::InstructionsBlock MakeBlock(
+    const ProgramView& program);
+
+template <ProgramSizes sizes>
+struct Program {
+  std::array<CodeUnit, sizes.code> code{};
+  std::array<StaticValue, sizes.constants> constants{};
+  std::array<StaticValue, sizes.variables> variables{};
+  std::array<char, sizes.chars> chars{};
+
+  [[nodiscard]] constexpr ProgramView View() const noexcept {
+    return {code, constants, variables, {chars.data(), chars.size()}};
+  }
+
+  [[nodiscard]] instructions::InstructionsBlock MakeBlock() const {
+    return compile_time::MakeBlock(View());
+  }
+};
+
+namespace details {
+
+[[nodiscard]] constexpr size_t GetCharsSize(const Value& value) {
+  if (const auto* string = std::get_if<instructions::types::Str>(&value)) {
+    return string->size();
+  }
+  return 0;
+}
+
+// The initial values of the variables bank after bank, FrameLayout gives the
+// same slots if they are declared in this order
+[[nodiscard]] constexpr std::vector<Value> GetVariables(
+    const instructions::FrameLayout& layout) {
+  std::vector<Value> variables;
+  const auto append = [&variables]<typename T>(const std::vector<T>& values) {
+    variables.insert(variables.end(), values.begin(), values.end());
+  };
+  append(layout.GetInitialValues<instructions::types::Bool>());
+  append(layout.GetInitialValues<instructions::types::Int>());
+  append(layout.GetInitialValues<instructions::types::Real>());
+  append(layout.GetInitialValues<instructions::types::Str>());
+  return variables;
+}
+
+[[nodiscard]] constexpr ProgramSizes GetSizes(
+    const instructions::Bytecode& program) {
+  const auto variables = GetVariables(program.frame_layout);
+  ProgramSizes sizes{.code = program.code.size(),
+                     .constants = program.constants.size(),
+                     .variables = variables.size()};
+  for (const auto& constant : program.constants) {
+    sizes.chars += GetCharsSize(constant);
+  }
+  for (const auto& variable : variables) {
+    sizes.chars += GetCharsSize(variable);
+  }
+  return sizes;
+}
+
+// Appends the strings to the chars of the program
+template <size_t N>
+class CharsWriter {
+ public:
+  explicit constexpr CharsWriter(std::array<char, N>& chars) noexcept
+      : chars_{chars} {}
+
+  constexpr size_t Write(std::string_view string) {
+    const auto offset = size_;
+    std::copy(string.begin(), string.end(), chars_.begin() + offset);
+    size_ += string.size();
+    return offset;
+  }
+
+  constexpr StaticValue ToStatic(const Value& value) {
+    StaticValue result{.type_index = value.index()};
+    std::visit(
+        [this, &result]<typename T>(const T& value) {
+          if constexpr (std::is_same_v<T, instructions::types::Bool>) {
+            result.bool_value = value;
+          } else if constexpr (std::is_same_v<T, instructions::types::Int>) {
+            result.int_value = value;
+          } else if constexpr (std::is_same_v<T, instructions::types::Real>) {
+            result.real_value = value;
+          } else {
+            result.chars_offset = Write(value);
+            result.chars_size = value.size();
+          }
+        },
+        value);
+    return result;
+  }
+
+ private:
+  std::array<char, N>& chars_;
+  size_t size_ = 0;
+};
+
+template <ProgramSizes sizes>
+[[nodiscard]] constexpr Program<sizes> MakeProgram(
+    const instructions::Bytecode& bytecode) {
+  Program<sizes> program;
+  std::copy(bytecode.code.begin(), bytecode.code.end(), program.code.begin());
+
+  CharsWriter chars{program.chars};
+  for (size_t i = 0; i < sizes.constants; ++i) {
+    program.constants[i] = chars.ToStatic(
+        bytecode.constants[static_cast<instructions::ConstantPool::Index>(i)]);
+  }
+  const auto variables = GetVariables(bytecode.frame_layout);
+  for (size_t i = 0; i < sizes.variables; ++i) {
+    program.variables[i] = chars.ToStatic(variables[i]);
+  }
+  return program;
+}
+
+}  // namespace details
+
+[[nodiscard]] constexpr Value ToValue(const StaticValue& value,
+                                      std::string_view chars) {
+  // the index of the alternative of Value
+  switch (value.type_index) {
+    case 0:
+      return value.bool_value;
+    case 1:
+      return value.int_value;
+    case 2:
+      return value.real_value;
+    default:
+      return std::string{chars.substr(value.chars_offset, value.chars_size)};
+  }
+}
+
+// Parses and compiles the program during the compilation of the C++ code,
+// there is nothing left to parse at runtime
+template <utils::FixedString source>
+consteval auto CompileProgram() {
+  constexpr auto sizes = details::GetSizes(Compile(source.View()));
+  return details::MakeProgram<sizes>(Compile(source.View()));
+}
+
+// The output of the program which doesn't read anything, evaluated during the
+// compilation of the C++ code. The program is evaluated twice: the size of
+// the output is the template argument of the result.
+template <utils::FixedString source>
+consteval auto EvaluateProgram() {
+  constexpr auto size = Evaluate(Compile(source.View())).size();
+  const auto output = Evaluate(Compile(source.View()));
+
+  utils::FixedString<size + 1> result;
+  std::copy(output.begin(), output.end(), result.chars.begin());
+  return result;
+}
+
+}  // namespace interpreter::compile_time
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <span>
+#include <stdexcept>
+
+#include "instructions.hpp"
+
+namespace interpreter::instructions {
+
+struct AnalysisError : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+// Walks every path of the code and returns the maximum number of values on the
+// operand stack. Throws AnalysisError if some instruction may lack operands or
+// if two paths reach the same instruction with different stack depths.
+[[nodiscard]] size_t ComputeMaxStackDepth(std::span<const CodeUnit> code);
+
+}  // namespace interpreter::instructions
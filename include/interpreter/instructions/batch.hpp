@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "registers.hpp"
+
+namespace interpreter::instructions {
+
+// Types of the registers before an instruction, std::nullopt if the paths to
+// it disagree
+using RegisterTypes = std::vector<std::optional<ast::VariableType>>;
+
+// Runs many instances of the register code in lockstep, one per lane. Every
+// register keeps a value per lane, the operations on ints, reals and bools
+// are done for all the lanes at once by the vector instructions.
+//
+// The lanes which take different branches are masked off: the largest group
+// of the lanes at the same label runs, the others wait until it reaches
+// them. A lane which halts takes the next run of the batch, the last run
+// continues alone in the scalar interpreter.
+class BatchBlock {
+ public:
+  static constexpr size_t LANES = 8;
+
+  // Throws AnalysisError if the types of the registers can't be inferred
+  explicit BatchBlock(RegisterBlock block);
+
+  // Every context is an independent run of the program with its own input
+  // and output. An error of any run stops the whole batch.
+  void Execute(std::span<ExecutionContext> contexts,
+               std::optional<JitOptions> jit = std::nullopt) const;
+
+  [[nodiscard]] inline const RegisterBlock& GetRegisterBlock() const noexcept {
+    return block_;
+  }
+
+ private:
+  RegisterBlock block_;
+  // indexed by the label of the instruction
+  std::vector<RegisterTypes> types_;
+};
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "frame.hpp"
+#include "types.hpp"
+
+namespace interpreter::instructions {
+
+namespace details {
+
+struct StrBox {
+  types::Str value;
+  std::uint32_t references = 1;
+};
+
+}  // namespace details
+
+// Value of the operand stack in 16 bytes: bools and numbers are stored inline,
+// strings are shared between the cells by the reference counter and the
+// variables are referenced by their frame slot
+class Cell {
+ public:
+  enum class Tag : std::uint8_t { BOOL, INT, REAL, STR, REFERENCE };
+
+  Cell() noexcept : payload_{.bool_value = false}, tag_{Tag::BOOL} {}
+  explicit Cell(types::Bool value) noexcept
+      : payload_{.bool_value = value}, tag_{Tag::BOOL} {}
+  explicit Cell(types::Int value) noexcept
+      : payload_{.int_value = value}, tag_{Tag::INT} {}
+  explicit Cell(types::Real value) noexcept
+      : payload_{.real_value = value}, tag_{Tag::REAL} {}
+  explicit Cell(types::Str value)
+      : payload_{.str = new details::StrBox{std::move(value)}},
+        tag_{Tag::STR} {}
+  explicit Cell(Value value);
+
+  [[nodiscard]] static inline Cell MakeReference(Slot slot) noexcept {
+    Cell cell;
+    cell.payload_.index = slot.index;
+    cell.tag_ = Tag::REFERENCE;
+    cell.reference_type_ = slot.type;
+    return cell;
+  }
+
+  inline Cell(const Cell& other) noexcept { CopyFrom(other); }
+  inline Cell(Cell&& other) noexcept { MoveFrom(other); }
+
+  inline Cell& operator=(const Cell& other) noexcept {
+    if (this != &other) {
+      Release();
+      CopyFrom(other);
+    }
+    return *this;
+  }
+
+  inline Cell& operator=(Cell&& other) noexcept {
+    if (this != &other) {
+      Release();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  inline ~Cell() { Release(); }
+
+  [[nodiscard]] inline Tag GetTag() const noexcept { return tag_; }
+  [[nodiscard]] inline bool IsReference() const noexcept {
+    return tag_ == Tag::REFERENCE;
+  }
+  [[nodiscard]] inline Slot GetSlot() const noexcept {
+    return {reference_type_, payload_.index};
+  }
+
+  // The type of the cell isn't checked, it should be proven by the caller
+  template <ValueT T>
+  [[nodiscard]] inline const T& Get() const noexcept {
+    if constexpr (std::is_same_v<T, types::Bool>) {
+      return payload_.bool_value;
+    } else if constexpr (std::is_same_v<T, types::Int>) {
+      return payload_.int_value;
+    } else if constexpr (std::is_same_v<T, types::Real>) {
+      return payload_.real_value;
+    } else {
+      return payload_.str->value;
+    }
+  }
+
+  // Moves the string out if nobody else sees it, the cell should be set or
+  // dropped after that
+  template <ValueT T>
+  [[nodiscard]] inline T Take() {
+    if constexpr (std::is_same_v<T, types::Str>) {
+      if (payload_.str->references == 1) {
+        return std::move(payload_.str->value);
+      }
+    }
+    return Get<T>();
+  }
+
+  template <ValueT T>
+  inline void Set(T value) {
+    if constexpr (std::is_same_v<T, types::Str>) {
+      if (tag_ == Tag::STR && payload_.str->references == 1) {
+        // nobody else sees the string, so it's changed in place
+        payload_.str->value = std::move(value);
+        return;
+      }
+    }
+    Release();
+    if constexpr (std::is_same_v<T, types::Bool>) {
+      payload_.bool_value = value;
+      tag_ = Tag::BOOL;
+    } else if constexpr (std::is_same_v<T, types::Int>) {
+      payload_.int_value = value;
+      tag_ = Tag::INT;
+    } else if constexpr (std::is_same_v<T, types::Real>) {
+      payload_.real_value = value;
+      tag_ = Tag::REAL;
+    } else {
+      payload_.str = new details::StrBox{std::move(value)};
+      tag_ = Tag::STR;
+    }
+  }
+
+  // Drops the value, the cell becomes false
+  inline void Reset() noexcept {
+    Release();
+    payload_.bool_value = false;
+    tag_ = Tag::BOOL;
+  }
+
+  // Shouldn't be called for the references
+  [[nodiscard]] Value ToValue() const;
+  [[nodiscard]] Value TakeValue();
+
+ private:
+  inline void CopyFrom(const Cell& other) noexcept {
+    payload_ = other.payload_;
+    tag_ = other.tag_;
+    reference_type_ = other.reference_type_;
+    if (tag_ == Tag::STR) {
+      ++payload_.str->references;
+    }
+  }
+
+  inline void MoveFrom(Cell& other) noexcept {
+    payload_ = other.payload_;
+    tag_ = other.tag_;
+    reference_type_ = other.reference_type_;
+    other.tag_ = Tag::BOOL;
+  }
+
+  inline void Release() noexcept {
+    if (tag_ == Tag::STR && --payload_.str->references == 0) {
+      delete payload_.str;
+    }
+  }
+
+  friend struct CellLayout;
+
+  union Payload {
+    types::Bool bool_value;
+    types::Int int_value;
+    types::Real real_value;
+    details::StrBox* str;
+    SlotIndex index;
+  };
+
+  Payload payload_;
+  Tag tag_;
+  ast::VariableType reference_type_ = ast::VariableType::BOOL;
+};
+
+static_assert(sizeof(Cell) <= 16);
+
+// Layout of the cell for the native code: the value is at the beginning
+struct CellLayout {
+  static constexpr size_t kSize = sizeof(Cell);
+  static constexpr size_t kTagOffset = offsetof(Cell, tag_);
+};
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "types.hpp"
+
+namespace interpreter::instructions {
+
+// Literals of the program, equal constants share one entry, so the
+// instructions refer to them by index. Works in the constant evaluation.
+class ConstantPool {
+ public:
+  using Index = std::uint32_t;
+
+  // Returns the index of the existing equal constant if there is one
+  constexpr Index Add(Value&& value) {
+    // the slots are at most half full
+    if (2 * (values_.size() + 1) > slots_.size()) {
+      Rehash(std::max(MIN_SLOTS, 2 * slots_.size()));
+    }
+
+    auto slot = Hash(value) & (slots_.size() - 1);
+    for (; slots_[slot] != EMPTY; slot = (slot + 1) & (slots_.size() - 1)) {
+      if (IsEqual(values_[slots_[slot]], value)) {
+        return slots_[slot];
+      }
+    }
+
+    slots_[slot] = static_cast<Index>(values_.size());
+    values_.push_back(std::move(value));
+    return slots_[slot];
+  }
+
+  [[nodiscard]] constexpr const Value& operator[](
+      Index index) const noexcept {
+    return values_[index];
+  }
+  [[nodiscard]] constexpr size_t size() const noexcept {
+    return values_.size();
+  }
+  [[nodiscard]] constexpr auto begin() const noexcept {
+    return values_.begin();
+  }
+  [[nodiscard]] constexpr auto end() const noexcept { return values_.end(); }
+
+ private:
+  static constexpr Index EMPTY = std::numeric_limits<Index>::max();
+  static constexpr size_t MIN_SLOTS = 16;
+
+  // Reals are compared by their bits: 0.0 and -0.0 are different constants
+  template <typename T>
+  [[nodiscard]] static constexpr decltype(auto) GetKey(
+      const T& value) noexcept {
+    if constexpr (std::is_same_v<T, types::Real>) {
+      return std::bit_cast<std::uint64_t>(value);
+    } else {
+      return (value);
+    }
+  }
+
+  [[nodiscard]] static constexpr size_t Hash(const Value& value) noexcept {
+    return std::visit(
+        []<typename T>(const T& alternative) -> size_t {
+          if constexpr (std::is_same_v<T, types::Str>) {
+            // FNV-1a
+            std::uint64_t hash = 14695981039346656037u;
+            for (const auto ch : alternative) {
+              hash = (hash ^ static_cast<unsigned char>(ch)) * 1099511628211u;
+            }
+            return hash;
+          } else {
+            // the bits of the reals are mixed down to the low ones
+            const auto hash = static_cast<std::uint64_t>(GetKey(alternative)) *
+                              0x9E3779B97F4A7C15u;
+            return hash ^ (hash >> 32);
+          }
+        },
+        value);
+  }
+
+  [[nodiscard]] static constexpr bool IsEqual(const Value& lhs,
+                                              const Value& rhs) noexcept {
+    return lhs.index() == rhs.index() &&
+           std::visit(
+               [&rhs]<typename T>(const T& alternative) {
+                 return GetKey(alternative) == GetKey(std::get<T>(rhs));
+               },
+               lhs);
+  }
+
+  // The size is a power of two
+  constexpr void Rehash(size_t size) {
+    slots_.assign(size, EMPTY);
+    for (Index index = 0; index < values_.size(); ++index) {
+      auto slot = Hash(values_[index]) & (size - 1);
+      while (slots_[slot] != EMPTY) {
+        slot = (slot + 1) & (size - 1);
+      }
+      slots_[slot] = index;
+    }
+  }
+
+  std::vector<Value> values_;
+  std::vector<Index> slots_;
+};
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "interpreter/ast/types.hpp"
+#include "interpreter/lexer/symbols.hpp"
+#include "types.hpp"
+
+namespace interpreter::instructions {
+
+using SlotIndex = std::uint32_t;
+
+// Resolved variable: the bank of the variable type and the index inside it
+struct Slot {
+  ast::VariableType type;
+  SlotIndex index;
+
+  [[nodiscard]] inline constexpr bool operator==(
+      const Slot& other) const noexcept = default;
+};
+
+// Compile time description of the variables, filled by the instructions
+// writer. The variables are the symbols of their names. Works in the
+// constant evaluation.
+class FrameLayout {
+ public:
+  // Returns std::nullopt if the variable is already declared
+  constexpr std::optional<Slot> Declare(lexer::Symbol symbol,
+                                        Value&& initial_value) {
+    if (Find(symbol)) {
+      return std::nullopt;
+    }
+
+    const auto slot = std::visit(
+        [this]<typename T>(T&& value) {
+          using ValueType = std::decay_t<T>;
+          auto& values = std::get<std::vector<ValueType>>(initial_values_);
+          values.push_back(std::forward<T>(value));
+          return Slot{ast::EnumByType<ValueType>::value,
+                      static_cast<SlotIndex>(values.size() - 1)};
+        },
+        std::move(initial_value));
+
+    if (symbol >= slots_.size()) {
+      slots_.resize(symbol + 1);
+    }
+    slots_[symbol] = slot;
+    return slot;
+  }
+
+  [[nodiscard]] constexpr std::optional<Slot> Find(
+      lexer::Symbol symbol) const {
+    if (symbol < slots_.size()) {
+      return slots_[symbol];
+    }
+    return std::nullopt;
+  }
+
+  template <ValueT T>
+  [[nodiscard]] constexpr const std::vector<T>& GetInitialValues()
+      const noexcept {
+    return std::get<std::vector<T>>(initial_values_);
+  }
+
+ private:
+  // indexed by the symbol
+  std::vector<std::optional<Slot>> slots_;
+  std::tuple<std::vector<types::Bool>, std::vector<types::Int>,
+             std::vector<types::Real>, std::vector<types::Str>>
+      initial_values_;
+};
+
+// Runtime storage of the variables: one contiguous bank per variable type
+class Frame {
+ public:
+  Frame() = default;
+  explicit Frame(const FrameLayout& layout);
+
+  template <ValueT T>
+  [[nodiscard]] inline T& Get(SlotIndex index) noexcept {
+    return std::get<Bank<T>>(banks_)[index];
+  }
+
+ private:
+  template <typename T>
+  using Bank = std::unique_ptr<T[]>;
+
+  std::tuple<Bank<types::Bool>, Bank<types::Int>, Bank<types::Real>,
+             Bank<types::Str>>
+      banks_;
+};
+
+}  // namespace interpreter::instructions
@@ -1,12 +1,22 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
+#include <limits>
 #include <memory>
 #include <optional>
-#include <stack>
-#include <unordered_map>
+#include <span>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "cell.hpp"
+#include "constant_pool.hpp"
+#include "frame.hpp"
 #include "operations.hpp"
 
 namespace interpreter::instructions {
@@ -15,171 +25,477 @@ struct RuntimeError : public std::runtime_error {
   using runtime_error::runtime_error;
 };
 
+// Offset of an instruction inside of the code buffer
 using Label = size_t;
+// Code buffer is a flat sequence of units: opcode followed by its operands
+using CodeUnit = std::uint32_t;
 
-struct ExecutionContext {
-  // TODO: add reference to parent
-  std::istream& input;
-  std::ostream& output;
-  std::unordered_map<std::string, Value> variables;
-  std::stack<OperationValue> values_stack;
-  Label current_instruction;
-};
+// Int immediate operands are stored in the code units bit by bit
+[[nodiscard]] inline constexpr CodeUnit EncodeImmediate(
+    types::Int value) noexcept {
+  return std::bit_cast<CodeUnit>(value);
+}
+[[nodiscard]] inline constexpr types::Int DecodeImmediate(
+    CodeUnit unit) noexcept {
+  return std::bit_cast<types::Int>(unit);
+}
 
-class Instruction {
- public:
-  virtual void Execute(ExecutionContext& context) const = 0;
-  virtual ~Instruction() = default;
+// Type specialized instructions, emitted by SpecializeTypes for the operands
+// with statically known types. Every entry has the matching details::Rule.
+
+// X(name, type)
+#define INTERPRETER_VALUE_TYPES(X) \
+  X(BOOL, Bool)                    \
+  X(INT, Int)                      \
+  X(REAL, Real)                    \
+  X(STR, Str)
+
+// X(opcode, generic opcode, operation, lhs type, rhs type)
+#define INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(X)                 \
+  X(PLUS_INT_INT, PLUS, Plus, Int, Int)                              \
+  X(MINUS_INT_INT, MINUS, Minus, Int, Int)                           \
+  X(MUL_INT_INT, MUL, Mul, Int, Int)                                 \
+  X(DIV_INT_INT, DIV, Div, Int, Int)                                 \
+  X(MOD_INT_INT, MOD, Mod, Int, Int)                                 \
+  X(PLUS_REAL_REAL, PLUS, Plus, Real, Real)                          \
+  X(MINUS_REAL_REAL, MINUS, Minus, Real, Real)                       \
+  X(MUL_REAL_REAL, MUL, Mul, Real, Real)                             \
+  X(DIV_REAL_REAL, DIV, Div, Real, Real)                             \
+  X(PLUS_REAL_INT, PLUS, Plus, Real, Int)                            \
+  X(MINUS_REAL_INT, MINUS, Minus, Real, Int)                         \
+  X(MUL_REAL_INT, MUL, Mul, Real, Int)                               \
+  X(DIV_REAL_INT, DIV, Div, Real, Int)                               \
+  X(PLUS_INT_REAL, PLUS, Plus, Int, Real)                            \
+  X(MINUS_INT_REAL, MINUS, Minus, Int, Real)                         \
+  X(MUL_INT_REAL, MUL, Mul, Int, Real)                               \
+  X(DIV_INT_REAL, DIV, Div, Int, Real)                               \
+  X(PLUS_STR_STR, PLUS, Plus, Str, Str)                              \
+  X(EQUALS_INT_INT, EQUALS, Equals, Int, Int)                        \
+  X(NOT_EQUALS_INT_INT, NOT_EQUALS, NotEquals, Int, Int)             \
+  X(LESS_INT_INT, LESS, Less, Int, Int)                              \
+  X(GREATER_INT_INT, GREATER, Greater, Int, Int)                     \
+  X(LESS_OR_EQ_INT_INT, LESS_OR_EQ, LessOrEq, Int, Int)              \
+  X(GREATER_OR_EQ_INT_INT, GREATER_OR_EQ, GreaterOrEq, Int, Int)     \
+  X(EQUALS_REAL_REAL, EQUALS, Equals, Real, Real)                    \
+  X(NOT_EQUALS_REAL_REAL, NOT_EQUALS, NotEquals, Real, Real)         \
+  X(LESS_REAL_REAL, LESS, Less, Real, Real)                          \
+  X(GREATER_REAL_REAL, GREATER, Greater, Real, Real)                 \
+  X(LESS_OR_EQ_REAL_REAL, LESS_OR_EQ, LessOrEq, Real, Real)          \
+  X(GREATER_OR_EQ_REAL_REAL, GREATER_OR_EQ, GreaterOrEq, Real, Real) \
+  X(EQUALS_REAL_INT, EQUALS, Equals, Real, Int)                      \
+  X(NOT_EQUALS_REAL_INT, NOT_EQUALS, NotEquals, Real, Int)           \
+  X(LESS_REAL_INT, LESS, Less, Real, Int)                            \
+  X(GREATER_REAL_INT, GREATER, Greater, Real, Int)                   \
+  X(LESS_OR_EQ_REAL_INT, LESS_OR_EQ, LessOrEq, Real, Int)            \
+  X(GREATER_OR_EQ_REAL_INT, GREATER_OR_EQ, GreaterOrEq, Real, Int)   \
+  X(EQUALS_INT_REAL, EQUALS, Equals, Int, Real)                      \
+  X(NOT_EQUALS_INT_REAL, NOT_EQUALS, NotEquals, Int, Real)           \
+  X(LESS_INT_REAL, LESS, Less, Int, Real)                            \
+  X(GREATER_INT_REAL, GREATER, Greater, Int, Real)                   \
+  X(LESS_OR_EQ_INT_REAL, LESS_OR_EQ, LessOrEq, Int, Real)            \
+  X(GREATER_OR_EQ_INT_REAL, GREATER_OR_EQ, GreaterOrEq, Int, Real)   \
+  X(EQUALS_STR_STR, EQUALS, Equals, Str, Str)                        \
+  X(NOT_EQUALS_STR_STR, NOT_EQUALS, NotEquals, Str, Str)             \
+  X(LESS_STR_STR, LESS, Less, Str, Str)                              \
+  X(GREATER_STR_STR, GREATER, Greater, Str, Str)                     \
+  X(LESS_OR_EQ_STR_STR, LESS_OR_EQ, LessOrEq, Str, Str)              \
+  X(GREATER_OR_EQ_STR_STR, GREATER_OR_EQ, GreaterOrEq, Str, Str)
+
+// X(opcode, generic opcode, operation, operand type)
+#define INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(X)  \
+  X(NOT_BOOL, NOT, Not, Bool)                        \
+  X(UNARY_PLUS_INT, UNARY_PLUS, UnaryPlus, Int)      \
+  X(UNARY_MINUS_INT, UNARY_MINUS, UnaryMinus, Int)   \
+  X(UNARY_PLUS_REAL, UNARY_PLUS, UnaryPlus, Real)    \
+  X(UNARY_MINUS_REAL, UNARY_MINUS, UnaryMinus, Real)
+
+// X(types, variable type, value type)
+// ASSIGN_<types> and its fused version STORE_<types>
+#define INTERPRETER_SPECIALIZED_ASSIGNMENTS(X) \
+  X(INT_INT, Int, Int)                         \
+  X(REAL_REAL, Real, Real)                     \
+  X(INT_REAL, Int, Real)                       \
+  X(REAL_INT, Real, Int)                       \
+  X(STR_STR, Str, Str)                         \
+  X(BOOL_BOOL, Bool, Bool)
+
+// Comparisons of ints fused with the conditional jump
+// X(comparison, operation, negated comparison)
+#define INTERPRETER_FUSED_COMPARISONS(X)  \
+  X(EQUALS, Equals, NOT_EQUALS)           \
+  X(NOT_EQUALS, NotEquals, EQUALS)        \
+  X(LESS, Less, GREATER_OR_EQ)            \
+  X(GREATER, Greater, LESS_OR_EQ)         \
+  X(LESS_OR_EQ, LessOrEq, GREATER)        \
+  X(GREATER_OR_EQ, GreaterOrEq, LESS)
+
+enum class OpCode : CodeUnit {
+  NOP,
+  HALT,
+  // header of a loop, counts its iterations in the tiered execution, see
+  // TieredBlock. Removed from the optimized code by StripLoopHeaders.
+  // operands: loop index
+  LOOP_HEADER,
+
+  // operands: slot type, slot index
+  READ,
+  WRITE,
+  POP,
+  // operands: constant index
+  INVOKE_CONSTANT,
+  // operands: slot type, slot index
+  INVOKE_VARIABLE,
+
+  // operands: label
+  GOTO,
+  JUMP_FALSE,
+  JUMP_TRUE,
+  // short-circuit of and/or: jumps keeping the condition as the result,
+  // otherwise pops it
+  JUMP_FALSE_OR_POP,
+  JUMP_TRUE_OR_POP,
+
+  // binary operations
+  ASSIGN,
+  PLUS,
+  MINUS,
+  MUL,
+  DIV,
+  MOD,
+  EQUALS,
+  NOT_EQUALS,
+  LESS,
+  GREATER,
+  LESS_OR_EQ,
+  GREATER_OR_EQ,
+
+  // unary operations
+  NOT,
+  UNARY_MINUS,
+  UNARY_PLUS,
+
+  // type specialized instructions
+
+#define ADD_TYPED_OPCODES(name, type) LOAD_##name, WRITE_##name,
+#define ADD_OPCODE(name, ...) name,
+#define ADD_ASSIGN_OPCODE(name, ...) ASSIGN_##name,
+  // operands: slot index
+  // LOAD_BOOL, LOAD_INT, ...
+  // WRITE_BOOL, WRITE_INT, ...
+  INTERPRETER_VALUE_TYPES(ADD_TYPED_OPCODES)
+  INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(ADD_OPCODE)
+  INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(ADD_OPCODE)
+  // operands: slot index of the variable
+  INTERPRETER_SPECIALIZED_ASSIGNMENTS(ADD_ASSIGN_OPCODE)
+  // appends the popped string to the variable, s = s + a + b is
+  // LOAD_STR s; <a>; PLUS_STR_STR; <b>; PLUS_STR_STR; ASSIGN_STR_STR s
+  // specialized to <a>; APPEND_STR s; <b>; APPEND_STR s; LOAD_STR s
+  // operands: slot index of the variable
+  APPEND_STR,
+#undef ADD_ASSIGN_OPCODE
+#undef ADD_OPCODE
+#undef ADD_TYPED_OPCODES
+
+  // fused instructions, emitted by FuseInstructions
+
+#define ADD_STORE_OPCODE(name, ...) STORE_##name,
+#define ADD_FUSED_JUMPS(name, ...)                                     \
+  JUMP_FALSE_##name##_INT, JUMP_FALSE_##name##_INT_C,                  \
+      JUMP_FALSE_##name##_INT_VC, JUMP_FALSE_##name##_INT_VV,
+  // assignment which pops the value
+  // operands: slot index of the variable
+  INTERPRETER_SPECIALIZED_ASSIGNMENTS(ADD_STORE_OPCODE)
+  // operands: slot index of the variable, immediate int
+  INCREMENT_INT,
+  DECREMENT_INT,
+  // jumps if the comparison of ints is false, the label is the first operand
+  // JUMP_FALSE_LESS_INT     operands: label
+  // JUMP_FALSE_LESS_INT_C   operands: label, immediate rhs
+  // JUMP_FALSE_LESS_INT_VC  operands: label, lhs slot index, immediate rhs
+  // JUMP_FALSE_LESS_INT_VV  operands: label, lhs slot index, rhs slot index
+  INTERPRETER_FUSED_COMPARISONS(ADD_FUSED_JUMPS)
+#undef ADD_FUSED_JUMPS
+#undef ADD_STORE_OPCODE
+
+  _END,
 };
 
-class NoOp : public Instruction {
- public:
-  void Execute(ExecutionContext& context) const;
+struct OpCodeInfo {
+  std::string_view name;
+  size_t operands_count = 0;
+  bool is_jump = false;
+  // false if the next instruction is never executed after this one
+  bool falls_through = true;
+  // stack effect
+  size_t pops = 0;
+  size_t pushes = 0;
+  // the popped operand stays on the stack if the jump is taken
+  bool keeps_operand_on_jump = false;
 };
 
-class InstructionsBlock : public Instruction {
- public:
-  inline explicit InstructionsBlock(
-      std::vector<std::shared_ptr<Instruction>> instructions)
-      : instructions_{std::move(instructions)} {}
-  void Execute(ExecutionContext& context) const override;
+[[nodiscard]] constexpr OpCodeInfo GetOpCodeInfo(OpCode op_code) noexcept {
+  // waiting for c++20 using enums
+  switch (op_code) {
+    case OpCode::NOP:
+      return {.name = "NOP"};
+    case OpCode::HALT:
+      return {.name = "HALT", .falls_through = false};
+    case OpCode::LOOP_HEADER:
+      return {.name = "LOOP_HEADER", .operands_count = 1};
+    case OpCode::READ:
+      return {.name = "READ", .operands_count = 2};
+    case OpCode::WRITE:
+      return {.name = "WRITE", .pops = 1};
+    case OpCode::POP:
+      return {.name = "POP", .pops = 1};
+    case OpCode::INVOKE_CONSTANT:
+      return {.name = "INVOKE_CONSTANT", .operands_count = 1, .pushes = 1};
+    case OpCode::INVOKE_VARIABLE:
+      return {.name = "INVOKE_VARIABLE", .operands_count = 2, .pushes = 1};
+    case OpCode::GOTO:
+      return {.name = "GOTO",
+              .operands_count = 1,
+              .is_jump = true,
+              .falls_through = false};
+    case OpCode::JUMP_FALSE:
+      return {.name = "JUMP_FALSE",
+              .operands_count = 1,
+              .is_jump = true,
+              .pops = 1};
+    case OpCode::JUMP_TRUE:
+      return {.name = "JUMP_TRUE",
+              .operands_count = 1,
+              .is_jump = true,
+              .pops = 1};
+    case OpCode::JUMP_FALSE_OR_POP:
+      return {.name = "JUMP_FALSE_OR_POP",
+              .operands_count = 1,
+              .is_jump = true,
+              .pops = 1,
+              .keeps_operand_on_jump = true};
+    case OpCode::JUMP_TRUE_OR_POP:
+      return {.name = "JUMP_TRUE_OR_POP",
+              .operands_count = 1,
+              .is_jump = true,
+              .pops = 1,
+              .keeps_operand_on_jump = true};
+    case OpCode::ASSIGN:
+      return {.name = "ASSIGN", .pops = 2, .pushes = 1};
+    case OpCode::PLUS:
+      return {.name = "PLUS", .pops = 2, .pushes = 1};
+    case OpCode::MINUS:
+      return {.name = "MINUS", .pops = 2, .pushes = 1};
+    case OpCode::MUL:
+      return {.name = "MUL", .pops = 2, .pushes = 1};
+    case OpCode::DIV:
+      return {.name = "DIV", .pops = 2, .pushes = 1};
+    case OpCode::MOD:
+      return {.name = "MOD", .pops = 2, .pushes = 1};
+    case OpCode::EQUALS:
+      return {.name = "EQUALS", .pops = 2, .pushes = 1};
+    case OpCode::NOT_EQUALS:
+      return {.name = "NOT_EQUALS", .pops = 2, .pushes = 1};
+    case OpCode::LESS:
+      return {.name = "LESS", .pops = 2, .pushes = 1};
+    case OpCode::GREATER:
+      return {.name = "GREATER", .pops = 2, .pushes = 1};
+    case OpCode::LESS_OR_EQ:
+      return {.name = "LESS_OR_EQ", .pops = 2, .pushes = 1};
+    case OpCode::GREATER_OR_EQ:
+      return {.name = "GREATER_OR_EQ", .pops = 2, .pushes = 1};
+    case OpCode::NOT:
+      return {.name = "NOT", .pops = 1, .pushes = 1};
+    case OpCode::UNARY_MINUS:
+      return {.name = "UNARY_MINUS", .pops = 1, .pushes = 1};
+    case OpCode::UNARY_PLUS:
+      return {.name = "UNARY_PLUS", .pops = 1, .pushes = 1};
+
+#define ADD_TYPED_INFO(op, type)                                     \
+  case OpCode::LOAD_##op:                                            \
+    return {.name = "LOAD_" #op, .operands_count = 1, .pushes = 1}; \
+  case OpCode::WRITE_##op:                                           \
+    return {.name = "WRITE_" #op, .pops = 1};
+#define ADD_BINARY_INFO(op, ...) \
+  case OpCode::op:               \
+    return {.name = #op, .pops = 2, .pushes = 1};
+#define ADD_UNARY_INFO(op, ...) \
+  case OpCode::op:              \
+    return {.name = #op, .pops = 1, .pushes = 1};
+#define ADD_ASSIGN_INFO(op, ...)                          \
+  case OpCode::ASSIGN_##op:                               \
+    return {.name = "ASSIGN_" #op,                        \
+            .operands_count = 1,                          \
+            .pops = 1,                                    \
+            .pushes = 1};                                 \
+  case OpCode::STORE_##op:                                \
+    return {.name = "STORE_" #op, .operands_count = 1, .pops = 1};
+#define ADD_FUSED_JUMPS_INFO(op, ...)                     \
+  case OpCode::JUMP_FALSE_##op##_INT:                     \
+    return {.name = "JUMP_FALSE_" #op "_INT",             \
+            .operands_count = 1,                          \
+            .is_jump = true,                              \
+            .pops = 2};                                   \
+  case OpCode::JUMP_FALSE_##op##_INT_C:                   \
+    return {.name = "JUMP_FALSE_" #op "_INT_C",           \
+            .operands_count = 2,                          \
+            .is_jump = true,                              \
+            .pops = 1};                                   \
+  case OpCode::JUMP_FALSE_##op##_INT_VC:                  \
+    return {.name = "JUMP_FALSE_" #op "_INT_VC",          \
+            .operands_count = 3,                          \
+            .is_jump = true};                             \
+  case OpCode::JUMP_FALSE_##op##_INT_VV:                  \
+    return {.name = "JUMP_FALSE_" #op "_INT_VV",          \
+            .operands_count = 3,                          \
+            .is_jump = true};
+
+      INTERPRETER_VALUE_TYPES(ADD_TYPED_INFO)
+      INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(ADD_BINARY_INFO)
+      INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(ADD_UNARY_INFO)
+      INTERPRETER_SPECIALIZED_ASSIGNMENTS(ADD_ASSIGN_INFO)
+      INTERPRETER_FUSED_COMPARISONS(ADD_FUSED_JUMPS_INFO)
+
+#undef ADD_TYPED_INFO
+#undef ADD_BINARY_INFO
+#undef ADD_UNARY_INFO
+#undef ADD_ASSIGN_INFO
+#undef ADD_FUSED_JUMPS_INFO
+
+    case OpCode::APPEND_STR:
+      return {.name = "APPEND_STR", .operands_count = 1, .pops = 1};
+
+    case OpCode::INCREMENT_INT:
+      return {.name = "INCREMENT_INT", .operands_count = 2};
+    case OpCode::DECREMENT_INT:
+      return {.name = "DECREMENT_INT", .operands_count = 2};
+
+    case OpCode::_END:
+      break;
+  }
+  return {.name = "<unknown>"};
+}
 
- private:
-  std::vector<std::shared_ptr<Instruction>> instructions_;
-};
+namespace details {
 
-class VariableDefinition : public Instruction {
- public:
-  inline explicit VariableDefinition(std::string name,
-                                     Value initial_value) noexcept
-      : name_{std::move(name)}, initial_value_{std::move(initial_value)} {}
-  void Execute(ExecutionContext& context) const override;
+template <size_t... I>
+consteval auto MakeInstructionSizes(std::index_sequence<I...>) noexcept {
+  return std::array<CodeUnit, sizeof...(I)>{static_cast<CodeUnit>(
+      1 + GetOpCodeInfo(static_cast<OpCode>(I)).operands_count)...};
+}
 
- private:
-  std::string name_;
-  Value initial_value_;
-};
+inline constexpr auto INSTRUCTION_SIZES = MakeInstructionSizes(
+    std::make_index_sequence<static_cast<size_t>(OpCode::_END)>{});
 
-class Write : public Instruction {
- public:
-  void Execute(ExecutionContext& context) const override;
-};
+}  // namespace details
 
-class Read : public Instruction {
- public:
-  inline explicit Read(std::string variable_name) noexcept
-      : variable_name_{std::move(variable_name)} {}
-  void Execute(ExecutionContext& context) const override;
+// Size of the whole instruction in code units
+[[nodiscard]] constexpr size_t GetInstructionSize(OpCode op_code) noexcept {
+  return details::INSTRUCTION_SIZES[static_cast<size_t>(op_code)];
+}
 
- private:
-  std::string variable_name_;
-};
+// Calls handler(label, op_code, operands) for every instruction of the code
+template <typename Handler>
+void ForEachInstruction(std::span<const CodeUnit> code, Handler&& handler) {
+  for (Label label = 0; label < code.size();) {
+    const auto op_code = static_cast<OpCode>(code[label]);
+    const auto size = GetInstructionSize(op_code);
+    handler(label, op_code, code.subspan(label + 1, size - 1));
+    label += size;
+  }
+}
 
-class Pop : public Instruction {
- public:
-  void Execute(ExecutionContext& context) const override;
+// Output of the instructions writer, transformed by the optimization passes
+struct Bytecode {
+  std::vector<CodeUnit> code;
+  ConstantPool constants;
+  FrameLayout frame_layout;
 };
 
-class InvokeConstant : public Instruction {
+// Fixed size stack, its capacity is proven by the analysis of the code,
+// so there are no bound checks
+class OperandStack {
  public:
-  // TODO: dont use Variable
-  inline explicit InvokeConstant(Value value) noexcept
-      : value_{std::move(value)} {}
-  void Execute(ExecutionContext& context) const override;
+  OperandStack() = default;
+  inline explicit OperandStack(size_t capacity)
+      : values_{std::make_unique<Cell[]>(capacity)},
+        top_{values_.get()} {}
+
+  // The cells above the top never own strings, so they are overwritten
+  // without the destruction
+  inline void Push(Cell value) noexcept {
+    std::construct_at(top_++, std::move(value));
+  }
+  inline Cell Pop() noexcept { return std::move(*--top_); }
+  inline void Drop() noexcept { (--top_)->Reset(); }
+  // The top is proven not to be a string, so it's not destroyed
+  inline void DropScalar() noexcept { --top_; }
+  // depth 0 is the top
+  [[nodiscard]] inline Cell& Top(size_t depth = 0) noexcept {
+    return top_[-1 - static_cast<std::ptrdiff_t>(depth)];
+  }
 
  private:
-  Value value_;
+  std::unique_ptr<Cell[]> values_;
+  Cell* top_ = nullptr;
 };
 
-class InvokeVariable : public Instruction {
- public:
-  inline explicit InvokeVariable(std::string name) noexcept
-      : name_{std::move(name)} {}
-  void Execute(ExecutionContext& context) const override;
-
- private:
-  std::string name_;
+struct ExecutionContext {
+  // TODO: add reference to parent
+  std::istream& input;
+  std::ostream& output;
+  Frame frame;
+  OperandStack values_stack;
+  Label current_instruction;
 };
 
-class JumpInstruction : public Instruction {
- public:
-  inline explicit JumpInstruction(Label label) noexcept : label_{label} {}
-  inline void SetLabel(Label label) noexcept { label_ = label; }
-
- protected:
-  Label label_;
+// Checked by LOOP_HEADER: the execution stops at the header once its loop
+// runs more than the given iterations or once the flag is set, e.g. by the
+// background thread
+struct LoopWatch {
+  // indexed by the loop
+  std::vector<size_t> iterations;
+  size_t max_iterations = std::numeric_limits<size_t>::max();
+  const std::atomic<bool>* stop = nullptr;
+
+  [[nodiscard]] inline bool IsStopped(CodeUnit loop) noexcept {
+    return ++iterations[loop] > max_iterations ||
+           (stop != nullptr && stop->load(std::memory_order_acquire));
+  }
 };
 
-class GoTo : public JumpInstruction {
+class InstructionsBlock {
  public:
-  inline explicit GoTo(Label label = 0) noexcept : JumpInstruction{label} {}
-  void Execute(ExecutionContext& context) const override;
-};
+  // Verifies the code, throws AnalysisError on inconsistent stack usage
+  explicit InstructionsBlock(Bytecode bytecode);
 
-class JumpBool : public JumpInstruction {
- public:
-  inline explicit JumpBool(bool jump_statement, Label label = 0) noexcept
-      : JumpInstruction{label}, jump_statement_{jump_statement} {}
-  void Execute(ExecutionContext& context) const override;
+  void Execute(ExecutionContext& context) const;
+  // Runs the code in the prepared context from its current instruction until
+  // HALT. If the watch stops a loop, the execution stops at its header and the
+  // loop is returned.
+  std::optional<CodeUnit> Resume(ExecutionContext& context,
+                                 LoopWatch* watch = nullptr) const;
+
+  [[nodiscard]] inline const auto& GetCode() const noexcept {
+    return bytecode_.code;
+  }
+  [[nodiscard]] inline const auto& GetConstants() const noexcept {
+    return bytecode_.constants;
+  }
+  [[nodiscard]] inline const auto& GetFrameLayout() const noexcept {
+    return bytecode_.frame_layout;
+  }
+  [[nodiscard]] inline size_t GetMaxStackDepth() const noexcept {
+    return max_stack_depth_;
+  }
 
  private:
-  bool jump_statement_;
+  Bytecode bytecode_;
+  // constants in the form of the operand stack values
+  std::vector<Cell> constants_;
+  size_t max_stack_depth_;
 };
 
-class JumpFalse : public JumpBool {
- public:
-  inline explicit JumpFalse(Label label = 0) noexcept
-      : JumpBool{false, label} {}
-};
-
-class JumpTrue : public JumpBool {
- public:
-  inline explicit JumpTrue(Label label = 0) noexcept : JumpBool{true, label} {}
-};
-
-template <typename BinaryOpHandler>
-class BinaryOp : public Instruction {
- public:
-  void Execute(ExecutionContext& context) const override;
-};
-
-template <typename UnaryOpHandler>
-class UnaryOp : public Instruction {
- public:
-  void Execute(ExecutionContext& context) const override;
-};
+// Prints human readable listing of the code, one instruction per line
+void Disassemble(const InstructionsBlock& block, std::ostream& output);
 
 }  // namespace interpreter::instructions
-
-template <typename BinaryOpHandler>
-void interpreter::instructions::BinaryOp<BinaryOpHandler>::Execute(
-    ExecutionContext& context) const {
-  auto& stack = context.values_stack;
-  if (stack.size() < 2) {
-    // TODO: something smarter pls
-    throw RuntimeError{"Error, no operands for binary expression"};
-  }
-
-  auto rhs = stack.top();
-  stack.pop();
-
-  auto lhs = stack.top();
-  stack.pop();
-
-  stack.push(PerformOperation<BinaryOpHandler>(std::move(lhs), std::move(rhs)));
-}
-
-template <typename UnaryOpHandler>
-void interpreter::instructions::UnaryOp<UnaryOpHandler>::Execute(
-    ExecutionContext& context) const {
-  auto& stack = context.values_stack;
-  if (stack.size() < 1) {
-    // TODO: something smarter pls
-    throw RuntimeError{"Error: no operands for unary expression"};
-  }
-
-  auto value = stack.top();
-  stack.pop();
-
-  stack.push(PerformOperation<UnaryOpHandler>(std::move(value)));
-}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "registers.hpp"
+
+namespace interpreter::instructions {
+
+// Native x86-64 code of a loop of the register code. Covers the operations on
+// the bools, ints and reals and the jumps, the other instructions and the
+// divisions by zero exit to the interpreter at their label.
+class JitCode {
+ public:
+  // Returns the label where the interpreter continues: the exit of the loop
+  // or the instruction which isn't compiled
+  Label Run(Cell* registers) const;
+
+ private:
+  friend std::optional<JitCode> CompileLoop(std::span<const CodeUnit> code,
+                                            Label header, Label end);
+
+  struct Unmap {
+    size_t size;
+    void operator()(std::uint8_t* memory) const noexcept;
+  };
+  using Entry = Label (*)(Cell* registers);
+
+  JitCode(std::unique_ptr<std::uint8_t, Unmap> memory,
+          std::vector<Register> destinations);
+
+  // executable copy of the machine code
+  std::unique_ptr<std::uint8_t, Unmap> memory_;
+  // registers written by the native code, they are not released by it
+  std::vector<Register> destinations_;
+};
+
+// Compiles the instructions in [header, end) of the register code, the
+// jumps out of the range exit to the interpreter. Returns std::nullopt when
+// nothing is compiled or the platform isn't supported.
+[[nodiscard]] std::optional<JitCode> CompileLoop(std::span<const CodeUnit> code,
+                                                 Label header, Label end);
+
+}  // namespace interpreter::instructions
@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <stdexcept>
+#include <utility>
 
 #include "types.hpp"
 
@@ -65,12 +66,15 @@ struct Div {
   }
 };
 
-#define ADD_DEFAULT_ASSIGN_OPERATION(name, op)              \
-  template <typename L, typename R>                         \
-  struct name {                                             \
-    constexpr auto operator()(L& lhs, const R& rhs) const { \
-      return lhs op rhs;                                    \
-    }                                                       \
+#define ADD_DEFAULT_ASSIGN_OPERATION(name, op)            \
+  template <typename L, typename R>                       \
+  struct name {                                           \
+    constexpr L& operator()(L& lhs, const R& rhs) const { \
+      return lhs op rhs;                                  \
+    }                                                     \
+    constexpr L& operator()(L& lhs, R&& rhs) const {      \
+      return lhs op std::move(rhs);                       \
+    }                                                     \
   }
 
 #define ADD_DEFAULT_UN_OPERATION(name, op)                       \
@@ -79,12 +83,16 @@ struct Div {
     constexpr auto operator()(const T& t) const { return op t; } \
   }
 
+// The left operand is moved into the result, so the strings reuse its buffer
 #define ADD_DEFAULT_BIN_OPERATION(name, op)                       \
   template <typename L, typename R>                               \
   struct name {                                                   \
     constexpr auto operator()(const L& lhs, const R& rhs) const { \
       return lhs op rhs;                                          \
     }                                                             \
+    constexpr auto operator()(L&& lhs, const R& rhs) const {      \
+      return std::move(lhs) op rhs;                               \
+    }                                                             \
   }
 
 ADD_DEFAULT_ASSIGN_OPERATION(Assign, =);
@@ -305,6 +313,11 @@ inline constexpr const T& Unwrap(const T& value) noexcept {
   return value;
 }
 
+template <ValueT T>
+inline constexpr T&& Unwrap(T&& value) noexcept {
+  return std::move(value);
+}
+
 template <ReferenceT T>
 inline constexpr auto Unwrap(T value) noexcept
     -> std::add_lvalue_reference_t<typename TypeTraits<T>::ValueType> {
@@ -315,8 +328,8 @@ inline constexpr auto Unwrap(T value) noexcept
 
 // TODO: looks like should be refactored
 template <typename Visitor, SameAsOperationValue... OperationValues>
-auto VisitOperationValues(Visitor&& visitor,
-                          OperationValues&&... operation_values) {
+constexpr auto VisitOperationValues(Visitor&& visitor,
+                                    OperationValues&&... operation_values) {
   return std::visit(
       [&visitor]<typename... Args>(Args && ... args) mutable {
         return std::visit(std::forward<Visitor>(visitor),
@@ -332,16 +345,20 @@ struct OperationPerformer {
     constexpr auto rule = details::GetPerformRule<
         Op, typename details::PerformTraits<Values>::PerformType...>();
     if constexpr (IsPerformableRule(rule)) {
-      return rule(details::Unwrap(std::forward<Values>(values))...);
+      // the result is always a value, even the result of the assignment
+      return Value{rule(details::Unwrap(std::forward<Values>(values))...)};
     } else {
       throw NotDefinedOperationError{"Operation is not defined"};
     }
   }
 };
 
+// The operands are forwarded: the operations on the strings reuse the buffers
+// of the temporary ones
 template <OperationT Op, SameAsOperationValue... Values>
-constexpr OperationValue PerformOperation(Values... values) {
-  return VisitOperationValues(OperationPerformer<Op>{}, std::move(values)...);
+constexpr OperationValue PerformOperation(Values&&... values) {
+  return VisitOperationValues(OperationPerformer<Op>{},
+                              std::forward<Values>(values)...);
 }
 
 }  // namespace interpreter::instructions
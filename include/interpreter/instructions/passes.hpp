@@ -0,0 +1,51 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "analysis.hpp"
+#include "instructions.hpp"
+
+namespace interpreter::instructions {
+
+struct TypeError : public AnalysisError {
+  using AnalysisError::AnalysisError;
+};
+
+// Infers types of the operand stack and replaces generic instructions with the
+// type specialized ones. Operands of the variables are loaded by value unless
+// they are assigned or the variable is changed before the operand is used,
+// such operations are left generic. Concatenations assigned back to their left
+// operand (s = s + a) append to the variable in place. Throws TypeError if
+// some operation is not defined for the types of its operands.
+void SpecializeTypes(Bytecode& bytecode);
+
+// Evaluates operations on the constants with details::Rule at compile time
+// and resolves conditional jumps on the constant conditions. Operations
+// which fail (e.g. zero division) are left for the runtime.
+void FoldConstants(Bytecode& bytecode);
+
+// Removes unreachable instructions and jumps to the next instruction
+void EliminateDeadCode(Bytecode& bytecode);
+
+// Threads jumps through the chains of GOTO and the conditional jumps with the
+// known condition, inverts conditional jumps over GOTO, removes NOP. Jumps to
+// the next instruction are left for EliminateDeadCode.
+void ThreadJumps(Bytecode& bytecode);
+
+// Replaces frequent sequences of the specialized instructions with the fused
+// ones: increment of a variable, assignment which drops its value, comparison
+// of ints followed by the conditional jump. Loads of the variables which are
+// popped right away are removed. Should be the last pass, the other passes
+// don't know the fused instructions.
+void FuseInstructions(Bytecode& bytecode);
+
+// Removes LOOP_HEADER. Returns the labels of the loop headers in the new code
+// by the loop index, std::nullopt for the loops removed by the other passes.
+std::vector<std::optional<Label>> StripLoopHeaders(Bytecode& bytecode);
+
+// Runs the passes shared by the backends, from SpecializeTypes to
+// EliminateDeadCode. Leaves the fusion to the stack machine.
+void OptimizeBytecode(Bytecode& bytecode);
+
+}  // namespace interpreter::instructions
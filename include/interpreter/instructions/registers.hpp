@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "instructions.hpp"
+
+namespace interpreter::instructions {
+
+// Index in the register file: the variables, then the constants, then the
+// temporaries of the expressions
+using Register = CodeUnit;
+
+// Three-address instructions, the operands are the registers unless noted
+enum class RegisterOpCode : CodeUnit {
+  HALT,
+
+  // operands: destination, source
+  MOVE,
+
+  // operands: label
+  GOTO,
+  // operands: label, condition
+  JUMP_FALSE,
+  JUMP_TRUE,
+
+#define ADD_TYPED_OPCODES(name, type) READ_##name, WRITE_##name,
+#define ADD_OPCODE(name, ...) name,
+#define ADD_ASSIGN_OPCODE(name, ...) ASSIGN_##name,
+#define ADD_FUSED_JUMP(name, ...) JUMP_FALSE_##name##_INT,
+  // operands: variable
+  // READ_BOOL, READ_INT, ...
+  // operands: source
+  // WRITE_BOOL, WRITE_INT, ...
+  INTERPRETER_VALUE_TYPES(ADD_TYPED_OPCODES)
+  // operands: destination, lhs, rhs
+  INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(ADD_OPCODE)
+  // operands: destination, operand
+  INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(ADD_OPCODE)
+  // converts the source to the type of the destination
+  // operands: destination, source
+  INTERPRETER_SPECIALIZED_ASSIGNMENTS(ADD_ASSIGN_OPCODE)
+  // operands: destination, source
+  APPEND_STR,
+  // jumps if the comparison of ints is false
+  // operands: label, lhs, rhs
+  INTERPRETER_FUSED_COMPARISONS(ADD_FUSED_JUMP)
+#undef ADD_FUSED_JUMP
+#undef ADD_ASSIGN_OPCODE
+#undef ADD_OPCODE
+#undef ADD_TYPED_OPCODES
+
+  _END,
+};
+
+struct RegisterOpCodeInfo {
+  std::string_view name;
+  size_t operands_count = 0;
+  // the label is the first operand
+  bool is_jump = false;
+  // the result is written to the first operand
+  bool has_destination = false;
+};
+
+[[nodiscard]] constexpr RegisterOpCodeInfo GetRegisterOpCodeInfo(
+    RegisterOpCode op_code) noexcept {
+  // waiting for c++20 using enums
+  switch (op_code) {
+    case RegisterOpCode::HALT:
+      return {.name = "HALT"};
+    case RegisterOpCode::MOVE:
+      return {.name = "MOVE", .operands_count = 2, .has_destination = true};
+    case RegisterOpCode::GOTO:
+      return {.name = "GOTO", .operands_count = 1, .is_jump = true};
+    case RegisterOpCode::JUMP_FALSE:
+      return {.name = "JUMP_FALSE", .operands_count = 2, .is_jump = true};
+    case RegisterOpCode::JUMP_TRUE:
+      return {.name = "JUMP_TRUE", .operands_count = 2, .is_jump = true};
+    case RegisterOpCode::APPEND_STR:
+      return {.name = "APPEND_STR",
+              .operands_count = 2,
+              .has_destination = true};
+
+#define ADD_TYPED_INFO(op, type)                                     \
+  case RegisterOpCode::READ_##op:                                    \
+    return {.name = "READ_" #op,                                     \
+            .operands_count = 1,                                     \
+            .has_destination = true};                                \
+  case RegisterOpCode::WRITE_##op:                                   \
+    return {.name = "WRITE_" #op, .operands_count = 1};
+#define ADD_BINARY_INFO(op, ...) \
+  case RegisterOpCode::op:       \
+    return {.name = #op, .operands_count = 3, .has_destination = true};
+#define ADD_UNARY_INFO(op, ...) \
+  case RegisterOpCode::op:      \
+    return {.name = #op, .operands_count = 2, .has_destination = true};
+#define ADD_ASSIGN_INFO(op, ...)          \
+  case RegisterOpCode::ASSIGN_##op:       \
+    return {.name = "ASSIGN_" #op,        \
+            .operands_count = 2,          \
+            .has_destination = true};
+#define ADD_FUSED_JUMP_INFO(op, ...)          \
+  case RegisterOpCode::JUMP_FALSE_##op##_INT: \
+    return {.name = "JUMP_FALSE_" #op "_INT", \
+            .operands_count = 3,              \
+            .is_jump = true};
+
+      INTERPRETER_VALUE_TYPES(ADD_TYPED_INFO)
+      INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(ADD_BINARY_INFO)
+      INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(ADD_UNARY_INFO)
+      INTERPRETER_SPECIALIZED_ASSIGNMENTS(ADD_ASSIGN_INFO)
+      INTERPRETER_FUSED_COMPARISONS(ADD_FUSED_JUMP_INFO)
+
+#undef ADD_TYPED_INFO
+#undef ADD_BINARY_INFO
+#undef ADD_UNARY_INFO
+#undef ADD_ASSIGN_INFO
+#undef ADD_FUSED_JUMP_INFO
+
+    case RegisterOpCode::_END:
+      break;
+  }
+  return {.name = "<unknown>"};
+}
+
+namespace details {
+
+template <size_t... I>
+consteval auto MakeRegisterInstructionSizes(
+    std::index_sequence<I...>) noexcept {
+  return std::array<CodeUnit, sizeof...(I)>{static_cast<CodeUnit>(
+      1 +
+      GetRegisterOpCodeInfo(static_cast<RegisterOpCode>(I)).operands_count)...};
+}
+
+inline constexpr auto REGISTER_INSTRUCTION_SIZES =
+    MakeRegisterInstructionSizes(
+        std::make_index_sequence<static_cast<size_t>(RegisterOpCode::_END)>{});
+
+}  // namespace details
+
+// Size of the whole instruction in code units
+[[nodiscard]] constexpr size_t GetRegisterInstructionSize(
+    RegisterOpCode op_code) noexcept {
+  return details::REGISTER_INSTRUCTION_SIZES[static_cast<size_t>(op_code)];
+}
+
+struct JitOptions {
+  // backward jumps to the header of the loop before it's compiled
+  size_t hot_loop_iterations = 1000;
+};
+
+// Alternative backend: the stack code is translated to the instructions which
+// work with the variables directly, the values of the operand stack are kept
+// in the temporary registers, one per stack depth
+class RegisterBlock {
+ public:
+  // The types of the code should be specialized and the instructions should
+  // not be fused. Throws AnalysisError on the code it can't translate.
+  explicit RegisterBlock(const Bytecode& bytecode);
+
+  // The hot loops are compiled to the native code if the jit is enabled
+  void Execute(ExecutionContext& context,
+               std::optional<JitOptions> jit = std::nullopt) const;
+  // Continues from the label with the register file of a suspended run, the
+  // registers should hold the types the code expects at the label
+  void Resume(ExecutionContext& context, std::span<Cell> registers,
+              Label pc, std::optional<JitOptions> jit = std::nullopt) const;
+
+  [[nodiscard]] inline const auto& GetCode() const noexcept { return code_; }
+  [[nodiscard]] inline size_t GetRegistersCount() const noexcept {
+    return registers_.size();
+  }
+  [[nodiscard]] inline const auto& GetInitialRegisters() const noexcept {
+    return registers_;
+  }
+
+ private:
+  std::vector<CodeUnit> code_;
+  // initial values of the register file
+  std::vector<Cell> registers_;
+};
+
+// Prints human readable listing of the code, one instruction per line
+void Disassemble(const RegisterBlock& block, std::ostream& output);
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+#include "instructions.hpp"
+
+namespace interpreter::instructions {
+
+// Builds new code out of the old one for the optimization passes. Every old
+// instruction should be bound before emitting its replacement, then jumps of
+// the new code, which still point to old labels, are relocated by Finish.
+class CodeRewriter {
+ public:
+  explicit CodeRewriter(std::span<const CodeUnit> old_code);
+
+  // Jumps to the old label will land on the next emitted instruction
+  void Bind(Label old_label);
+  void Emit(OpCode op_code, std::initializer_list<CodeUnit> operands = {});
+  void Emit(OpCode op_code, std::span<const CodeUnit> operands);
+  // Binds the old instruction and copies it as is
+  void Copy(Label old_label);
+  // Label of the next emitted instruction in the new code
+  [[nodiscard]] inline Label CurrentLabel() const noexcept {
+    return code_.size();
+  }
+
+  [[nodiscard]] std::vector<CodeUnit> Finish() &&;
+
+ private:
+  std::span<const CodeUnit> old_code_;
+  std::vector<CodeUnit> code_;
+  std::vector<Label> relocations_;
+};
+
+}  // namespace interpreter::instructions
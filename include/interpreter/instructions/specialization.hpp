@@ -0,0 +1,29 @@
+#pragma once
+
+#include <optional>
+
+#include "instructions.hpp"
+
+namespace interpreter::instructions {
+
+// Tables of the type specialized instructions, shared by SpecializeTypes and
+// the translation of the stack code to the registers
+
+struct Specialization {
+  OpCode op_code;
+  ast::VariableType result_type;
+};
+
+[[nodiscard]] std::optional<Specialization> FindBinarySpecialization(
+    OpCode generic, ast::VariableType lhs, ast::VariableType rhs);
+[[nodiscard]] std::optional<Specialization> FindUnarySpecialization(
+    OpCode generic, ast::VariableType type);
+[[nodiscard]] std::optional<OpCode> FindAssignSpecialization(
+    ast::VariableType variable, ast::VariableType value);
+
+// Returns the op code itself for the generic instructions
+[[nodiscard]] OpCode GetGenericOpCode(OpCode op_code);
+
+[[nodiscard]] ast::VariableType GetValueType(const Value& value);
+
+}  // namespace interpreter::instructions
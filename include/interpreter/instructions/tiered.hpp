@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+#include "instructions.hpp"
+
+namespace interpreter::instructions {
+
+struct TieringOptions {
+  // iterations of a loop before the optimization of the code starts
+  size_t hot_loop_iterations = 1000;
+};
+
+// Stack code which starts as written, without the optimization passes. The
+// first loop which gets hot starts the optimization of the whole code in the
+// background thread, the execution switches to the optimized code at the
+// next loop header it reaches: the frame is kept and the operand stack is
+// empty there. The program which ends first doesn't wait for the thread. If
+// the optimization fails on the types, the code as written reports the error
+// when it reaches the operation.
+class TieredBlock {
+ public:
+  // The code should come right from the writer, with the loop headers
+  explicit TieredBlock(Bytecode bytecode, TieringOptions options = {});
+
+  void Execute(ExecutionContext& context) const;
+
+  [[nodiscard]] inline const InstructionsBlock& GetBaseline() const noexcept {
+    return baseline_;
+  }
+
+ private:
+  InstructionsBlock baseline_;
+  TieringOptions options_;
+  size_t loops_count_ = 0;
+};
+
+}  // namespace interpreter::instructions
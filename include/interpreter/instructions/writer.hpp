@@ -1,11 +1,19 @@
 #pragma once
 
-#include <memory>
+#include <functional>
+#include <initializer_list>
 #include <optional>
+#include <string_view>
+#include <variant>
 #include <vector>
 
+#include "batch.hpp"
 #include "instructions.hpp"
+#include "operations.hpp"
+#include "registers.hpp"
+#include "tiered.hpp"
 #include "interpreter/ast/visitor.hpp"
+#include "interpreter/utils/format.hpp"
 
 namespace interpreter::instructions {
 
@@ -13,57 +21,357 @@ struct WriterError : public std::runtime_error {
   using std::runtime_error::runtime_error;
 };
 
+namespace details {
+
+[[nodiscard]] constexpr OpCode MapCompareOpCode(
+    ast::CompareType compare_type) {
+  // TODO: pls smt smarter
+  using Compare = ast::CompareType;
+  switch (compare_type) {
+    // waiting for c++20 using enums
+    case Compare::EQ:
+      return OpCode::EQUALS;
+    case Compare::NE:
+      return OpCode::NOT_EQUALS;
+    case Compare::LT:
+      return OpCode::LESS;
+    case Compare::GT:
+      return OpCode::GREATER;
+    case Compare::LE:
+      return OpCode::LESS_OR_EQ;
+    case Compare::GE:
+      return OpCode::GREATER_OR_EQ;
+      // TODO: all operations
+  }
+  throw WriterError{"Unimplemented mapping for ast::CompareType"};
+}
+
+[[nodiscard]] constexpr OpCode MapAddOpCode(ast::AddType add_type) {
+  // TODO: pls smt smarter
+  using Add = ast::AddType;
+  switch (add_type) {
+    // waiting for c++20 using enums
+    case Add::PLUS:
+      return OpCode::PLUS;
+    case Add::MINUS:
+      return OpCode::MINUS;
+  }
+  throw WriterError{"Unimplemented mapping for ast::AddType"};
+}
+
+[[nodiscard]] constexpr OpCode MapMulOpCode(ast::MulType mul_type) {
+  // TODO: pls smt smarter
+  using Mul = ast::MulType;
+  switch (mul_type) {
+    // waiting for c++20 using enums
+    case Mul::MUL:
+      return OpCode::MUL;
+    case Mul::DIV:
+      return OpCode::DIV;
+    case Mul::MOD:
+      return OpCode::MOD;
+      // TODO: all operations
+  }
+  throw WriterError{"Unimplemented mapping for ast::MulType"};
+}
+
+[[nodiscard]] constexpr Value MakeDefaultValue(ast::VariableType type) {
+  // waiting for c++20 using enums
+  switch (type) {
+    case ast::VariableType::INT:
+      return types::Int{};
+    case ast::VariableType::REAL:
+      return types::Real{};
+    case ast::VariableType::BOOL:
+      return types::Bool{};
+    case ast::VariableType::STR:
+      return types::Str{};
+    case ast::VariableType::_END:
+      break;
+  }
+  throw WriterError{"Unknown variable type"};
+}
+
+[[nodiscard]] constexpr OperationValue ToReference(Value& variable) {
+  return std::visit(
+      [](auto& value) -> OperationValue { return Reference{std::ref(value)}; },
+      variable);
+}
+
+[[nodiscard]] constexpr Value MakeInitialValue(
+    ast::VariableType type, std::optional<ast::Constant>&& initial_value) {
+  auto variable = MakeDefaultValue(type);
+  if (initial_value) {
+    // initialization follows the same rules as the assignment
+    PerformOperation<op_type::Assign>(
+        ToReference(variable),
+        OperationValue{std::visit(
+            [](auto&& initial) -> Value { return std::move(initial); },
+            std::move(initial_value)->value)});
+  }
+  return variable;
+}
+
+}  // namespace details
+
+// Writes the generic code of the stack machine. Works in the constant
+// evaluation, so the programs embedded in the C++ code are compiled by the
+// same writer, see compile_time::Compile.
 class InstructionsWriter : public ast::ModelVisitor {
  public:
-  void VisitProgram() override;
-  void VisitDeclarations() override;
-  void VisitVariableDeclaration(
-      ast::VariableType type, std::string&& name,
-      std::optional<ast::Constant>&& initial_value = std::nullopt) override;
-  void VisitOperators() override;
-  void VisitRead(std::string&& name) override;
-  void VisitWrite() override;
-  void VisitExpressionOperator() override;
-
-  void VisitIf() override;
-  void VisitElse() override;
-  void VisitEndIf() override;
-
-  void VisitWhile() override;
-  void VisitWhileBody() override;
-  void VisitEndWhile() override;
-
-  void VisitDoWhile() override;
-  void VisitDoWhileEnd() override;
-
-  void VisitBreak() override;
-  void VisitContinue() override;
+  constexpr ~InstructionsWriter() override {}
+
+  constexpr void VisitProgram() override {}
+  constexpr void VisitDeclarations() override {}
+  constexpr void VisitOperators() override {}
+
+  constexpr void VisitVariableDeclaration(
+      ast::VariableType type, lexer::Symbol symbol, std::string_view name,
+      std::optional<ast::Constant>&& initial_value = std::nullopt) override {
+    Value value;
+    try {
+      value = details::MakeInitialValue(type, std::move(initial_value));
+    } catch (const OperationError&) {
+      throw WriterError{
+          utils::format("Incorrect initial value of variable {}", name)};
+    }
+
+    if (!frame_layout_.Declare(symbol, std::move(value))) {
+      throw WriterError{
+          utils::format("Variable {} is already declared.", name)};
+    }
+  }
+
+  constexpr void VisitRead(lexer::Symbol symbol,
+                           std::string_view name) override {
+    const auto slot = frame_layout_.Find(symbol);
+    if (!slot) {
+      throw WriterError{utils::format(
+          "Failed to read variable '{}', it is not declared.", name)};
+    }
+    EmitSlot(OpCode::READ, *slot);
+  }
+
+  constexpr void VisitWrite() override { Emit(OpCode::WRITE); }
+
+  constexpr void VisitExpressionOperator() override { Emit(OpCode::POP); }
+
+  constexpr void VisitIf() override {
+    // remember this jump, label will be known at else or endif
+    jump_stack_.push_back(Emit(OpCode::JUMP_FALSE, {0}));
+  }
+
+  constexpr void VisitElse() override {
+    if (jump_stack_.empty()) {
+      throw WriterError{"Missing if block before else"};
+    }
+
+    // skip else block at the end of if block
+    const auto jump = Emit(OpCode::GOTO, {0});
+
+    // jump here from previous jump
+    SetJumpLabel(jump_stack_.back(), CurrentLabel());
+    jump_stack_.pop_back();
+
+    // remember this point
+    jump_stack_.push_back(jump);
+  }
+
+  constexpr void VisitEndIf() override {
+    if (jump_stack_.empty()) {
+      throw WriterError{"Missing if block before endif"};
+    }
+
+    // jump here from previous jump
+    SetJumpLabel(jump_stack_.back(), CurrentLabel());
+    jump_stack_.pop_back();
+  }
+
+  constexpr void VisitWhile() override {
+    // continue and the jump back land on the header of the loop
+    loops_starts_stack_.push_back(
+        Emit(OpCode::LOOP_HEADER, {loops_count_++}));
+
+    // create list of breaks
+    loops_breaks_stack_.emplace_back();
+  }
+
+  constexpr void VisitWhileBody() override {
+    // jump to end of loop on false expression
+    jump_stack_.push_back(Emit(OpCode::JUMP_FALSE, {0}));
+  }
+
+  constexpr void VisitEndWhile() override {
+    if (jump_stack_.empty() || loops_breaks_stack_.empty()) {
+      throw WriterError{"Missing while block before while end"};
+    }
+
+    // add go to loop start instruction
+    Emit(OpCode::GOTO, {static_cast<CodeUnit>(loops_starts_stack_.back())});
+    loops_starts_stack_.pop_back();
+
+    const auto loop_end_label = CurrentLabel();
+
+    SetJumpLabel(jump_stack_.back(), loop_end_label);
+    jump_stack_.pop_back();
+
+    EndLoop(loop_end_label);
+  }
+
+  constexpr void VisitDoWhile() override {
+    // continue and the jump back land on the header of the loop
+    loops_starts_stack_.push_back(
+        Emit(OpCode::LOOP_HEADER, {loops_count_++}));
+
+    // create list of breaks
+    loops_breaks_stack_.emplace_back();
+  }
+
+  constexpr void VisitDoWhileEnd() override {
+    if (loops_starts_stack_.empty() || loops_breaks_stack_.empty()) {
+      throw WriterError{"Missing do-while block before dowhile end"};
+    }
+
+    // go to loop start while expression is true
+    Emit(OpCode::JUMP_TRUE,
+         {static_cast<CodeUnit>(loops_starts_stack_.back())});
+    loops_starts_stack_.pop_back();
+
+    EndLoop(CurrentLabel());
+  }
+
+  constexpr void VisitBreak() override {
+    if (loops_breaks_stack_.empty()) {
+      throw WriterError{"break instruction outside the loop"};
+    }
+
+    // remember break for filling it in the end of loop
+    loops_breaks_stack_.back().push_back(Emit(OpCode::GOTO, {0}));
+  }
+
+  constexpr void VisitContinue() override {
+    if (loops_starts_stack_.empty()) {
+      throw WriterError{"continue instruction outside the loop"};
+    }
+
+    Emit(OpCode::GOTO, {static_cast<CodeUnit>(loops_starts_stack_.back())});
+  }
 
   // Expression States
-  void VisitAssign() override;
-  void VisitOr() override;
-  void VisitAnd() override;
-  void VisitCompare(ast::CompareType compare_type) override;
-  void VisitAdd(ast::AddType add_type) override;
-  void VisitMul(ast::MulType mul_type) override;
-  void VisitNot() override;
-  void VisitVariableInvokation(std::string&& variable_name) override;
-  void VisitConstantInvokation(ast::Constant&& constant) override;
+  constexpr void VisitAssign() override { Emit(OpCode::ASSIGN); }
 
-  [[nodiscard]] inline const auto& GetInstructions() noexcept {
-    return instructions_;
+  constexpr void VisitOrRightOperand() override {
+    // the left operand is the result if it's true
+    jump_stack_.push_back(Emit(OpCode::JUMP_TRUE_OR_POP, {0}));
   }
 
-  // pls do something better
-  [[nodiscard]] inline InstructionsBlock MakeBlock() noexcept {
-    return InstructionsBlock{std::move(instructions_)};
+  constexpr void VisitOr() override {
+    SetJumpLabel(jump_stack_.back(), CurrentLabel());
+    jump_stack_.pop_back();
+  }
+
+  constexpr void VisitAndRightOperand() override {
+    // the left operand is the result if it's false
+    jump_stack_.push_back(Emit(OpCode::JUMP_FALSE_OR_POP, {0}));
+  }
+
+  constexpr void VisitAnd() override {
+    SetJumpLabel(jump_stack_.back(), CurrentLabel());
+    jump_stack_.pop_back();
+  }
+
+  constexpr void VisitCompare(ast::CompareType compare_type) override {
+    Emit(details::MapCompareOpCode(compare_type));
+  }
+
+  constexpr void VisitAdd(ast::AddType add_type) override {
+    Emit(details::MapAddOpCode(add_type));
+  }
+
+  constexpr void VisitMul(ast::MulType mul_type) override {
+    Emit(details::MapMulOpCode(mul_type));
+  }
+
+  constexpr void VisitNot() override { Emit(OpCode::NOT); }
+
+  constexpr void VisitVariableInvokation(lexer::Symbol symbol,
+                                         std::string_view name) override {
+    const auto slot = frame_layout_.Find(symbol);
+    if (!slot) {
+      throw WriterError{utils::format("Variable {} is not defined", name)};
+    }
+    EmitSlot(OpCode::INVOKE_VARIABLE, *slot);
+  }
+
+  constexpr void VisitConstantInvokation(ast::Constant&& constant) override {
+    // TODO: looks wierd, use another structures pls
+    auto value = std::visit([](auto&& value) { return Value{value}; },
+                            std::move(constant.value));
+    Emit(OpCode::INVOKE_CONSTANT, {constants_.Add(std::move(value))});
+  }
+
+  [[nodiscard]] constexpr const auto& GetCode() const noexcept {
+    return code_;
   }
 
+  // Finishes the code without the optimizations
+  [[nodiscard]] constexpr Bytecode TakeBytecode() {
+    Emit(OpCode::HALT);
+    return Bytecode{.code = std::move(code_),
+                    .constants = std::move(constants_),
+                    .frame_layout = std::move(frame_layout_)};
+  }
+
+  // pls do something better
+  [[nodiscard]] InstructionsBlock MakeBlock();
+  // The same code for the register machine
+  [[nodiscard]] RegisterBlock MakeRegisterBlock();
+  // The register code which runs many inputs at once
+  [[nodiscard]] BatchBlock MakeBatchBlock();
+  // The code as written, optimized in the background once it gets hot
+  [[nodiscard]] TieredBlock MakeTieredBlock(TieringOptions options = {});
+
  private:
-  std::vector<std::shared_ptr<Instruction>> instructions_;
-  std::stack<std::shared_ptr<JumpInstruction>> jump_stack_;
-  std::stack<std::vector<std::shared_ptr<JumpInstruction>>> loops_breaks_stack_;
-  std::stack<Label> loops_starts_stack_;
+  // Runs the optimization passes shared by the backends
+  [[nodiscard]] Bytecode MakeBytecode();
+
+  constexpr Label Emit(OpCode op_code,
+                       std::initializer_list<CodeUnit> operands = {}) {
+    const auto label = CurrentLabel();
+    code_.push_back(static_cast<CodeUnit>(op_code));
+    code_.insert(code_.end(), operands);
+    return label;
+  }
+
+  constexpr void SetJumpLabel(Label jump, Label label) {
+    code_[jump + 1] = static_cast<CodeUnit>(label);
+  }
+
+  [[nodiscard]] constexpr Label CurrentLabel() const noexcept {
+    return code_.size();
+  }
+
+  constexpr Label EmitSlot(OpCode op_code, Slot slot) {
+    return Emit(op_code, {static_cast<CodeUnit>(slot.type), slot.index});
+  }
+
+  // The breaks of the loop jump to its end
+  constexpr void EndLoop(Label loop_end_label) {
+    for (const auto break_jump : loops_breaks_stack_.back()) {
+      SetJumpLabel(break_jump, loop_end_label);
+    }
+    loops_breaks_stack_.pop_back();
+  }
+
+  std::vector<CodeUnit> code_;
+  ConstantPool constants_;
+  FrameLayout frame_layout_;
+
+  // labels of jump instructions, waiting for their destination
+  std::vector<Label> jump_stack_;
+  std::vector<std::vector<Label>> loops_breaks_stack_;
+  std::vector<Label> loops_starts_stack_;
+  CodeUnit loops_count_ = 0;
 };
 
 }  // namespace interpreter::instructions
@@ -1,16 +1,18 @@
 #pragma once
 
 #include <iosfwd>
-#include <string>
+#include <string_view>
 #include <variant>
 
 #include "types.hpp"
 
 namespace interpreter::lexer {
 
+// The names and the strings are the views of the source, it should outlive
+// the lexems
 struct Lexeme {
   LexType type;
-  std::variant<std::monostate, int, double, bool, std::string> data;
+  std::variant<std::monostate, int, double, bool, std::string_view> data;
 
   [[nodiscard]] inline constexpr bool operator==(
       const Lexeme& other) const noexcept = default;
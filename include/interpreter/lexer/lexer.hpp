@@ -12,7 +12,15 @@ struct LexicalError : public std::runtime_error {
   using std::runtime_error::runtime_error;
 };
 
-// TODO: make template<typename CharT> for non char strings
+class TokenBuffer;
+
+// Reads the input up to the end of the program, see Scanner for the source
+// in memory. The names and the strings refer to the buffer of the generator
+// and are valid until the next lexeme.
 utils::generator<Lexeme> ParseLexems(std::istream& input);
 
+// Reads the input up to the closing brace of the program, the rest stays in
+// the stream for the input of the program
+TokenBuffer Tokenize(std::istream& input);
+
 }  // namespace interpreter::lexer
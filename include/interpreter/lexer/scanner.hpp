@@ -0,0 +1,463 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "interpreter/utils/decimal.hpp"
+#include "interpreter/utils/format.hpp"
+#include "lexer.hpp"
+#include "simd.hpp"
+
+namespace interpreter::lexer {
+
+namespace details {
+
+inline constexpr std::array<std::pair<std::string_view, LexType>, 22> KEYWORDS =
+    {{
+        {"and", LexType::AND},
+        {"boolean", LexType::TYPE_BOOL},
+        {"break", LexType::BREAK},
+        {"case", LexType::CASE},
+        {"continue", LexType::CONTINUE},
+        {"do", LexType::DO},
+        {"else", LexType::ELSE},
+        {"end", LexType::END},
+        {"false", LexType::FALSE},
+        {"for", LexType::FOR},
+        {"if", LexType::IF},
+        {"int", LexType::TYPE_INT},
+        {"not", LexType::NOT},
+        {"of", LexType::OF},
+        {"or", LexType::OR},
+        {"program", LexType::PROGRAM},
+        {"read", LexType::READ},
+        {"real", LexType::TYPE_REAL},
+        {"string", LexType::TYPE_STR},
+        {"true", LexType::TRUE},
+        {"while", LexType::WHILE},
+        {"write", LexType::WRITE},
+    }};
+
+inline constexpr std::array<std::pair<std::string_view, LexType>, 4>
+    TWO_CHAR_OPERATORS = {{
+        {"!=", LexType::NE},
+        {"==", LexType::EQ},
+        {"<=", LexType::LE},
+        {">=", LexType::GE},
+    }};
+
+inline constexpr std::array<std::pair<char, LexType>, 14> SINGLE_CHAR = {{
+    {'=', LexType::ASSIGN},
+    {'<', LexType::LT},
+    {'>', LexType::GT},
+    {'/', LexType::DIV},
+    {'+', LexType::PLUS},
+    {'-', LexType::MINUS},
+    {'%', LexType::MOD},
+    {'*', LexType::MUL},
+    {';', LexType::SEMICOLON},
+    {',', LexType::COMMA},
+    {'{', LexType::OPENING_BRACE},
+    {'}', LexType::CLOSING_BRACE},
+    {'(', LexType::OPENING_PARENTHESIS},
+    {')', LexType::CLOSING_PARENTHESIS},
+}};
+
+inline constexpr std::array<std::pair<char, char>, 5> ESCAPE_CHARACTERS = {
+    {{'n', '\n'}, {'t', '\t'}, {'r', '\r'}, {'"', '\"'}, {'\\', '\\'}}};
+
+// The tables above are the sources of the tables below, which are generated
+// during the compilation: nothing is built at the start of the program and
+// nothing is searched for a lexeme
+
+[[nodiscard]] constexpr size_t Index(char ch) noexcept {
+  return static_cast<unsigned char>(ch);
+}
+
+// The type of the operator by its character, NONE if it's not an operator.
+// All the two character operators end with '='.
+inline constexpr auto SINGLE_CHAR_TYPES = [] {
+  std::array<LexType, 256> types{};
+  for (const auto& [ch, type] : SINGLE_CHAR) {
+    types[Index(ch)] = type;
+  }
+  return types;
+}();
+
+inline constexpr auto TWO_CHAR_TYPES = [] {
+  std::array<LexType, 256> types{};
+  for (const auto& [text, type] : TWO_CHAR_OPERATORS) {
+    types[Index(text[0])] = type;
+  }
+  return types;
+}();
+
+static_assert(std::all_of(TWO_CHAR_OPERATORS.begin(), TWO_CHAR_OPERATORS.end(),
+                          [](const auto& entry) {
+                            return entry.first.size() == 2 &&
+                                   entry.first[1] == '=';
+                          }));
+
+// The escaped characters by the characters after the backslash, zero for the
+// unknown sequences
+inline constexpr auto ESCAPES = [] {
+  std::array<char, 256> escapes{};
+  for (const auto& [ch, escaped] : ESCAPE_CHARACTERS) {
+    escapes[Index(ch)] = escaped;
+  }
+  return escapes;
+}();
+
+// The character classes of the C locale, std::isalpha and the others aren't
+// constexpr
+
+inline constexpr std::uint8_t CLASS_SPACE = 1 << 0;
+inline constexpr std::uint8_t CLASS_ALPHA = 1 << 1;
+inline constexpr std::uint8_t CLASS_DIGIT = 1 << 2;
+inline constexpr std::uint8_t CLASS_LITERAL = 1 << 3;
+
+inline constexpr auto CHAR_CLASSES = [] {
+  std::array<std::uint8_t, 256> classes{};
+  for (const auto ch : std::string_view{" \t\n\v\f\r"}) {
+    classes[Index(ch)] |= CLASS_SPACE;
+  }
+  for (char ch = 'a'; ch <= 'z'; ++ch) {
+    classes[Index(ch)] |= CLASS_ALPHA | CLASS_LITERAL;
+    classes[Index(ch - 'a' + 'A')] |= CLASS_ALPHA | CLASS_LITERAL;
+  }
+  for (char ch = '0'; ch <= '9'; ++ch) {
+    classes[Index(ch)] |= CLASS_DIGIT;
+  }
+  classes[Index('_')] |= CLASS_LITERAL;
+  return classes;
+}();
+
+[[nodiscard]] constexpr bool IsSpace(char ch) noexcept {
+  return CHAR_CLASSES[Index(ch)] & CLASS_SPACE;
+}
+
+[[nodiscard]] constexpr bool IsAlpha(char ch) noexcept {
+  return CHAR_CLASSES[Index(ch)] & CLASS_ALPHA;
+}
+
+[[nodiscard]] constexpr bool IsDigit(char ch) noexcept {
+  return CHAR_CLASSES[Index(ch)] & CLASS_DIGIT;
+}
+
+[[nodiscard]] constexpr bool IsLiteral(char ch) noexcept {
+  return CHAR_CLASSES[Index(ch)] & CLASS_LITERAL;
+}
+
+[[nodiscard]] constexpr bool IsStringStop(char ch) noexcept {
+  return ch == '"' || ch == '\\' || ch == '\n';
+}
+
+// The perfect hash of the keywords: the key of a word is its first, second
+// and last characters and its size, the multiplier is searched during the
+// compilation so that the keywords don't collide. A word is a keyword if it
+// is the one in its slot.
+
+inline constexpr size_t KEYWORD_HASH_BITS = 6;
+inline constexpr size_t MIN_KEYWORD_SIZE = 2;
+inline constexpr size_t MAX_KEYWORD_SIZE = 8;
+
+static_assert(std::all_of(KEYWORDS.begin(), KEYWORDS.end(),
+                          [](const auto& entry) {
+                            return MIN_KEYWORD_SIZE <= entry.first.size() &&
+                                   entry.first.size() <= MAX_KEYWORD_SIZE;
+                          }));
+
+[[nodiscard]] constexpr size_t HashKeyword(std::string_view word,
+                                           std::uint32_t multiplier) noexcept {
+  const auto key = static_cast<std::uint32_t>(
+      Index(word[0]) | Index(word[1]) << 8 | Index(word.back()) << 16 |
+      word.size() << 24);
+  return (key * multiplier) >> (32 - KEYWORD_HASH_BITS);
+}
+
+inline constexpr std::uint32_t KEYWORD_HASH_MULTIPLIER = [] {
+  // the odd multipliers from the golden ratio
+  for (std::uint32_t multiplier = 0x9E3779B1; multiplier != 1;
+       multiplier += 2) {
+    std::array<bool, 1 << KEYWORD_HASH_BITS> is_used{};
+    const auto collides = std::any_of(
+        KEYWORDS.begin(), KEYWORDS.end(), [&](const auto& entry) {
+          return std::exchange(is_used[HashKeyword(entry.first, multiplier)],
+                               true);
+        });
+    if (!collides) {
+      return multiplier;
+    }
+  }
+  return std::uint32_t{1};
+}();
+
+static_assert(KEYWORD_HASH_MULTIPLIER != 1, "The keywords collide");
+
+inline constexpr auto KEYWORD_SLOTS = [] {
+  std::array<std::pair<std::string_view, LexType>, 1 << KEYWORD_HASH_BITS>
+      slots;
+  slots.fill({std::string_view{}, LexType::NONE});
+  for (const auto& entry : KEYWORDS) {
+    slots[HashKeyword(entry.first, KEYWORD_HASH_MULTIPLIER)] = entry;
+  }
+  return slots;
+}();
+
+[[nodiscard]] constexpr std::optional<LexType> FindKeyword(
+    std::string_view word) noexcept {
+  if (word.size() < MIN_KEYWORD_SIZE || word.size() > MAX_KEYWORD_SIZE) {
+    return std::nullopt;
+  }
+  const auto& slot = KEYWORD_SLOTS[HashKeyword(word, KEYWORD_HASH_MULTIPLIER)];
+  if (slot.first != word) {
+    return std::nullopt;
+  }
+  return slot.second;
+}
+
+}  // namespace details
+
+// The lexer of the source in memory. The lexems of the names and the strings
+// are views of the source, nothing is copied. Works in the constant
+// evaluation, so the programs embedded in the C++ code are parsed during its
+// compilation.
+class Scanner {
+ public:
+  // The incomplete source is a part of the text which continues after it,
+  // the line is the one of the beginning of the source
+  explicit constexpr Scanner(std::string_view source, bool is_complete = true,
+                             size_t line = 1) noexcept
+      : source_{source}, is_complete_{is_complete}, line_{line} {}
+
+  // Returns the lexeme of the NONE type at the end of the source
+  constexpr Lexeme GetNext() {
+    SkipSpacesAndComments();
+    if (IsEnd()) {
+      return {};
+    }
+
+    const auto ch = Current();
+    if (details::IsAlpha(ch)) {
+      return ReadWord();
+    }
+    if (details::IsDigit(ch)) {
+      return ReadNumber();
+    }
+    if (ch == '"') {
+      return ReadString();
+    }
+    return ReadOperator();
+  }
+
+  // Returns std::nullopt if the source is incomplete and the lexeme may
+  // continue after its end, the scanning should start over with more text
+  constexpr std::optional<Lexeme> TryNext() {
+    auto lexeme = GetNext();
+    // the brackets are single characters
+    const auto is_bracket = LexType::OPENING_BRACE <= lexeme.type &&
+                            lexeme.type <= LexType::COMMA;
+    if (!is_complete_ && IsEnd() && !is_bracket) {
+      return std::nullopt;
+    }
+    return lexeme;
+  }
+
+  // The offset of the text after the last lexeme
+  [[nodiscard]] constexpr size_t GetPosition() const noexcept {
+    return position_;
+  }
+
+  // The line of the text after the last lexeme, from one
+  [[nodiscard]] constexpr size_t GetLine() const noexcept { return line_; }
+
+ private:
+  [[nodiscard]] constexpr bool IsEnd() const noexcept {
+    return position_ == source_.size();
+  }
+
+  [[nodiscard]] constexpr char Current() const noexcept {
+    return source_[position_];
+  }
+
+  [[nodiscard]] constexpr std::optional<char> Peek() const noexcept {
+    if (position_ + 1 < source_.size()) {
+      return source_[position_ + 1];
+    }
+    return std::nullopt;
+  }
+
+  constexpr void SkipSpacesAndComments() {
+    while (!IsEnd()) {
+      if (details::IsSpace(Current())) {
+        line_ += Current() == '\n';
+        // the lexems are mostly separated by a single space
+        if (++position_ < source_.size() && details::IsSpace(Current())) {
+          position_ = simd::SkipSpaces(source_, position_, line_);
+          for (; !IsEnd() && details::IsSpace(Current()); ++position_) {
+            line_ += Current() == '\n';
+          }
+        }
+      } else if (Current() == '/' && Peek() == '/') {
+        // the newline is skipped as a space
+        position_ = std::min(source_.find('\n', position_), source_.size());
+      } else if (Current() == '/' && Peek() == '*') {
+        // as in ParseLexems, the comment ends with the first slash after the
+        // first star, the unclosed comment ends with the source
+        const auto star = std::min(source_.find('*', position_ + 2),
+                                   source_.size());
+        const auto end =
+            std::min(source_.find('/', star), source_.size() - 1) + 1;
+        line_ +=
+            simd::CountNewlines(source_.substr(position_, end - position_));
+        position_ = end;
+      } else {
+        return;
+      }
+    }
+  }
+
+  constexpr Lexeme ReadWord() {
+    const auto start = position_;
+    while (!IsEnd() && details::IsLiteral(Current())) {
+      ++position_;
+    }
+
+    const auto word = source_.substr(start, position_ - start);
+    if (const auto keyword = details::FindKeyword(word)) {
+      return {*keyword};
+    }
+    return {LexType::ID, word};
+  }
+
+  constexpr Lexeme ReadNumber() {
+    const auto start = position_;
+    while (!IsEnd() && details::IsDigit(Current())) {
+      ++position_;
+    }
+
+    if (!IsEnd() && Current() == '.') {
+      ++position_;
+      while (!IsEnd() && details::IsDigit(Current())) {
+        ++position_;
+      }
+      const auto value =
+          utils::ParseReal(source_.substr(start, position_ - start));
+      if (!value) {
+        throw Error("Real constant is out of range");
+      }
+      return {LexType::VALUE_REAL, *value};
+    }
+
+    if (!IsEnd() && details::IsLiteral(Current())) {
+      throw Error("Unexpected symbol");
+    }
+
+    std::int64_t value = 0;
+    for (const auto ch : source_.substr(start, position_ - start)) {
+      value = value * 10 + (ch - '0');
+      if (value > std::numeric_limits<int>::max()) {
+        throw Error("Integer constant is out of range");
+      }
+    }
+    return {LexType::VALUE_INT, static_cast<int>(value)};
+  }
+
+  // The escape sequences are kept as written, see Unescape
+  constexpr Lexeme ReadString() {
+    const auto start = ++position_;
+    while (true) {
+      position_ = simd::SkipStringCharacters(source_, position_);
+      while (!IsEnd() && !details::IsStringStop(Current())) {
+        ++position_;
+      }
+      if (IsEnd()) {
+        break;
+      }
+
+      const auto ch = Current();
+      if (ch == '\n') {
+        throw Error("Unexpected end of line");
+      }
+      if (ch == '"') {
+        return {LexType::VALUE_STR,
+                source_.substr(start, position_++ - start)};
+      }
+      // the backslash and the escaped character
+      if (++position_ == source_.size()) {
+        break;
+      }
+      line_ += Current() == '\n';
+      ++position_;
+    }
+    if (!is_complete_) {
+      return {};
+    }
+    throw Error("Unexpected end of file");
+  }
+
+  constexpr Lexeme ReadOperator() {
+    const auto ch = Current();
+
+    if (const auto type = details::TWO_CHAR_TYPES[details::Index(ch)];
+        type != LexType::NONE && Peek() == '=') {
+      position_ += 2;
+      return {type};
+    }
+    if (const auto type = details::SINGLE_CHAR_TYPES[details::Index(ch)];
+        type != LexType::NONE) {
+      ++position_;
+      return {type};
+    }
+    if (ch == '!') {
+      throw Error(utils::format("Unexpected symbol '{}'", ch));
+    }
+    throw Error(utils::format("Unrecognized symbol '{}'", ch));
+  }
+
+  [[nodiscard]] LexicalError Error(const std::string& message) const {
+    return LexicalError{utils::format("{} at line {}", message, line_)};
+  }
+
+  std::string_view source_;
+  bool is_complete_;
+  size_t line_;
+  size_t position_ = 0;
+};
+
+// The value of the string lexeme with the escape sequences replaced, the
+// unknown ones give the escaped character
+[[nodiscard]] constexpr std::string Unescape(std::string_view text) {
+  std::string value;
+  for (size_t i = 0; i < text.size(); ++i) {
+    auto ch = text[i];
+    if (ch == '\\' && ++i < text.size()) {
+      ch = text[i];
+      if (const auto escaped = details::ESCAPES[details::Index(ch)]) {
+        ch = escaped;
+      }
+    }
+    value += ch;
+  }
+  return value;
+}
+
+// All the lexems of the source, the last one has the NONE type
+[[nodiscard]] constexpr std::vector<Lexeme> ScanLexems(
+    std::string_view source) {
+  Scanner scanner{source};
+  std::vector<Lexeme> lexems;
+  do {
+    lexems.push_back(scanner.GetNext());
+  } while (lexems.back().type != LexType::NONE);
+  return lexems;
+}
+
+}  // namespace interpreter::lexer
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace interpreter::lexer::simd {
+
+// The searches of the scanner over the blocks of the source, the mask of a
+// block has a bit per character. The blocks are 32 characters with AVX2 and
+// 16 with SSE2. Without them and in the constant evaluation nothing is
+// skipped, the scalar loops of the scanner do all the work.
+
+namespace details {
+
+#if defined(__AVX2__)
+
+inline constexpr size_t BLOCK_SIZE = 32;
+
+using Block = __m256i;
+
+[[nodiscard]] inline Block Load(const char* data) noexcept {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+[[nodiscard]] inline std::uint32_t Mask(Block block) noexcept {
+  return static_cast<std::uint32_t>(_mm256_movemask_epi8(block));
+}
+
+[[nodiscard]] inline Block Equal(Block block, char ch) noexcept {
+  return _mm256_cmpeq_epi8(block, _mm256_set1_epi8(ch));
+}
+
+// '\t' <= ch <= '\r' is (ch - '\t') <= 4 for the unsigned characters
+[[nodiscard]] inline Block Spaces(Block block) noexcept {
+  const auto shifted = _mm256_sub_epi8(block, _mm256_set1_epi8('\t'));
+  const auto is_control = _mm256_cmpeq_epi8(
+      _mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+  return _mm256_or_si256(is_control, Equal(block, ' '));
+}
+
+[[nodiscard]] inline Block Or(Block lhs, Block rhs) noexcept {
+  return _mm256_or_si256(lhs, rhs);
+}
+
+[[nodiscard]] inline Block Zero() noexcept { return _mm256_setzero_si256(); }
+
+[[nodiscard]] inline Block Subtract(Block lhs, Block rhs) noexcept {
+  return _mm256_sub_epi8(lhs, rhs);
+}
+
+[[nodiscard]] inline size_t SumBytes(Block block) noexcept {
+  const auto sums = _mm256_sad_epu8(block, Zero());
+  return _mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) +
+         _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3);
+}
+
+#define INTERPRETER_LEXER_SIMD
+
+#elif defined(__SSE2__)
+
+inline constexpr size_t BLOCK_SIZE = 16;
+
+using Block = __m128i;
+
+[[nodiscard]] inline Block Load(const char* data) noexcept {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+[[nodiscard]] inline std::uint32_t Mask(Block block) noexcept {
+  return static_cast<std::uint32_t>(_mm_movemask_epi8(block));
+}
+
+[[nodiscard]] inline Block Equal(Block block, char ch) noexcept {
+  return _mm_cmpeq_epi8(block, _mm_set1_epi8(ch));
+}
+
+// '\t' <= ch <= '\r' is (ch - '\t') <= 4 for the unsigned characters
+[[nodiscard]] inline Block Spaces(Block block) noexcept {
+  const auto shifted = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+  const auto is_control = _mm_cmpeq_epi8(
+      _mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+  return _mm_or_si128(is_control, Equal(block, ' '));
+}
+
+[[nodiscard]] inline Block Or(Block lhs, Block rhs) noexcept {
+  return _mm_or_si128(lhs, rhs);
+}
+
+[[nodiscard]] inline Block Zero() noexcept { return _mm_setzero_si128(); }
+
+[[nodiscard]] inline Block Subtract(Block lhs, Block rhs) noexcept {
+  return _mm_sub_epi8(lhs, rhs);
+}
+
+[[nodiscard]] inline size_t SumBytes(Block block) noexcept {
+  const auto sums = _mm_sad_epu8(block, Zero());
+  return _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+}
+
+#define INTERPRETER_LEXER_SIMD
+
+#endif
+
+#ifdef INTERPRETER_LEXER_SIMD
+
+inline constexpr std::uint32_t FULL_MASK =
+    BLOCK_SIZE == 32 ? ~std::uint32_t{0}
+                     : (std::uint32_t{1} << BLOCK_SIZE) - 1;
+
+// The bits of the characters before the one of the index
+[[nodiscard]] inline std::uint32_t Before(int index) noexcept {
+  return (std::uint32_t{1} << index) - 1;
+}
+
+#endif
+
+}  // namespace details
+
+[[nodiscard]] constexpr size_t CountNewlines(std::string_view text) noexcept {
+  size_t position = 0;
+  size_t newlines = 0;
+#ifdef INTERPRETER_LEXER_SIMD
+  if (!std::is_constant_evaluated()) {
+    // the matches are -1, their count per character is subtracted up to 255
+    // times before it's summed
+    constexpr size_t kMaxCounted = 255;
+    while (position + details::BLOCK_SIZE <= text.size()) {
+      auto counts = details::Zero();
+      for (size_t i = 0; i < kMaxCounted &&
+                         position + details::BLOCK_SIZE <= text.size();
+           ++i, position += details::BLOCK_SIZE) {
+        const auto block = details::Load(text.data() + position);
+        counts = details::Subtract(counts, details::Equal(block, '\n'));
+      }
+      newlines += details::SumBytes(counts);
+    }
+  }
+#endif
+  return newlines + std::count(text.begin() + position, text.end(), '\n');
+}
+
+// Skips the blocks of the spaces from the position, the newlines in them are
+// added to the lines. Stops at the first other character or at the tail which
+// is shorter than a block, the scanner goes on from there.
+[[nodiscard]] constexpr size_t SkipSpaces(std::string_view text,
+                                          size_t position,
+                                          size_t& lines) noexcept {
+#ifdef INTERPRETER_LEXER_SIMD
+  if (!std::is_constant_evaluated()) {
+    for (; position + details::BLOCK_SIZE <= text.size();
+         position += details::BLOCK_SIZE) {
+      const auto block = details::Load(text.data() + position);
+      const auto others = ~details::Mask(details::Spaces(block)) &
+                          details::FULL_MASK;
+      const auto newlines = details::Mask(details::Equal(block, '\n'));
+      if (others) {
+        const auto index = std::countr_zero(others);
+        lines += std::popcount(newlines & details::Before(index));
+        return position + index;
+      }
+      lines += std::popcount(newlines);
+    }
+  }
+#endif
+  return position;
+}
+
+// Skips the blocks of the string characters from the position. Stops at the
+// first quote, backslash or newline or at the tail which is shorter than a
+// block, the scanner goes on from there.
+[[nodiscard]] constexpr size_t SkipStringCharacters(std::string_view text,
+                                                    size_t position) noexcept {
+#ifdef INTERPRETER_LEXER_SIMD
+  if (!std::is_constant_evaluated()) {
+    for (; position + details::BLOCK_SIZE <= text.size();
+         position += details::BLOCK_SIZE) {
+      const auto block = details::Load(text.data() + position);
+      const auto stops = details::Mask(
+          details::Or(details::Or(details::Equal(block, '"'),
+                                  details::Equal(block, '\\')),
+                      details::Equal(block, '\n')));
+      if (stops) {
+        return position + std::countr_zero(stops);
+      }
+    }
+  }
+#endif
+  return position;
+}
+
+}  // namespace interpreter::lexer::simd
+
+#undef INTERPRETER_LEXER_SIMD
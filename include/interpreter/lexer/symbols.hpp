@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace interpreter::lexer {
+
+// The interned name, the symbols are given in the order of the first
+// appearance of the names from zero
+using Symbol = std::uint32_t;
+
+// Keeps every distinct name once, so the names are compared and hashed only
+// here and the others compare the symbols. Works in the constant evaluation.
+class SymbolTable {
+ public:
+  // Returns the symbol of the name, the new name gets the next symbol
+  constexpr Symbol Intern(std::string_view name) {
+    // the slots are at most half full
+    if (2 * (GetSize() + 1) > slots_.size()) {
+      Rehash(std::max(MIN_SLOTS, 2 * slots_.size()));
+    }
+
+    auto index = Hash(name) & (slots_.size() - 1);
+    for (; slots_[index] != EMPTY; index = (index + 1) & (slots_.size() - 1)) {
+      if (GetName(slots_[index]) == name) {
+        return slots_[index];
+      }
+    }
+
+    const auto symbol = static_cast<Symbol>(GetSize());
+    names_.append(name);
+    offsets_.push_back(names_.size());
+    slots_[index] = symbol;
+    return symbol;
+  }
+
+  // The view is valid until the next name is interned
+  [[nodiscard]] constexpr std::string_view GetName(Symbol symbol) const {
+    return std::string_view{names_}.substr(
+        offsets_[symbol], offsets_[symbol + 1] - offsets_[symbol]);
+  }
+
+  [[nodiscard]] constexpr size_t GetSize() const noexcept {
+    return offsets_.size() - 1;
+  }
+
+ private:
+  static constexpr Symbol EMPTY = std::numeric_limits<Symbol>::max();
+  static constexpr size_t MIN_SLOTS = 16;
+
+  // FNV-1a
+  [[nodiscard]] static constexpr size_t Hash(std::string_view name) noexcept {
+    std::uint32_t hash = 2166136261u;
+    for (const auto ch : name) {
+      hash = (hash ^ static_cast<unsigned char>(ch)) * 16777619u;
+    }
+    return hash;
+  }
+
+  // The size is a power of two
+  constexpr void Rehash(size_t size) {
+    slots_.assign(size, EMPTY);
+    for (Symbol symbol = 0; symbol < GetSize(); ++symbol) {
+      auto index = Hash(GetName(symbol)) & (size - 1);
+      while (slots_[index] != EMPTY) {
+        index = (index + 1) & (size - 1);
+      }
+      slots_[index] = symbol;
+    }
+  }
+
+  // the names one after another, the symbol is the index of the offset
+  std::string names_;
+  std::vector<size_t> offsets_ = {0};
+  std::vector<Symbol> slots_;
+};
+
+}  // namespace interpreter::lexer
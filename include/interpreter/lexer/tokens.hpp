@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "lexeme.hpp"
+#include "scanner.hpp"
+#include "symbols.hpp"
+
+namespace interpreter::lexer {
+
+// The lexems of a whole program by the fields, the parser walks them by the
+// indexes. Every lexeme has a type and an offset: the index of the value in
+// the pool of the numbers or the strings, or the symbol of the name. The
+// values are copied, so the buffer doesn't refer to the source.
+class TokenBuffer {
+ public:
+  // Takes the lexeme after the last one, the program is complete after the
+  // brace which closes the first one or at the end of the source. The last
+  // lexeme of the complete program has the NONE type.
+  constexpr void Push(const Lexeme& lexeme) {
+    std::uint32_t offset = 0;
+    // waiting for c++20 using enums
+    switch (lexeme.type) {
+      case LexType::NONE:
+        is_complete_ = true;
+        break;
+      case LexType::ID:
+        offset = symbols_.Intern(std::get<std::string_view>(lexeme.data));
+        break;
+      case LexType::VALUE_INT:
+        offset = static_cast<std::uint32_t>(ints_.size());
+        ints_.push_back(std::get<int>(lexeme.data));
+        break;
+      case LexType::VALUE_REAL:
+        offset = static_cast<std::uint32_t>(reals_.size());
+        reals_.push_back(std::get<double>(lexeme.data));
+        break;
+      case LexType::VALUE_STR:
+        offset = static_cast<std::uint32_t>(string_offsets_.size() - 1);
+        strings_.append(std::get<std::string_view>(lexeme.data));
+        string_offsets_.push_back(strings_.size());
+        break;
+      case LexType::OPENING_BRACE:
+        ++depth_;
+        break;
+      case LexType::CLOSING_BRACE:
+        is_complete_ = --depth_ <= 0;
+        break;
+      default:
+        break;
+    }
+
+    types_.push_back(lexeme.type);
+    offsets_.push_back(offset);
+    if (is_complete_ && lexeme.type != LexType::NONE) {
+      Push({});
+    }
+  }
+
+  [[nodiscard]] constexpr bool IsComplete() const noexcept {
+    return is_complete_;
+  }
+
+  [[nodiscard]] constexpr size_t GetSize() const noexcept {
+    return types_.size();
+  }
+
+  [[nodiscard]] constexpr LexType GetType(size_t index) const noexcept {
+    return types_[index];
+  }
+
+  [[nodiscard]] constexpr Symbol GetSymbol(size_t index) const noexcept {
+    return offsets_[index];
+  }
+
+  [[nodiscard]] constexpr int GetInt(size_t index) const noexcept {
+    return ints_[offsets_[index]];
+  }
+
+  [[nodiscard]] constexpr double GetReal(size_t index) const noexcept {
+    return reals_[offsets_[index]];
+  }
+
+  // The text between the quotes, the escapes are kept
+  [[nodiscard]] constexpr std::string_view GetString(
+      size_t index) const noexcept {
+    const auto offset = offsets_[index];
+    return std::string_view{strings_}.substr(
+        string_offsets_[offset],
+        string_offsets_[offset + 1] - string_offsets_[offset]);
+  }
+
+  [[nodiscard]] constexpr std::string_view GetName(
+      Symbol symbol) const noexcept {
+    return symbols_.GetName(symbol);
+  }
+
+  // The lexeme as the scanner gives it, the texts refer to the buffer
+  [[nodiscard]] constexpr Lexeme GetLexeme(size_t index) const {
+    // waiting for c++20 using enums
+    switch (GetType(index)) {
+      case LexType::ID:
+        return {LexType::ID, GetName(GetSymbol(index))};
+      case LexType::VALUE_INT:
+        return {LexType::VALUE_INT, GetInt(index)};
+      case LexType::VALUE_REAL:
+        return {LexType::VALUE_REAL, GetReal(index)};
+      case LexType::VALUE_STR:
+        return {LexType::VALUE_STR, GetString(index)};
+      default:
+        return {GetType(index)};
+    }
+  }
+
+ private:
+  std::vector<LexType> types_;
+  std::vector<std::uint32_t> offsets_;
+
+  std::vector<int> ints_;
+  std::vector<double> reals_;
+  // the strings one after another, as the names of SymbolTable
+  std::string strings_;
+  std::vector<size_t> string_offsets_ = {0};
+  SymbolTable symbols_;
+
+  int depth_ = 0;
+  bool is_complete_ = false;
+};
+
+// The lexems of the program at the beginning of the source, the text after
+// its closing brace isn't scanned
+[[nodiscard]] constexpr TokenBuffer Tokenize(std::string_view source) {
+  Scanner scanner{source};
+  TokenBuffer tokens;
+  while (!tokens.IsComplete()) {
+    tokens.Push(scanner.GetNext());
+  }
+  return tokens;
+}
+
+}  // namespace interpreter::lexer
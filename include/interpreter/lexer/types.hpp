@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
+
 namespace interpreter::lexer {
 
-enum class LexType {
+enum class LexType : std::uint8_t {
   NONE = 0,
   ID,
 
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "interpreter/ast/visitor.hpp"
+#include "interpreter/instructions/frame.hpp"
+
+namespace interpreter::transpiler {
+
+struct TranspileError : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+struct TypeError : public TranspileError {
+  using TranspileError::TranspileError;
+};
+
+// Translates the program to the standalone C++ source, which is built by the
+// system compiler. The generated code keeps the rules of the operations,
+// the zero division errors and the formatting of read and write. Throws
+// TypeError on the operations which are not defined for the operands.
+class CppTranspiler : public ast::ModelVisitor {
+ public:
+  void VisitProgram() override;
+  void VisitDeclarations() override;
+  void VisitVariableDeclaration(
+      ast::VariableType type, lexer::Symbol symbol, std::string_view name,
+      std::optional<ast::Constant>&& initial_value = std::nullopt) override;
+  void VisitOperators() override;
+  void VisitRead(lexer::Symbol symbol, std::string_view name) override;
+  void VisitWrite() override;
+  void VisitExpressionOperator() override;
+
+  void VisitIf() override;
+  void VisitElse() override;
+  void VisitEndIf() override;
+
+  void VisitWhile() override;
+  void VisitWhileBody() override;
+  void VisitEndWhile() override;
+
+  void VisitDoWhile() override;
+  void VisitDoWhileEnd() override;
+
+  void VisitBreak() override;
+  void VisitContinue() override;
+
+  // Expression States
+  void VisitAssign() override;
+  void VisitOrRightOperand() override;
+  void VisitOr() override;
+  void VisitAndRightOperand() override;
+  void VisitAnd() override;
+  void VisitCompare(ast::CompareType compare_type) override;
+  void VisitAdd(ast::AddType add_type) override;
+  void VisitMul(ast::MulType mul_type) override;
+  void VisitNot() override;
+  void VisitVariableInvokation(lexer::Symbol symbol,
+                               std::string_view name) override;
+  void VisitConstantInvokation(ast::Constant&& constant) override;
+
+  [[nodiscard]] std::string MakeSource() const;
+
+ private:
+  struct Expression {
+    ast::VariableType type;
+    std::string code;
+    // the variable is read by the operation which uses it, after the other
+    // operand is evaluated
+    bool is_variable = false;
+    // contains an assignment, so the order of the evaluation matters
+    bool has_effects = false;
+    bool is_assignment = false;
+  };
+
+  template <typename Op>
+  void TranspileBinary(std::string_view op);
+  template <typename Op>
+  void TranspileLogical(std::string_view op);
+
+  Expression PopExpression();
+  std::string PopCondition();
+  void AddLine(std::string_view line);
+
+  instructions::FrameLayout frame_layout_;
+  std::vector<std::string> declarations_;
+  std::vector<Expression> expressions_;
+  std::string body_;
+  // of the body lines, the body of main is the first level
+  size_t indent_ = 1;
+  size_t loops_depth_ = 0;
+};
+
+}  // namespace interpreter::transpiler
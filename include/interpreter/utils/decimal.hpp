@@ -0,0 +1,355 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Conversions between the decimal text and the reals which give the same
+// results as std::stod and the default formatting of std::ostream, but work
+// in the constant evaluation
+namespace interpreter::utils {
+
+namespace details {
+
+inline constexpr std::array<std::uint32_t, 10> POW10 = {
+    1,      10,      100,      1000,      10000,
+    100000, 1000000, 10000000, 100000000, 1000000000};
+
+// Doubles of the powers of ten which are exact
+inline constexpr std::array<double, 23> EXACT_POW10 = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Unsigned integer of any length, just the operations needed for the exact
+// conversions
+class BigInt {
+ public:
+  constexpr BigInt() = default;
+  explicit constexpr BigInt(std::uint64_t value) {
+    for (; value != 0; value >>= 32) {
+      limbs_.push_back(static_cast<std::uint32_t>(value));
+    }
+  }
+
+  [[nodiscard]] constexpr bool IsZero() const noexcept {
+    return limbs_.empty();
+  }
+
+  [[nodiscard]] constexpr int BitWidth() const noexcept {
+    if (limbs_.empty()) {
+      return 0;
+    }
+    return static_cast<int>(32 * (limbs_.size() - 1) +
+                            std::bit_width(limbs_.back()));
+  }
+
+  constexpr BigInt& MulAdd(std::uint32_t factor, std::uint32_t addend = 0) {
+    std::uint64_t carry = addend;
+    for (auto& limb : limbs_) {
+      const auto result = std::uint64_t{limb} * factor + carry;
+      limb = static_cast<std::uint32_t>(result);
+      carry = result >> 32;
+    }
+    if (carry != 0) {
+      limbs_.push_back(static_cast<std::uint32_t>(carry));
+    }
+    Trim();
+    return *this;
+  }
+
+  constexpr BigInt& MulPow10(int exponent) {
+    for (; exponent >= 9; exponent -= 9) {
+      MulAdd(POW10[9]);
+    }
+    return MulAdd(POW10[exponent]);
+  }
+
+  constexpr BigInt& ShiftLeft(int bits) {
+    if (IsZero() || bits == 0) {
+      return *this;
+    }
+
+    const auto shift = static_cast<std::uint32_t>(bits % 32);
+    if (shift != 0) {
+      std::uint32_t carry = 0;
+      for (auto& limb : limbs_) {
+        const auto shifted = (limb << shift) | carry;
+        carry = limb >> (32 - shift);
+        limb = shifted;
+      }
+      if (carry != 0) {
+        limbs_.push_back(carry);
+      }
+    }
+    limbs_.insert(limbs_.begin(), bits / 32, 0);
+    return *this;
+  }
+
+  // The subtrahend must not be greater
+  constexpr BigInt& operator-=(const BigInt& other) {
+    std::uint32_t borrow = 0;
+    for (size_t i = 0; i < limbs_.size(); ++i) {
+      const auto subtrahend =
+          std::uint64_t{i < other.limbs_.size() ? other.limbs_[i] : 0} +
+          borrow;
+      borrow = limbs_[i] < subtrahend;
+      limbs_[i] = static_cast<std::uint32_t>(limbs_[i] - subtrahend);
+    }
+    Trim();
+    return *this;
+  }
+
+  [[nodiscard]] friend constexpr std::strong_ordering operator<=>(
+      const BigInt& lhs, const BigInt& rhs) noexcept {
+    if (lhs.limbs_.size() != rhs.limbs_.size()) {
+      return lhs.limbs_.size() <=> rhs.limbs_.size();
+    }
+    for (auto i = lhs.limbs_.size(); i-- > 0;) {
+      if (lhs.limbs_[i] != rhs.limbs_[i]) {
+        return lhs.limbs_[i] <=> rhs.limbs_[i];
+      }
+    }
+    return std::strong_ordering::equal;
+  }
+
+  [[nodiscard]] friend constexpr bool operator==(const BigInt& lhs,
+                                                 const BigInt& rhs) = default;
+
+ private:
+  constexpr void Trim() {
+    while (!limbs_.empty() && limbs_.back() == 0) {
+      limbs_.pop_back();
+    }
+  }
+
+  std::vector<std::uint32_t> limbs_;
+};
+
+// The quotient must be less than 2^bits, the dividend is left with the
+// remainder
+constexpr std::uint64_t Divide(BigInt& dividend, const BigInt& divisor,
+                               int bits) {
+  std::uint64_t quotient = 0;
+  for (auto bit = bits; bit-- > 0;) {
+    auto shifted = divisor;
+    shifted.ShiftLeft(bit);
+    if (shifted <= dividend) {
+      dividend -= shifted;
+      quotient |= std::uint64_t{1} << bit;
+    }
+  }
+  return quotient;
+}
+
+// Rounds the quotient of the division to the nearest, ties to even
+constexpr std::uint64_t DivideRounded(BigInt dividend, const BigInt& divisor,
+                                      int bits) {
+  auto quotient = Divide(dividend, divisor, bits);
+  const auto order = dividend.ShiftLeft(1) <=> divisor;
+  if (order > 0 || (order == 0 && quotient % 2 == 1)) {
+    ++quotient;
+  }
+  return quotient;
+}
+
+// numerator / denominator * 2^exponent, both are scaled up to integers
+struct Fraction {
+  BigInt numerator;
+  BigInt denominator;
+};
+
+constexpr Fraction ScaleByPow2(Fraction fraction, int exponent) {
+  if (exponent > 0) {
+    fraction.numerator.ShiftLeft(exponent);
+  } else {
+    fraction.denominator.ShiftLeft(-exponent);
+  }
+  return fraction;
+}
+
+constexpr Fraction ScaleByPow10(Fraction fraction, int exponent) {
+  if (exponent > 0) {
+    fraction.numerator.MulPow10(exponent);
+  } else {
+    fraction.denominator.MulPow10(-exponent);
+  }
+  return fraction;
+}
+
+constexpr double MulPow2(double value, int exponent) {
+  for (; exponent > 0; --exponent) {
+    value *= 2;
+  }
+  for (; exponent < 0; ++exponent) {
+    value /= 2;
+  }
+  return value;
+}
+
+constexpr std::string FormatUnsigned(std::uint64_t value) {
+  std::string result;
+  do {
+    result.insert(result.begin(), static_cast<char>('0' + value % 10));
+    value /= 10;
+  } while (value != 0);
+  return result;
+}
+
+// Removes the trailing zeros of the fractional part and the point
+constexpr void StripFraction(std::string& digits) {
+  if (digits.find('.') == std::string::npos) {
+    return;
+  }
+  while (digits.back() == '0') {
+    digits.pop_back();
+  }
+  if (digits.back() == '.') {
+    digits.pop_back();
+  }
+}
+
+}  // namespace details
+
+// Parses digits[.digits], the result is rounded to the nearest like
+// std::stod does. Returns std::nullopt if the real is out of the range of
+// the normal doubles.
+[[nodiscard]] constexpr std::optional<double> ParseReal(std::string_view text) {
+  details::BigInt mantissa;
+  std::uint64_t small_mantissa = 0;
+  int digits_count = 0;
+  int fraction_digits = 0;
+  bool is_fraction = false;
+  for (const auto ch : text) {
+    if (ch == '.') {
+      is_fraction = true;
+      continue;
+    }
+    const auto digit = static_cast<std::uint32_t>(ch - '0');
+    mantissa.MulAdd(10, digit);
+    small_mantissa = small_mantissa * 10 + digit;
+    digits_count += !mantissa.IsZero();
+    fraction_digits += is_fraction;
+  }
+
+  if (mantissa.IsZero()) {
+    return 0.0;
+  }
+
+  // both the mantissa and the power of ten are exact, so the only rounding
+  // is the one of the division
+  if (digits_count <= 15 &&
+      fraction_digits < static_cast<int>(details::EXACT_POW10.size())) {
+    return static_cast<double>(small_mantissa) /
+           details::EXACT_POW10[fraction_digits];
+  }
+
+  const details::Fraction value =
+      details::ScaleByPow10({mantissa, details::BigInt{1}}, -fraction_digits);
+
+  // value = quotient * 2^exponent, where 2^52 <= quotient < 2^53
+  auto exponent = value.numerator.BitWidth() -
+                  value.denominator.BitWidth() - 53;
+  auto scaled = details::ScaleByPow2(value, -exponent);
+  if (auto limit = scaled.denominator;
+      limit.ShiftLeft(53) <= scaled.numerator) {
+    scaled = details::ScaleByPow2(value, -++exponent);
+  }
+
+  auto quotient =
+      details::DivideRounded(scaled.numerator, scaled.denominator, 53);
+  if (quotient == std::uint64_t{1} << 53) {
+    quotient /= 2;
+    ++exponent;
+  }
+
+  if (exponent < -1074 || exponent > 971) {
+    return std::nullopt;
+  }
+  return details::MulPow2(static_cast<double>(quotient), exponent);
+}
+
+[[nodiscard]] constexpr std::string FormatInt(std::int64_t value) {
+  if (value < 0) {
+    return '-' + details::FormatUnsigned(-static_cast<std::uint64_t>(value));
+  }
+  return details::FormatUnsigned(static_cast<std::uint64_t>(value));
+}
+
+// Formats the real as std::ostream with the default flags does, it's the %g
+// conversion of printf with six significant digits
+[[nodiscard]] constexpr std::string FormatReal(double value) {
+  constexpr int PRECISION = 6;
+
+  const auto bits = std::bit_cast<std::uint64_t>(value);
+  const std::string sign = bits >> 63 ? "-" : "";
+  const auto biased_exponent = static_cast<int>((bits >> 52) & 0x7ff);
+  auto mantissa = bits & ((std::uint64_t{1} << 52) - 1);
+
+  if (biased_exponent == 0x7ff) {
+    return sign + (mantissa == 0 ? "inf" : "nan");
+  }
+  if (biased_exponent == 0 && mantissa == 0) {
+    return sign + "0";
+  }
+
+  auto exponent = -1074;
+  if (biased_exponent != 0) {
+    mantissa |= std::uint64_t{1} << 52;
+    exponent = biased_exponent - 1075;
+  }
+
+  const auto exact = details::ScaleByPow2(
+      {details::BigInt{mantissa}, details::BigInt{1}}, exponent);
+
+  // 10^decimal_exponent <= value < 10^(decimal_exponent + 1), the estimate
+  // of floor(log10(2^k)) may be off by one
+  const auto binary_exponent =
+      static_cast<int>(std::bit_width(mantissa)) - 1 + exponent;
+  auto decimal_exponent = (binary_exponent * 78913) >> 18;
+  for (;;) {
+    if (const auto rest = details::ScaleByPow10(exact, -decimal_exponent);
+        rest.numerator < rest.denominator) {
+      --decimal_exponent;
+    } else if (const auto next =
+                   details::ScaleByPow10(exact, -(decimal_exponent + 1));
+               next.numerator >= next.denominator) {
+      ++decimal_exponent;
+    } else {
+      break;
+    }
+  }
+
+  const auto scaled =
+      details::ScaleByPow10(exact, PRECISION - 1 - decimal_exponent);
+  auto digits =
+      details::DivideRounded(scaled.numerator, scaled.denominator, 21);
+  if (digits == details::POW10[PRECISION]) {
+    digits /= 10;
+    ++decimal_exponent;
+  }
+
+  auto result = details::FormatUnsigned(digits);
+  if (-4 <= decimal_exponent && decimal_exponent < PRECISION) {
+    if (decimal_exponent >= 0) {
+      result.insert(decimal_exponent + 1, ".");
+    } else {
+      result.insert(0, "0." + std::string(-decimal_exponent - 1, '0'));
+    }
+    details::StripFraction(result);
+    return sign + result;
+  }
+
+  result.insert(1, ".");
+  details::StripFraction(result);
+  const auto exponent_digits = details::FormatUnsigned(
+      decimal_exponent < 0 ? -decimal_exponent : decimal_exponent);
+  return sign + result + (decimal_exponent < 0 ? "e-" : "e+") +
+         (exponent_digits.size() < 2 ? "0" : "") + exponent_digits;
+}
+
+}  // namespace interpreter::utils
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace interpreter::utils {
+
+// String which is the template argument, the string literals are converted to
+// it. Keeps the terminating zero.
+template <size_t N>
+struct FixedString {
+  constexpr FixedString() = default;
+  constexpr FixedString(const char (&string)[N]) noexcept {
+    std::copy_n(string, N, chars.begin());
+  }
+
+  [[nodiscard]] constexpr std::string_view View() const noexcept {
+    return {chars.data(), N - 1};
+  }
+
+  std::array<char, N> chars{};
+};
+
+}  // namespace interpreter::utils
@@ -19,6 +19,10 @@ std::string ToString(
   return value;
 }
 
+inline std::string ToString(std::string_view value) {
+  return std::string{value};
+}
+
 template <class Arg, class... Args>
 std::string format(std::string_view fmt, const Arg& arg, const Args&... args) {
   std::string result;
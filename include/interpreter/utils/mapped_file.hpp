@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace interpreter::utils {
+
+// Read only contents of a whole file. The regular files are mapped to the
+// memory where it's supported, so the source isn't copied, the others are
+// read to a buffer.
+class MappedFile {
+ public:
+  // Returns std::nullopt if the file can't be opened
+  [[nodiscard]] static std::optional<MappedFile> Open(const std::string& path);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  ~MappedFile();
+
+  [[nodiscard]] inline std::string_view View() const noexcept {
+    if (mapping_) {
+      return {static_cast<const char*>(mapping_), mapping_size_};
+    }
+    return buffer_;
+  }
+
+ private:
+  MappedFile() = default;
+
+  void Unmap() noexcept;
+
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  std::string buffer_;
+};
+
+}  // namespace interpreter::utils
@@ -0,0 +1,538 @@
+#include "interpreter/closures/compiler.hpp"
+
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+#include "interpreter/ast/types_helpers.hpp"
+#include "interpreter/instructions/operations.hpp"
+#include "interpreter/utils/format.hpp"
+
+namespace interpreter::closures {
+
+namespace {
+
+namespace op_type = instructions::op_type;
+using details::AnyOperand;
+using details::ClosureOperand;
+using details::ConstantOperand;
+using details::Operand;
+using details::VariableOperand;
+using instructions::OperationT;
+
+template <typename Op, typename... Types>
+using Rule = instructions::details::Rule<Op, Types...>;
+
+template <typename Op, typename... Types>
+inline constexpr bool kIsPerformable =
+    instructions::details::IsPerformableV<Op, Types...>;
+
+template <typename T>
+inline constexpr bool kIsVariable = false;
+
+template <ValueT T>
+inline constexpr bool kIsVariable<VariableOperand<T>> = true;
+
+template <typename T>
+inline constexpr bool kIsConstant = false;
+
+template <ValueT T>
+inline constexpr bool kIsConstant<ConstantOperand<T>> = true;
+
+Statement MakeBlock(std::vector<Statement>&& statements) {
+  if (statements.size() == 1) {
+    return std::move(statements.front());
+  }
+  return [statements = std::move(statements)](ExecutionContext& context) {
+    for (const auto& statement : statements) {
+      if (const auto flow = statement(context); flow != Flow::NEXT) {
+        return flow;
+      }
+    }
+    return Flow::NEXT;
+  };
+}
+
+// The variable on the left is a reference which is read after the right
+// operand is evaluated, the same way as the instructions do
+template <OperationT Op, ValueT L, ValueT R, typename LO, typename RO>
+struct BinaryClosure {
+  LO lhs;
+  RO rhs;
+
+  auto operator()(ExecutionContext& context) const {
+    if constexpr (kIsVariable<LO>) {
+      auto&& r = rhs(context);
+      return Rule<Op, L, R>{}(lhs(context), std::forward<decltype(r)>(r));
+    } else {
+      auto&& l = lhs(context);
+      auto&& r = rhs(context);
+      return Rule<Op, L, R>{}(std::forward<decltype(l)>(l),
+                              std::forward<decltype(r)>(r));
+    }
+  }
+};
+
+template <OperationT Op, ValueT L, ValueT R>
+auto MakeBinary(const Operand<L>& lhs, const Operand<R>& rhs) {
+  using Result = std::decay_t<decltype(Rule<Op, L, R>{}(L{}, R{}))>;
+
+  ClosureOperand<Result> result = std::visit(
+      []<typename LO, typename RO>(const LO& lo, const RO& ro) {
+        return ClosureOperand<Result>{
+            .evaluate = BinaryClosure<Op, L, R, LO, RO>{lo, ro}};
+      },
+      lhs, rhs);
+
+  // s + a + b is appended to s in place when assigned back to s
+  if constexpr (std::is_same_v<Op, op_type::Plus> &&
+                std::is_same_v<L, types::Str>) {
+    std::visit(
+        [&]<typename LO, typename RO>(const LO& lo, const RO& ro) {
+          if constexpr (kIsVariable<LO>) {
+            result.concatenated = lo.index;
+            result.append = [ro](ExecutionContext& context, types::Str& str) {
+              str += ro(context);
+            };
+          } else if constexpr (std::is_same_v<LO, ClosureOperand<L>> &&
+                               (kIsVariable<RO> || kIsConstant<RO>)) {
+            if constexpr (kIsVariable<RO>) {
+              // the variable may be the target, it's read before appending
+              if (ro.index == lo.concatenated) return;
+            }
+            if (!lo.concatenated) return;
+            result.concatenated = lo.concatenated;
+            result.append = [prefix = lo.append, ro](ExecutionContext& context,
+                                                     types::Str& str) {
+              prefix(context, str);
+              str += ro(context);
+            };
+          }
+        },
+        lhs, rhs);
+  }
+  return Operand<Result>{std::move(result)};
+}
+
+template <ValueT T>
+Expression<types::Bool> MakeCondition(Operand<T>&& operand) {
+  if constexpr (!std::is_same_v<T, types::Bool>) {
+    throw TypeError{"Condition must be boolean"};
+  } else {
+    return std::visit(
+        []<typename O>(O&& operand) -> Expression<types::Bool> {
+          if constexpr (std::is_same_v<O, ClosureOperand<T>>) {
+            return std::move(operand.evaluate);
+          } else {
+            return [operand](ExecutionContext& context) {
+              return operand(context);
+            };
+          }
+        },
+        std::move(operand));
+  }
+}
+
+}  // namespace
+
+ClosureProgram::ClosureProgram(instructions::FrameLayout frame_layout,
+                               Statement body)
+    : frame_layout_{std::move(frame_layout)}, body_{std::move(body)} {}
+
+void ClosureProgram::Execute(ExecutionContext& context) const {
+  ExecutionContext program_context{.input = context.input,
+                                   .output = context.output,
+                                   .frame = instructions::Frame{frame_layout_}};
+  body_(program_context);
+}
+
+void ClosureCompiler::VisitProgram() {}
+
+void ClosureCompiler::VisitDeclarations() {}
+
+void ClosureCompiler::VisitVariableDeclaration(
+    ast::VariableType type, lexer::Symbol symbol, std::string_view name,
+    std::optional<ast::Constant>&& initial_value) {
+  auto value = ast::VisitType(
+      [&]<typename T>(utils::TypeTag<T>) -> instructions::Value {
+        T variable{};
+        if (initial_value) {
+          // initialization follows the same rules as the assignment
+          std::visit(
+              [&]<typename V>(V&& initial) {
+                if constexpr (kIsPerformable<op_type::Assign, T&, V>) {
+                  Rule<op_type::Assign, T&, V>{}(variable, std::move(initial));
+                } else {
+                  throw CompileError{utils::format(
+                      "Incorrect initial value of variable {}", name)};
+                }
+              },
+              std::move(initial_value->value));
+        }
+        return variable;
+      },
+      type);
+
+  if (!frame_layout_.Declare(symbol, std::move(value))) {
+    throw CompileError{utils::format("Variable {} is already declared.", name)};
+  }
+}
+
+void ClosureCompiler::VisitOperators() {}
+
+void ClosureCompiler::VisitRead(lexer::Symbol symbol,
+                                std::string_view name) {
+  const auto slot = frame_layout_.Find(symbol);
+  if (!slot) {
+    throw CompileError{utils::format(
+        "Failed to read variable '{}', it is not declared.", name)};
+  }
+  AddStatement(ast::VisitType(
+      [index = slot->index]<typename T>(utils::TypeTag<T>) -> Statement {
+        return [index](ExecutionContext& context) {
+          context.input >> context.frame.Get<T>(index);
+          return Flow::NEXT;
+        };
+      },
+      slot->type));
+}
+
+void ClosureCompiler::VisitWrite() {
+  AddStatement(std::visit(
+      [](auto&& typed) {
+        return std::visit(
+            [](auto&& operand) -> Statement {
+              return [operand](ExecutionContext& context) {
+                context.output << operand(context);
+                return Flow::NEXT;
+              };
+            },
+            std::move(typed));
+      },
+      PopOperand()));
+}
+
+void ClosureCompiler::VisitExpressionOperator() {
+  std::visit(
+      [this](auto&& typed) {
+        std::visit(
+            [this]<typename O>(O&& operand) {
+              if constexpr (!kIsVariable<O> && !kIsConstant<O>) {
+                if (!operand.execute) {
+                  operand.execute = [evaluate = std::move(operand.evaluate)](
+                                        ExecutionContext& context) {
+                    evaluate(context);
+                  };
+                }
+                AddStatement([execute = std::move(operand.execute)](
+                                 ExecutionContext& context) {
+                  execute(context);
+                  return Flow::NEXT;
+                });
+              }
+            },
+            std::move(typed));
+      },
+      PopOperand());
+}
+
+void ClosureCompiler::VisitIf() {
+  blocks_.push_back(Block{.condition = PopCondition()});
+}
+
+void ClosureCompiler::VisitElse() {
+  auto& block = blocks_.back();
+  block.then_branch = MakeBlock(std::move(block.statements));
+  block.statements.clear();
+}
+
+void ClosureCompiler::VisitEndIf() {
+  auto block = std::move(blocks_.back());
+  blocks_.pop_back();
+
+  auto branch = MakeBlock(std::move(block.statements));
+  if (!block.then_branch) {
+    AddStatement([condition = std::move(block.condition),
+                  then_branch = std::move(branch)](ExecutionContext& context) {
+      return condition(context) ? then_branch(context) : Flow::NEXT;
+    });
+  } else {
+    AddStatement([condition = std::move(block.condition),
+                  then_branch = std::move(*block.then_branch),
+                  else_branch = std::move(branch)](ExecutionContext& context) {
+      return condition(context) ? then_branch(context) : else_branch(context);
+    });
+  }
+}
+
+void ClosureCompiler::VisitWhile() {}
+
+void ClosureCompiler::VisitWhileBody() {
+  blocks_.push_back(Block{.condition = PopCondition()});
+  ++loops_depth_;
+}
+
+void ClosureCompiler::VisitEndWhile() {
+  auto block = std::move(blocks_.back());
+  blocks_.pop_back();
+  --loops_depth_;
+
+  AddStatement([condition = std::move(block.condition),
+                body = MakeBlock(std::move(block.statements))](
+                   ExecutionContext& context) {
+    while (condition(context)) {
+      if (body(context) == Flow::BREAK) break;
+    }
+    return Flow::NEXT;
+  });
+}
+
+void ClosureCompiler::VisitDoWhile() {
+  blocks_.emplace_back();
+  ++loops_depth_;
+}
+
+void ClosureCompiler::VisitDoWhileEnd() {
+  auto condition = PopCondition();
+  auto block = std::move(blocks_.back());
+  blocks_.pop_back();
+  --loops_depth_;
+
+  // continue jumps to the beginning of the body, not to the condition
+  AddStatement([condition = std::move(condition),
+                body = MakeBlock(std::move(block.statements))](
+                   ExecutionContext& context) {
+    for (;;) {
+      const auto flow = body(context);
+      if (flow == Flow::BREAK) break;
+      if (flow == Flow::NEXT && !condition(context)) break;
+    }
+    return Flow::NEXT;
+  });
+}
+
+void ClosureCompiler::VisitBreak() {
+  if (loops_depth_ == 0) {
+    throw CompileError{"break instruction outside the loop"};
+  }
+  AddStatement([](ExecutionContext&) { return Flow::BREAK; });
+}
+
+void ClosureCompiler::VisitContinue() {
+  if (loops_depth_ == 0) {
+    throw CompileError{"continue instruction outside the loop"};
+  }
+  AddStatement([](ExecutionContext&) { return Flow::CONTINUE; });
+}
+
+void ClosureCompiler::VisitAssign() {
+  auto rhs = PopOperand();
+  auto lhs = PopOperand();
+
+  operands_.push_back(std::visit(
+      []<ValueT L, ValueT R>(Operand<L>& target,
+                             Operand<R>& value) -> AnyOperand {
+        const auto* variable = std::get_if<VariableOperand<L>>(&target);
+        if (!variable) {
+          throw TypeError{"Only variable can be assigned"};
+        }
+        if constexpr (!kIsPerformable<op_type::Assign, L&, R>) {
+          throw TypeError{"Incompatible types of assignment"};
+        } else {
+          const auto index = variable->index;
+          ClosureOperand<L> result;
+
+          if constexpr (std::is_same_v<L, types::Str> &&
+                        std::is_same_v<R, types::Str>) {
+            const auto* concatenation = std::get_if<ClosureOperand<R>>(&value);
+            if (concatenation && concatenation->concatenated == index) {
+              result.execute = [index, append = concatenation->append](
+                                   ExecutionContext& context) {
+                append(context, context.frame.Get<types::Str>(index));
+              };
+            }
+          }
+          if (!result.execute) {
+            result.execute = std::visit(
+                [index](auto&& operand) -> Action {
+                  return [index, operand](ExecutionContext& context) {
+                    auto&& value = operand(context);
+                    Rule<op_type::Assign, L&, R>{}(
+                        context.frame.Get<L>(index),
+                        std::forward<decltype(value)>(value));
+                  };
+                },
+                std::move(value));
+          }
+          result.evaluate = [index, execute = result.execute](
+                                ExecutionContext& context) -> L {
+            execute(context);
+            return context.frame.Get<L>(index);
+          };
+          return Operand<L>{std::move(result)};
+        }
+      },
+      lhs, rhs));
+}
+
+void ClosureCompiler::VisitOrRightOperand() {}
+
+void ClosureCompiler::VisitOr() { CompileLogical<op_type::Or>(); }
+
+void ClosureCompiler::VisitAndRightOperand() {}
+
+void ClosureCompiler::VisitAnd() { CompileLogical<op_type::And>(); }
+
+void ClosureCompiler::VisitCompare(ast::CompareType compare_type) {
+  using Compare = ast::CompareType;
+  // waiting for c++20 using enums
+  switch (compare_type) {
+    case Compare::EQ:
+      return CompileBinary<op_type::Equals>();
+    case Compare::NE:
+      return CompileBinary<op_type::NotEquals>();
+    case Compare::LT:
+      return CompileBinary<op_type::Less>();
+    case Compare::GT:
+      return CompileBinary<op_type::Greater>();
+    case Compare::LE:
+      return CompileBinary<op_type::LessOrEq>();
+    case Compare::GE:
+      return CompileBinary<op_type::GreaterOrEq>();
+  }
+  throw CompileError{"Unknown compare operation"};
+}
+
+void ClosureCompiler::VisitAdd(ast::AddType add_type) {
+  // waiting for c++20 using enums
+  switch (add_type) {
+    case ast::AddType::PLUS:
+      return CompileBinary<op_type::Plus>();
+    case ast::AddType::MINUS:
+      return CompileBinary<op_type::Minus>();
+  }
+  throw CompileError{"Unknown add operation"};
+}
+
+void ClosureCompiler::VisitMul(ast::MulType mul_type) {
+  // waiting for c++20 using enums
+  switch (mul_type) {
+    case ast::MulType::MUL:
+      return CompileBinary<op_type::Mul>();
+    case ast::MulType::DIV:
+      return CompileBinary<op_type::Div>();
+    case ast::MulType::MOD:
+      return CompileBinary<op_type::Mod>();
+  }
+  throw CompileError{"Unknown mul operation"};
+}
+
+void ClosureCompiler::VisitNot() { CompileUnary<op_type::Not>(); }
+
+void ClosureCompiler::VisitVariableInvokation(lexer::Symbol symbol,
+                                             std::string_view name) {
+  const auto slot = frame_layout_.Find(symbol);
+  if (!slot) {
+    throw CompileError{utils::format("Variable {} is not defined", name)};
+  }
+  operands_.push_back(ast::VisitType(
+      [index = slot->index]<typename T>(utils::TypeTag<T>) -> AnyOperand {
+        return Operand<T>{VariableOperand<T>{index}};
+      },
+      slot->type));
+}
+
+void ClosureCompiler::VisitConstantInvokation(ast::Constant&& constant) {
+  operands_.push_back(std::visit(
+      []<typename T>(T&& value) -> AnyOperand {
+        return Operand<T>{ConstantOperand<T>{std::move(value)}};
+      },
+      std::move(constant.value)));
+}
+
+ClosureProgram ClosureCompiler::MakeProgram() {
+  return ClosureProgram{std::move(frame_layout_),
+                        MakeBlock(std::move(blocks_.front().statements))};
+}
+
+template <typename Op>
+void ClosureCompiler::CompileBinary() {
+  auto rhs = PopOperand();
+  auto lhs = PopOperand();
+  operands_.push_back(std::visit(
+      []<ValueT L, ValueT R>(const Operand<L>& lhs,
+                             const Operand<R>& rhs) -> AnyOperand {
+        if constexpr (kIsPerformable<Op, L, R>) {
+          return MakeBinary<Op, L, R>(lhs, rhs);
+        } else {
+          throw TypeError{"Operation is not defined for the operands"};
+        }
+      },
+      lhs, rhs));
+}
+
+template <typename Op>
+void ClosureCompiler::CompileUnary() {
+  operands_.push_back(std::visit(
+      []<ValueT T>(Operand<T>&& operand) -> AnyOperand {
+        if constexpr (kIsPerformable<Op, T>) {
+          using Result = std::decay_t<decltype(Rule<Op, T>{}(T{}))>;
+          return Operand<Result>{std::visit(
+              [](auto&& operand) {
+                return ClosureOperand<Result>{
+                    .evaluate = [operand](ExecutionContext& context) {
+                      return Rule<Op, T>{}(operand(context));
+                    }};
+              },
+              std::move(operand))};
+        } else {
+          throw TypeError{"Operation is not defined for the operand"};
+        }
+      },
+      PopOperand()));
+}
+
+// The right operand is evaluated only when it decides the result
+template <typename Op>
+void ClosureCompiler::CompileLogical() {
+  auto rhs = PopOperand();
+  auto lhs = PopOperand();
+  auto right = std::visit(
+      [](auto&& operand) { return MakeCondition(std::move(operand)); },
+      std::move(rhs));
+  auto left = std::visit(
+      [](auto&& operand) { return MakeCondition(std::move(operand)); },
+      std::move(lhs));
+
+  ClosureOperand<types::Bool> result;
+  if constexpr (std::is_same_v<Op, op_type::And>) {
+    result.evaluate = [left = std::move(left), right = std::move(right)](
+                          ExecutionContext& context) {
+      return left(context) && right(context);
+    };
+  } else {
+    result.evaluate = [left = std::move(left), right = std::move(right)](
+                          ExecutionContext& context) {
+      return left(context) || right(context);
+    };
+  }
+  operands_.push_back(Operand<types::Bool>{std::move(result)});
+}
+
+AnyOperand ClosureCompiler::PopOperand() {
+  auto operand = std::move(operands_.back());
+  operands_.pop_back();
+  return operand;
+}
+
+Expression<types::Bool> ClosureCompiler::PopCondition() {
+  return std::visit(
+      [](auto&& operand) { return MakeCondition(std::move(operand)); },
+      PopOperand());
+}
+
+void ClosureCompiler::AddStatement(Statement statement) {
+  blocks_.back().statements.push_back(std::move(statement));
+}
+
+}  // namespace interpreter::closures
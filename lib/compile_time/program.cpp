@@ -0,0 +1,27 @@
+#include "interpreter/compile_time/program.hpp"
+
+#include "interpreter/instructions/passes.hpp"
+
+namespace interpreter::compile_time {
+
+instructions::InstructionsBlock MakeBlock(const ProgramView& program) {
+  instructions::Bytecode bytecode{
+      .code = {program.code.begin(), program.code.end()}};
+
+  // the pool and the layout give the same indexes the code refers to
+  for (const auto& constant : program.constants) {
+    bytecode.constants.Add(ToValue(constant, program.chars));
+  }
+  // the symbols of the reader are gone, the variables are distinct anyway
+  for (size_t i = 0; i < program.variables.size(); ++i) {
+    bytecode.frame_layout.Declare(static_cast<lexer::Symbol>(i),
+                                  ToValue(program.variables[i], program.chars));
+  }
+
+  instructions::OptimizeBytecode(bytecode);
+  instructions::StripLoopHeaders(bytecode);
+  instructions::FuseInstructions(bytecode);
+  return instructions::InstructionsBlock{std::move(bytecode)};
+}
+
+}  // namespace interpreter::compile_time
@@ -0,0 +1,61 @@
+#include "interpreter/instructions/analysis.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "interpreter/utils/format.hpp"
+
+namespace interpreter::instructions {
+
+size_t ComputeMaxStackDepth(std::span<const CodeUnit> code) {
+  std::vector<std::optional<size_t>> depths(code.size());
+  std::vector<Label> labels_to_visit;
+  size_t max_depth = 0;
+
+  const auto visit = [&](Label label, size_t depth) {
+    if (label >= code.size()) {
+      throw AnalysisError{
+          utils::format("Jump outside of the code to {}", label)};
+    }
+    if (!depths[label]) {
+      depths[label] = depth;
+      labels_to_visit.push_back(label);
+    } else if (*depths[label] != depth) {
+      throw AnalysisError{
+          utils::format("Inconsistent stack depth at {}", label)};
+    }
+  };
+
+  if (!code.empty()) {
+    visit(0, 0);
+  }
+
+  while (!labels_to_visit.empty()) {
+    const auto label = labels_to_visit.back();
+    labels_to_visit.pop_back();
+
+    const auto op_code = static_cast<OpCode>(code[label]);
+    const auto info = GetOpCodeInfo(op_code);
+    auto depth = *depths[label];
+    if (depth < info.pops) {
+      throw AnalysisError{
+          utils::format("Not enough operands for {} at {}",
+                      std::string{info.name}, label)};
+    }
+    depth = depth - info.pops + info.pushes;
+    max_depth = std::max(max_depth, depth);
+
+    if (info.is_jump) {
+      visit(code[label + 1], info.keeps_operand_on_jump ? depth + 1 : depth);
+    }
+    if (info.falls_through) {
+      visit(label + GetInstructionSize(op_code), depth);
+    }
+  }
+
+  return max_depth;
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,591 @@
+#include "interpreter/instructions/batch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+
+#include "interpreter/instructions/analysis.hpp"
+#include "interpreter/instructions/operations.hpp"
+#include "interpreter/instructions/specialization.hpp"
+#include "interpreter/utils/format.hpp"
+
+namespace interpreter::instructions {
+
+namespace {
+
+using ast::VariableType;
+
+constexpr size_t LANES = BatchBlock::LANES;
+
+template <typename T>
+using Lanes = std::array<T, LANES>;
+
+// The lanes which execute the instruction
+using Mask = Lanes<bool>;
+
+template <typename T>
+inline constexpr VariableType TYPE_OF = ast::EnumByType<T>::value;
+
+template <OperationT Op, ValueT... Operands>
+using ResultOf = std::decay_t<decltype(details::Rule<Op, Operands...>{}(
+    std::declval<const Operands&>()...))>;
+
+// The operation is done for all the lanes and the results of the inactive
+// ones are dropped, so the loops have no branches and become the vector
+// instructions. The division is done only for the active lanes, the divisor
+// of an inactive one may be zero. The strings are copied only if needed.
+template <OperationT Op, ValueT... Types>
+inline constexpr bool IS_VECTORIZED =
+    !std::is_same_v<Op, op_type::Div> && !std::is_same_v<Op, op_type::Mod> &&
+    (!std::is_same_v<Types, types::Str> && ...);
+
+// The type of the value written by the instruction, std::nullopt if it
+// writes nothing
+std::optional<VariableType> GetResultType(RegisterOpCode op_code,
+                                          const RegisterTypes& state,
+                                          const CodeUnit* operands) {
+  // waiting for c++20 using enums
+  switch (op_code) {
+    case RegisterOpCode::MOVE:
+      return state[operands[1]];
+    case RegisterOpCode::APPEND_STR:
+      return VariableType::STR;
+
+#define CASE_READ(name, type)      \
+  case RegisterOpCode::READ_##name: \
+    return TYPE_OF<types::type>;
+#define CASE_BINARY(name, generic_name, op, lhs, rhs) \
+  case RegisterOpCode::name:                          \
+    return TYPE_OF<ResultOf<op_type::op, types::lhs, types::rhs>>;
+#define CASE_UNARY(name, generic_name, op, type) \
+  case RegisterOpCode::name:                     \
+    return TYPE_OF<ResultOf<op_type::op, types::type>>;
+#define CASE_ASSIGN(name, lhs, rhs)      \
+  case RegisterOpCode::ASSIGN_##name:    \
+    return TYPE_OF<types::lhs>;
+
+      INTERPRETER_VALUE_TYPES(CASE_READ)
+      INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(CASE_BINARY)
+      INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(CASE_UNARY)
+      INTERPRETER_SPECIALIZED_ASSIGNMENTS(CASE_ASSIGN)
+
+#undef CASE_READ
+#undef CASE_BINARY
+#undef CASE_UNARY
+#undef CASE_ASSIGN
+
+    default:
+      return std::nullopt;
+  }
+}
+
+// The instructions are typed except MOVE, it copies the bank of the type its
+// source has there. The types of the variables and the constants never
+// change, the temporaries get the type of the last instruction which wrote
+// them on every path.
+std::vector<RegisterTypes> InferRegisterTypes(const RegisterBlock& block) {
+  const auto& code = block.GetCode();
+
+  std::vector<RegisterTypes> types(code.size());
+  std::vector<bool> is_visited(code.size());
+  std::vector<Label> worklist;
+
+  const auto merge = [&](Label label, const RegisterTypes& state) {
+    if (!is_visited[label]) {
+      is_visited[label] = true;
+      types[label] = state;
+      worklist.push_back(label);
+      return;
+    }
+    bool is_changed = false;
+    for (size_t reg = 0; reg < state.size(); ++reg) {
+      if (types[label][reg] && types[label][reg] != state[reg]) {
+        types[label][reg] = std::nullopt;
+        is_changed = true;
+      }
+    }
+    if (is_changed) {
+      worklist.push_back(label);
+    }
+  };
+
+  RegisterTypes initial;
+  for (const auto& cell : block.GetInitialRegisters()) {
+    initial.push_back(GetValueType(cell.ToValue()));
+  }
+  merge(0, initial);
+
+  while (!worklist.empty()) {
+    const auto label = worklist.back();
+    worklist.pop_back();
+
+    auto state = types[label];
+    const auto op_code = static_cast<RegisterOpCode>(code[label]);
+    const CodeUnit* const operands = code.data() + label + 1;
+    const auto info = GetRegisterOpCodeInfo(op_code);
+
+    if (op_code == RegisterOpCode::MOVE && !state[operands[1]]) {
+      throw AnalysisError{utils::format(
+          "Type of the register {} is not known at {}", operands[1], label)};
+    }
+    if (info.has_destination) {
+      state[operands[0]] = GetResultType(op_code, state, operands);
+    }
+
+    if (info.is_jump) {
+      merge(operands[0], state);
+    }
+    if (op_code != RegisterOpCode::HALT && op_code != RegisterOpCode::GOTO) {
+      merge(label + GetRegisterInstructionSize(op_code), state);
+    }
+  }
+  return types;
+}
+
+// Values of the registers per lane. Every type has its own bank with the
+// lanes of all the registers, a typed instruction touches only its banks.
+class LaneRegisters {
+ public:
+  explicit LaneRegisters(const std::vector<Cell>& initial)
+      : banks_{Bank<types::Bool>(initial.size()),
+               Bank<types::Int>(initial.size()),
+               Bank<types::Real>(initial.size()),
+               Bank<types::Str>(initial.size())} {
+    for (const auto& cell : initial) {
+      initial_values_.push_back(cell.ToValue());
+    }
+  }
+
+  // Only the bank of the initial type is set, the others are never read
+  // before they are written
+  void ResetLane(size_t lane) {
+    for (size_t reg = 0; reg < initial_values_.size(); ++reg) {
+      std::visit(
+          [this, reg, lane](const auto& value) {
+            using T = std::decay_t<decltype(value)>;
+            Get<T>(static_cast<Register>(reg))[lane] = value;
+          },
+          initial_values_[reg]);
+    }
+  }
+
+  template <ValueT T>
+  [[nodiscard]] inline Lanes<T>& Get(Register reg) noexcept {
+    return std::get<Bank<T>>(banks_)[reg];
+  }
+
+  [[nodiscard]] Cell MakeCell(VariableType type, Register reg,
+                              size_t lane) {
+    // waiting for c++20 using enums
+    switch (type) {
+      case VariableType::INT:
+        return Cell{Get<types::Int>(reg)[lane]};
+      case VariableType::REAL:
+        return Cell{Get<types::Real>(reg)[lane]};
+      case VariableType::BOOL:
+        return Cell{Get<types::Bool>(reg)[lane]};
+      case VariableType::STR:
+        return Cell{std::move(Get<types::Str>(reg)[lane])};
+      case VariableType::_END:
+        break;
+    }
+    return Cell{};
+  }
+
+ private:
+  template <ValueT T>
+  using Bank = std::vector<Lanes<T>>;
+
+  std::tuple<Bank<types::Bool>, Bank<types::Int>, Bank<types::Real>,
+             Bank<types::Str>>
+      banks_;
+  std::vector<Value> initial_values_;
+};
+
+// Runs the batch in LANES lanes, a lane which halts takes the next run. The
+// lanes at the same label make a group, the largest group is active and the
+// others wait at their labels. The active lanes stop at the label where
+// others wait, so the lanes which left a loop earlier join the rest after
+// it, and the new runs join the old ones.
+class BatchRunner {
+ public:
+  BatchRunner(const RegisterBlock& block,
+              const std::vector<RegisterTypes>& types,
+              std::span<ExecutionContext> contexts,
+              std::optional<JitOptions> jit)
+      : block_{block},
+        types_{types},
+        registers_{block.GetInitialRegisters()},
+        contexts_{contexts},
+        jit_{jit},
+        waiting_at_(block.GetCode().size()) {
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      Start(lane);
+    }
+  }
+
+  void Run() {
+    while (Schedule()) {
+      RunActive();
+    }
+  }
+
+ private:
+  // Starts the next run in the lane if there is any
+  void Start(size_t lane) {
+    live_[lane] = next_run_ < contexts_.size();
+    if (live_[lane]) {
+      runs_[lane] = next_run_++;
+      registers_.ResetLane(lane);
+      pcs_[lane] = 0;
+    }
+  }
+
+  // Returns false when all the lanes are done
+  bool Schedule() {
+    const auto live_count = std::count(live_.begin(), live_.end(), true);
+    if (live_count == 0) {
+      return false;
+    }
+    if (live_count == 1) {
+      RunScalar(std::find(live_.begin(), live_.end(), true) - live_.begin());
+      return false;
+    }
+
+    // the largest group runs, the least label on ties
+    size_t group_size = 0;
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      if (!live_[lane]) {
+        continue;
+      }
+      size_t size = 0;
+      for (size_t other = 0; other < LANES; ++other) {
+        size += live_[other] && pcs_[other] == pcs_[lane];
+      }
+      if (size > group_size || (size == group_size && pcs_[lane] < pc_)) {
+        group_size = size;
+        pc_ = pcs_[lane];
+      }
+    }
+
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      if (waiting_[lane]) {
+        --waiting_at_[pcs_[lane]];
+      }
+      active_[lane] = live_[lane] && pcs_[lane] == pc_;
+      waiting_[lane] = live_[lane] && !active_[lane];
+      if (waiting_[lane]) {
+        ++waiting_at_[pcs_[lane]];
+      }
+    }
+    return true;
+  }
+
+  // Runs the active lanes until they halt, split or reach a waiting lane
+  void RunActive() {
+    const CodeUnit* const code = block_.GetCode().data();
+
+    for (;;) {
+      const auto label = pc_;
+      const auto op_code = static_cast<RegisterOpCode>(code[label]);
+      const CodeUnit* const operands = code + label + 1;
+      pc_ += GetRegisterInstructionSize(op_code);
+
+      // waiting for c++20 using enums
+      switch (op_code) {
+        case RegisterOpCode::HALT:
+          for (size_t lane = 0; lane < LANES; ++lane) {
+            if (active_[lane]) {
+              Start(lane);
+            }
+          }
+          return;
+        case RegisterOpCode::MOVE:
+          Move(*types_[label][operands[1]], operands);
+          break;
+        case RegisterOpCode::GOTO:
+          pc_ = operands[0];
+          break;
+        case RegisterOpCode::JUMP_FALSE:
+        case RegisterOpCode::JUMP_TRUE: {
+          const auto& condition = registers_.Get<types::Bool>(operands[1]);
+          const bool on_true = op_code == RegisterOpCode::JUMP_TRUE;
+          Mask taken;
+          for (size_t lane = 0; lane < LANES; ++lane) {
+            taken[lane] = condition[lane] == on_true;
+          }
+          if (!Branch(operands[0], taken)) {
+            return;
+          }
+          break;
+        }
+        case RegisterOpCode::APPEND_STR: {
+          auto& destination = registers_.Get<types::Str>(operands[0]);
+          const auto& source = registers_.Get<types::Str>(operands[1]);
+          for (size_t lane = 0; lane < LANES; ++lane) {
+            if (active_[lane]) {
+              destination[lane] += source[lane];
+            }
+          }
+          break;
+        }
+
+#define CASE_TYPED(name, type)                                          \
+  case RegisterOpCode::READ_##name:                                     \
+    Read<types::type>(operands[0]);                                     \
+    break;                                                              \
+  case RegisterOpCode::WRITE_##name:                                    \
+    Write<types::type>(operands[0]);                                    \
+    break;
+#define CASE_BINARY(name, generic_name, op, lhs, rhs)                   \
+  case RegisterOpCode::name:                                            \
+    ExecuteBinary<op_type::op, types::lhs, types::rhs>(operands);       \
+    break;
+#define CASE_UNARY(name, generic_name, op, type)                        \
+  case RegisterOpCode::name:                                            \
+    ExecuteUnary<op_type::op, types::type>(operands);                   \
+    break;
+#define CASE_ASSIGN(name, lhs, rhs)                                     \
+  case RegisterOpCode::ASSIGN_##name:                                   \
+    ExecuteAssign<types::lhs, types::rhs>(operands);                    \
+    break;
+#define CASE_FUSED_JUMP(name, op, ...)                                  \
+  case RegisterOpCode::JUMP_FALSE_##name##_INT:                         \
+    if (!Branch(operands[0], CompareInts<op_type::op>(operands))) {     \
+      return;                                                           \
+    }                                                                   \
+    break;
+
+          INTERPRETER_VALUE_TYPES(CASE_TYPED)
+          INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(CASE_BINARY)
+          INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(CASE_UNARY)
+          INTERPRETER_SPECIALIZED_ASSIGNMENTS(CASE_ASSIGN)
+          INTERPRETER_FUSED_COMPARISONS(CASE_FUSED_JUMP)
+
+#undef CASE_TYPED
+#undef CASE_BINARY
+#undef CASE_UNARY
+#undef CASE_ASSIGN
+#undef CASE_FUSED_JUMP
+
+        case RegisterOpCode::_END:
+          throw RuntimeError{
+              utils::format("Unknown instruction at {}", label)};
+      }
+
+      if (waiting_at_[pc_] != 0) {
+        for (size_t lane = 0; lane < LANES; ++lane) {
+          if (active_[lane]) {
+            pcs_[lane] = pc_;
+          }
+        }
+        return;
+      }
+    }
+  }
+
+  // Returns false if the active lanes go apart, their labels are set then
+  bool Branch(Label target, const Mask& taken) {
+    bool is_any = false;
+    bool is_all = true;
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      is_any = is_any || (active_[lane] && taken[lane]);
+      is_all = is_all && (!active_[lane] || taken[lane]);
+    }
+    if (is_all) {
+      pc_ = target;
+    }
+    if (is_all || !is_any) {
+      return true;
+    }
+
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      if (active_[lane]) {
+        pcs_[lane] = taken[lane] ? target : pc_;
+      }
+    }
+    return false;
+  }
+
+  // The last lane continues in the register interpreter with the values of
+  // its lane
+  void RunScalar(size_t lane) {
+    const auto pc = pcs_[lane];
+    const auto& types = types_[pc];
+    std::vector<Cell> registers(types.size());
+    for (size_t reg = 0; reg < types.size(); ++reg) {
+      if (types[reg]) {
+        registers[reg] =
+            registers_.MakeCell(*types[reg], static_cast<Register>(reg), lane);
+      }
+    }
+    block_.Resume(contexts_[runs_[lane]], registers, pc, jit_);
+    live_[lane] = false;
+  }
+
+  template <typename T>
+  void Blend(Lanes<T>& destination, const Lanes<T>& result) const {
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      destination[lane] = active_[lane] ? result[lane] : destination[lane];
+    }
+  }
+
+  template <OperationT Op, ValueT L, ValueT R>
+  void ExecuteBinary(const CodeUnit* operands) {
+    using Result = ResultOf<Op, L, R>;
+    const details::Rule<Op, L, R> rule;
+    const auto& lhs = registers_.Get<L>(operands[1]);
+    const auto& rhs = registers_.Get<R>(operands[2]);
+    auto& destination = registers_.Get<Result>(operands[0]);
+
+    if constexpr (IS_VECTORIZED<Op, L, R>) {
+      Lanes<Result> result;
+      for (size_t lane = 0; lane < LANES; ++lane) {
+        result[lane] = rule(lhs[lane], rhs[lane]);
+      }
+      Blend(destination, result);
+    } else {
+      for (size_t lane = 0; lane < LANES; ++lane) {
+        if (active_[lane]) {
+          destination[lane] = rule(lhs[lane], rhs[lane]);
+        }
+      }
+    }
+  }
+
+  template <OperationT Op, ValueT T>
+  void ExecuteUnary(const CodeUnit* operands) {
+    using Result = ResultOf<Op, T>;
+    const details::Rule<Op, T> rule;
+    const auto& operand = registers_.Get<T>(operands[1]);
+
+    Lanes<Result> result;
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      result[lane] = rule(operand[lane]);
+    }
+    Blend(registers_.Get<Result>(operands[0]), result);
+  }
+
+  template <ValueT L, ValueT R>
+  void ExecuteAssign(const CodeUnit* operands) {
+    const details::Rule<op_type::Assign, L&, R> rule;
+    const auto& source = registers_.Get<R>(operands[1]);
+    auto& destination = registers_.Get<L>(operands[0]);
+
+    if constexpr (IS_VECTORIZED<op_type::Assign, L, R>) {
+      Lanes<L> result;
+      for (size_t lane = 0; lane < LANES; ++lane) {
+        rule(result[lane], source[lane]);
+      }
+      Blend(destination, result);
+    } else {
+      for (size_t lane = 0; lane < LANES; ++lane) {
+        if (active_[lane]) {
+          rule(destination[lane], source[lane]);
+        }
+      }
+    }
+  }
+
+  template <ValueT T>
+  void MoveLanes(const CodeUnit* operands) {
+    const auto& source = registers_.Get<T>(operands[1]);
+    auto& destination = registers_.Get<T>(operands[0]);
+    if constexpr (std::is_same_v<T, types::Str>) {
+      for (size_t lane = 0; lane < LANES; ++lane) {
+        if (active_[lane]) {
+          destination[lane] = source[lane];
+        }
+      }
+    } else {
+      Blend(destination, source);
+    }
+  }
+
+  void Move(VariableType type, const CodeUnit* operands) {
+    // waiting for c++20 using enums
+    switch (type) {
+      case VariableType::INT:
+        MoveLanes<types::Int>(operands);
+        break;
+      case VariableType::REAL:
+        MoveLanes<types::Real>(operands);
+        break;
+      case VariableType::BOOL:
+        MoveLanes<types::Bool>(operands);
+        break;
+      case VariableType::STR:
+        MoveLanes<types::Str>(operands);
+        break;
+      case VariableType::_END:
+        break;
+    }
+  }
+
+  template <OperationT Op>
+  Mask CompareInts(const CodeUnit* operands) {
+    const details::Rule<Op, types::Int, types::Int> rule;
+    const auto& lhs = registers_.Get<types::Int>(operands[1]);
+    const auto& rhs = registers_.Get<types::Int>(operands[2]);
+    // the jump is taken if the comparison is false
+    Mask taken;
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      taken[lane] = !rule(lhs[lane], rhs[lane]);
+    }
+    return taken;
+  }
+
+  template <ValueT T>
+  void Read(Register reg) {
+    auto& variable = registers_.Get<T>(reg);
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      if (active_[lane]) {
+        contexts_[runs_[lane]].input >> variable[lane];
+      }
+    }
+  }
+
+  template <ValueT T>
+  void Write(Register reg) {
+    const auto& value = registers_.Get<T>(reg);
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      if (active_[lane]) {
+        contexts_[runs_[lane]].output << value[lane];
+      }
+    }
+  }
+
+  const RegisterBlock& block_;
+  const std::vector<RegisterTypes>& types_;
+  LaneRegisters registers_;
+  std::span<ExecutionContext> contexts_;
+  std::optional<JitOptions> jit_;
+
+  size_t next_run_ = 0;
+  // index of the context of the run in the lane
+  Lanes<size_t> runs_{};
+  Mask live_{};
+  Mask active_{};
+  Lanes<Label> pcs_{};
+  Label pc_ = 0;
+  Mask waiting_{};
+  // the number of the waiting lanes at the label, the active lanes join them
+  // when they reach it
+  std::vector<std::uint8_t> waiting_at_;
+};
+
+}  // namespace
+
+BatchBlock::BatchBlock(RegisterBlock block)
+    : block_{std::move(block)}, types_{InferRegisterTypes(block_)} {}
+
+void BatchBlock::Execute(std::span<ExecutionContext> contexts,
+                         std::optional<JitOptions> jit) const {
+  BatchRunner{block_, types_, contexts, jit}.Run();
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,36 @@
+#include "interpreter/instructions/cell.hpp"
+
+namespace interpreter::instructions {
+
+Cell::Cell(Value value)
+    : Cell{std::visit(
+          []<typename T>(T&& alternative) {
+            return Cell{std::forward<T>(alternative)};
+          },
+          std::move(value))} {}
+
+Value Cell::ToValue() const {
+  switch (tag_) {
+    // waiting for c++20 using enums
+    case Tag::BOOL:
+      return payload_.bool_value;
+    case Tag::INT:
+      return payload_.int_value;
+    case Tag::REAL:
+      return payload_.real_value;
+    case Tag::STR:
+      return payload_.str->value;
+    case Tag::REFERENCE:
+      break;
+  }
+  throw ValueError{"Reference can't be converted to the value"};
+}
+
+Value Cell::TakeValue() {
+  if (tag_ == Tag::STR) {
+    return Take<types::Str>();
+  }
+  return ToValue();
+}
+
+}  // namespace interpreter::instructions
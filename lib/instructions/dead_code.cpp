@@ -0,0 +1,87 @@
+#include <vector>
+
+#include "interpreter/instructions/passes.hpp"
+#include "interpreter/instructions/rewriter.hpp"
+
+namespace interpreter::instructions {
+
+namespace {
+
+std::vector<bool> FindReachable(std::span<const CodeUnit> code) {
+  std::vector<bool> is_reachable(code.size());
+  std::vector<Label> labels_to_visit;
+
+  const auto visit = [&](Label label) {
+    if (!is_reachable[label]) {
+      is_reachable[label] = true;
+      labels_to_visit.push_back(label);
+    }
+  };
+
+  if (!code.empty()) {
+    visit(0);
+  }
+  while (!labels_to_visit.empty()) {
+    const auto label = labels_to_visit.back();
+    labels_to_visit.pop_back();
+
+    const auto op_code = static_cast<OpCode>(code[label]);
+    const auto info = GetOpCodeInfo(op_code);
+    if (info.is_jump) {
+      visit(code[label + 1]);
+    }
+    if (info.falls_through) {
+      visit(label + GetInstructionSize(op_code));
+    }
+  }
+  return is_reachable;
+}
+
+// Returns true if the code is changed
+bool EliminateDeadCodeOnce(std::vector<CodeUnit>& code) {
+  const auto is_reachable = FindReachable(code);
+
+  std::vector<Label> reachable_labels;
+  bool is_changed = false;
+  ForEachInstruction(code, [&](Label label, OpCode, auto) {
+    if (is_reachable[label]) {
+      reachable_labels.push_back(label);
+    } else {
+      is_changed = true;
+    }
+  });
+
+  CodeRewriter rewriter{code};
+  for (size_t i = 0; i < reachable_labels.size(); ++i) {
+    const auto label = reachable_labels[i];
+    const auto next_label =
+        i + 1 < reachable_labels.size() ? reachable_labels[i + 1] : code.size();
+    const auto op_code = static_cast<OpCode>(code[label]);
+    const auto info = GetOpCodeInfo(op_code);
+
+    if (info.is_jump && !info.keeps_operand_on_jump &&
+        code[label + 1] == next_label) {
+      // both branches go to the same instruction, only the operands are popped
+      rewriter.Bind(label);
+      for (size_t pop = 0; pop < info.pops; ++pop) {
+        rewriter.Emit(OpCode::POP);
+      }
+      is_changed = true;
+    } else {
+      rewriter.Copy(label);
+    }
+  }
+
+  code = std::move(rewriter).Finish();
+  return is_changed;
+}
+
+}  // namespace
+
+void EliminateDeadCode(Bytecode& bytecode) {
+  // removed jumps may make the previous ones jump to the next instruction
+  while (EliminateDeadCodeOnce(bytecode.code)) {
+  }
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,217 @@
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "interpreter/instructions/passes.hpp"
+#include "interpreter/instructions/rewriter.hpp"
+
+namespace interpreter::instructions {
+
+namespace {
+
+// Guards against the operations which are undefined for ints at runtime,
+// they should fail at the same place as without the folding
+template <OperationT Op, ValueT L, ValueT R>
+bool CanFold(const L& lhs, const R& rhs) {
+  constexpr bool is_int_division =
+      (std::is_same_v<Op, op_type::Div> || std::is_same_v<Op, op_type::Mod>) &&
+      std::is_same_v<L, types::Int> && std::is_same_v<R, types::Int>;
+  if constexpr (is_int_division) {
+    return rhs != 0 && !(rhs == -1 && lhs == std::numeric_limits<L>::min());
+  }
+  return true;
+}
+
+std::optional<Value> FoldBinary(OpCode op_code, const Value& lhs,
+                                const Value& rhs) {
+  try {
+    // waiting for c++20 using enums
+    switch (op_code) {
+#define CASE_BINARY(name, generic_name, op, lhs_type, rhs_type)          \
+  case OpCode::name: {                                                   \
+    const auto& l = std::get<types::lhs_type>(lhs);                      \
+    const auto& r = std::get<types::rhs_type>(rhs);                      \
+    if (!CanFold<op_type::op>(l, r)) {                                   \
+      return std::nullopt;                                               \
+    }                                                                    \
+    return Value{                                                        \
+        details::Rule<op_type::op, types::lhs_type, types::rhs_type>{}(  \
+            l, r)};                                                      \
+  }
+
+      INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(CASE_BINARY)
+#undef CASE_BINARY
+
+      default:
+        return std::nullopt;
+    }
+  } catch (const OperationError&) {
+    // leave the error for the runtime
+    return std::nullopt;
+  }
+}
+
+std::optional<Value> FoldUnary(OpCode op_code, const Value& value) {
+  // waiting for c++20 using enums
+  switch (op_code) {
+#define CASE_UNARY(name, generic_name, op, type)              \
+  case OpCode::name:                                          \
+    return Value{details::Rule<op_type::op, types::type>{}(   \
+        std::get<types::type>(value))};
+
+    INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(CASE_UNARY)
+#undef CASE_UNARY
+
+    default:
+      return std::nullopt;
+  }
+}
+
+class ConstantFolder {
+ public:
+  explicit ConstantFolder(Bytecode& bytecode)
+      : bytecode_{bytecode},
+        is_jump_target_(bytecode.code.size()),
+        rewriter_{bytecode.code} {
+    ForEachInstruction(bytecode.code,
+                       [this](Label, OpCode op_code,
+                              std::span<const CodeUnit> operands) {
+                         if (GetOpCodeInfo(op_code).is_jump) {
+                           is_jump_target_[operands[0]] = true;
+                         }
+                       });
+  }
+
+  std::vector<CodeUnit> Run() && {
+    ForEachInstruction(bytecode_.code,
+                       [this](Label label, OpCode op_code,
+                              std::span<const CodeUnit> operands) {
+                         Visit(label, op_code, operands);
+                       });
+    Flush();
+    return std::move(rewriter_).Finish();
+  }
+
+ private:
+  // Constant which is not emitted yet, it covers the folded instructions
+  struct PendingConstant {
+    CodeUnit index;
+    std::vector<Label> labels;
+  };
+
+  void Visit(Label label, OpCode op_code, std::span<const CodeUnit> operands) {
+    if (is_jump_target_[label]) {
+      // the constants can't be folded across the jump target
+      Flush();
+    }
+
+    const auto info = GetOpCodeInfo(op_code);
+    if (op_code == OpCode::INVOKE_CONSTANT) {
+      pending_.push_back({operands[0], {label}});
+    } else if (op_code == OpCode::POP && !pending_.empty()) {
+      Drop(label);
+    } else if (info.pops == 2 && info.pushes == 1 && pending_.size() >= 2) {
+      const auto& lhs = pending_.rbegin()[1];
+      const auto& rhs = pending_.rbegin()[0];
+      if (auto value =
+              FoldBinary(op_code, GetConstant(lhs), GetConstant(rhs))) {
+        Replace(2, label, std::move(*value));
+      } else {
+        Flush();
+        rewriter_.Copy(label);
+      }
+    } else if (info.pops == 1 && info.pushes == 1 && !pending_.empty()) {
+      if (auto value = FoldUnary(op_code, GetConstant(pending_.back()))) {
+        Replace(1, label, std::move(*value));
+      } else {
+        Flush();
+        rewriter_.Copy(label);
+      }
+    } else if (info.is_jump && info.pops == 1 && !pending_.empty()) {
+      FoldJump(label, op_code, operands[0]);
+    } else {
+      Flush();
+      rewriter_.Copy(label);
+    }
+  }
+
+  void FoldJump(Label label, OpCode op_code, CodeUnit target) {
+    const auto* condition =
+        std::get_if<types::Bool>(&GetConstant(pending_.back()));
+    if (!condition) {
+      Flush();
+      rewriter_.Copy(label);
+      return;
+    }
+
+    const bool jump_on_true = op_code == OpCode::JUMP_TRUE ||
+                              op_code == OpCode::JUMP_TRUE_OR_POP;
+    if (*condition != jump_on_true) {
+      // never jumps, the condition is popped
+      Drop(label);
+      return;
+    }
+
+    auto constant = std::move(pending_.back());
+    pending_.pop_back();
+    Flush();
+    if (GetOpCodeInfo(op_code).keeps_operand_on_jump) {
+      pending_.push_back(std::move(constant));
+      Flush();
+    } else {
+      BindAll(constant.labels);
+    }
+    rewriter_.Bind(label);
+    rewriter_.Emit(OpCode::GOTO, {target});
+  }
+
+  // Removes the last constant with the instruction which pops it
+  void Drop(Label label) {
+    BindAll(pending_.back().labels);
+    pending_.pop_back();
+    rewriter_.Bind(label);
+  }
+
+  // Replaces count of the last constants with the result of the operation
+  void Replace(size_t count, Label label, Value value) {
+    PendingConstant result{bytecode_.constants.Add(std::move(value)),
+                           {label}};
+    for (size_t i = 0; i < count; ++i) {
+      auto& labels = pending_.back().labels;
+      result.labels.insert(result.labels.end(), labels.begin(), labels.end());
+      pending_.pop_back();
+    }
+    pending_.push_back(std::move(result));
+  }
+
+  void Flush() {
+    for (const auto& constant : pending_) {
+      BindAll(constant.labels);
+      rewriter_.Emit(OpCode::INVOKE_CONSTANT, {constant.index});
+    }
+    pending_.clear();
+  }
+
+  void BindAll(const std::vector<Label>& labels) {
+    for (const auto label : labels) {
+      rewriter_.Bind(label);
+    }
+  }
+
+  const Value& GetConstant(const PendingConstant& constant) const {
+    return bytecode_.constants[constant.index];
+  }
+
+  Bytecode& bytecode_;
+  std::vector<bool> is_jump_target_;
+  std::vector<PendingConstant> pending_;
+  CodeRewriter rewriter_;
+};
+
+}  // namespace
+
+void FoldConstants(Bytecode& bytecode) {
+  bytecode.code = ConstantFolder{bytecode}.Run();
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,28 @@
+#include "interpreter/instructions/frame.hpp"
+
+#include <algorithm>
+
+namespace interpreter::instructions {
+
+namespace {
+
+template <typename T, typename Bank>
+void InitializeBank(Bank& bank, const std::vector<T>& initial_values) {
+  bank = std::make_unique<T[]>(initial_values.size());
+  std::copy(initial_values.begin(), initial_values.end(), bank.get());
+}
+
+}  // namespace
+
+Frame::Frame(const FrameLayout& layout) {
+  std::apply(
+      [&layout]<typename... Banks>(Banks&... banks) {
+        (InitializeBank(banks,
+                        layout.GetInitialValues<
+                            typename Banks::element_type>()),
+         ...);
+      },
+      banks_);
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,255 @@
+#include <optional>
+#include <vector>
+
+#include "interpreter/instructions/passes.hpp"
+#include "interpreter/instructions/rewriter.hpp"
+
+namespace interpreter::instructions {
+
+namespace {
+
+struct Instruction {
+  Label label;
+  OpCode op_code;
+  std::span<const CodeUnit> operands;
+};
+
+struct FusedJumps {
+  OpCode stack;
+  OpCode constant;
+  OpCode variable_constant;
+  OpCode variables;
+};
+
+std::optional<FusedJumps> FindFusedJumps(OpCode compare) {
+#define FIND_FUSED_JUMPS(name, ...)                                      \
+  if (compare == OpCode::name##_INT_INT) {                               \
+    return FusedJumps{OpCode::JUMP_FALSE_##name##_INT,                   \
+                      OpCode::JUMP_FALSE_##name##_INT_C,                 \
+                      OpCode::JUMP_FALSE_##name##_INT_VC,                \
+                      OpCode::JUMP_FALSE_##name##_INT_VV};               \
+  }
+
+  INTERPRETER_FUSED_COMPARISONS(FIND_FUSED_JUMPS)
+#undef FIND_FUSED_JUMPS
+
+  return std::nullopt;
+}
+
+bool IsLoad(OpCode op_code) {
+#define IS_LOAD(name, ...)                 \
+  if (op_code == OpCode::LOAD_##name) {    \
+    return true;                           \
+  }
+
+  INTERPRETER_VALUE_TYPES(IS_LOAD)
+#undef IS_LOAD
+
+  return false;
+}
+
+std::optional<OpCode> FindStore(OpCode assign) {
+#define FIND_STORE(name, ...)             \
+  if (assign == OpCode::ASSIGN_##name) {  \
+    return OpCode::STORE_##name;          \
+  }
+
+  INTERPRETER_SPECIALIZED_ASSIGNMENTS(FIND_STORE)
+#undef FIND_STORE
+
+  return std::nullopt;
+}
+
+// JUMP_TRUE after the comparison is JUMP_FALSE after the negated one,
+// it's exact for ints
+std::optional<OpCode> NegateComparison(OpCode compare) {
+#define NEGATE_COMPARISON(name, op, negation) \
+  if (compare == OpCode::name##_INT_INT) {    \
+    return OpCode::negation##_INT_INT;        \
+  }
+
+  INTERPRETER_FUSED_COMPARISONS(NEGATE_COMPARISON)
+#undef NEGATE_COMPARISON
+
+  return std::nullopt;
+}
+
+class Fuser {
+ public:
+  explicit Fuser(const Bytecode& bytecode)
+      : bytecode_{bytecode},
+        is_jump_target_(bytecode.code.size()),
+        rewriter_{bytecode.code} {
+    ForEachInstruction(
+        bytecode.code, [this](Label label, OpCode op_code,
+                              std::span<const CodeUnit> operands) {
+          instructions_.push_back({label, op_code, operands});
+          if (GetOpCodeInfo(op_code).is_jump) {
+            is_jump_target_[operands[0]] = true;
+          }
+        });
+  }
+
+  std::vector<CodeUnit> Run() && {
+    for (size_t i = 0; i < instructions_.size();) {
+      window_ = std::span{instructions_}.subspan(i);
+      i += TryFuse();
+    }
+    return std::move(rewriter_).Finish();
+  }
+
+ private:
+  // Returns the count of the replaced instructions
+  size_t TryFuse() {
+    if (auto fused = TryFuseIncrement()) return fused;
+    if (auto fused = TryFuseCompareJump()) return fused;
+    if (auto fused = TryFuseStore()) return fused;
+    if (auto removed = TryRemoveUnusedLoad()) return removed;
+
+    rewriter_.Copy(window_[0].label);
+    return 1;
+  }
+
+  // LOAD_INT v; INVOKE_CONSTANT c; PLUS_INT_INT; ASSIGN_INT_INT v; POP
+  size_t TryFuseIncrement() {
+    if (!CanFuse(5) || !Is(0, OpCode::LOAD_INT) ||
+        !Is(3, OpCode::ASSIGN_INT_INT) || !Is(4, OpCode::POP) ||
+        window_[0].operands[0] != window_[3].operands[0]) {
+      return 0;
+    }
+    const auto constant = GetIntConstant(1);
+    if (!constant) {
+      return 0;
+    }
+
+    OpCode increment;
+    if (Is(2, OpCode::PLUS_INT_INT)) {
+      increment = OpCode::INCREMENT_INT;
+    } else if (Is(2, OpCode::MINUS_INT_INT)) {
+      increment = OpCode::DECREMENT_INT;
+    } else {
+      return 0;
+    }
+    return Replace(5, increment,
+                   {window_[0].operands[0], EncodeImmediate(*constant)});
+  }
+
+  // [LOAD_INT a] [LOAD_INT b | INVOKE_CONSTANT c] <COMPARE>_INT_INT
+  // JUMP_FALSE | JUMP_TRUE
+  size_t TryFuseCompareJump() {
+    for (size_t compare = 0; compare <= 2; ++compare) {
+      if (!CanFuse(compare + 2)) {
+        continue;
+      }
+      std::optional<OpCode> compare_op_code = window_[compare].op_code;
+      if (Is(compare + 1, OpCode::JUMP_TRUE)) {
+        compare_op_code = NegateComparison(*compare_op_code);
+      } else if (!Is(compare + 1, OpCode::JUMP_FALSE)) {
+        continue;
+      }
+      if (!compare_op_code) {
+        continue;
+      }
+      const auto jumps = FindFusedJumps(*compare_op_code);
+      if (!jumps) {
+        continue;
+      }
+      const auto label = window_[compare + 1].operands[0];
+
+      if (compare == 0) {
+        return Replace(compare + 2, jumps->stack, {label});
+      }
+      const auto constant = GetIntConstant(compare - 1);
+      if (compare == 1 && constant) {
+        return Replace(compare + 2, jumps->constant,
+                       {label, EncodeImmediate(*constant)});
+      }
+      if (compare == 2 && Is(0, OpCode::LOAD_INT)) {
+        const auto lhs = window_[0].operands[0];
+        if (constant) {
+          return Replace(compare + 2, jumps->variable_constant,
+                         {label, lhs, EncodeImmediate(*constant)});
+        }
+        if (Is(1, OpCode::LOAD_INT)) {
+          return Replace(compare + 2, jumps->variables,
+                         {label, lhs, window_[1].operands[0]});
+        }
+      }
+    }
+    return 0;
+  }
+
+  // ASSIGN_<TYPES> v; POP
+  size_t TryFuseStore() {
+    if (!CanFuse(2) || !Is(1, OpCode::POP)) {
+      return 0;
+    }
+    const auto store = FindStore(window_[0].op_code);
+    if (!store) {
+      return 0;
+    }
+    return Replace(2, *store, {window_[0].operands[0]});
+  }
+
+  // LOAD_<TYPE> v; POP
+  size_t TryRemoveUnusedLoad() {
+    if (!CanFuse(2) || !Is(1, OpCode::POP) || !IsLoad(window_[0].op_code)) {
+      return 0;
+    }
+    // jumps to the load land on the next instruction
+    rewriter_.Bind(window_[0].label);
+    rewriter_.Bind(window_[1].label);
+    return 2;
+  }
+
+  // Instructions except the first one are not jump targets
+  bool CanFuse(size_t count) const {
+    if (window_.size() < count) {
+      return false;
+    }
+    for (size_t i = 1; i < count; ++i) {
+      if (is_jump_target_[window_[i].label]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool Is(size_t i, OpCode op_code) const {
+    return window_[i].op_code == op_code;
+  }
+
+  std::optional<types::Int> GetIntConstant(size_t i) const {
+    if (!Is(i, OpCode::INVOKE_CONSTANT)) {
+      return std::nullopt;
+    }
+    const auto& constant = bytecode_.constants[window_[i].operands[0]];
+    if (const auto* value = std::get_if<types::Int>(&constant)) {
+      return *value;
+    }
+    return std::nullopt;
+  }
+
+  size_t Replace(size_t count, OpCode op_code,
+                 std::initializer_list<CodeUnit> operands) {
+    for (size_t i = 0; i < count; ++i) {
+      rewriter_.Bind(window_[i].label);
+    }
+    rewriter_.Emit(op_code, operands);
+    return count;
+  }
+
+  const Bytecode& bytecode_;
+  std::vector<Instruction> instructions_;
+  std::vector<bool> is_jump_target_;
+  std::span<const Instruction> window_;
+  CodeRewriter rewriter_;
+};
+
+}  // namespace
+
+void FuseInstructions(Bytecode& bytecode) {
+  bytecode.code = Fuser{bytecode}.Run();
+}
+
+}  // namespace interpreter::instructions
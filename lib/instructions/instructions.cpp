@@ -1,7 +1,11 @@
 #include "interpreter/instructions/instructions.hpp"
 
+#include <array>
 #include <iostream>
+#include <utility>
 
+#include "interpreter/ast/types_helpers.hpp"
+#include "interpreter/instructions/analysis.hpp"
 #include "interpreter/instructions/operations.hpp"
 #include "interpreter/utils/format.hpp"
 
@@ -23,96 +27,587 @@ struct Writer {
   }
 };
 
-ExecutionContext MakeChildExecutionContext(const ExecutionContext& parent) {
+ExecutionContext MakeChildExecutionContext(const ExecutionContext& parent,
+                                           const FrameLayout& frame_layout,
+                                           size_t max_stack_depth) {
   return ExecutionContext{.input = parent.input,
                           .output = parent.output,
-                          .variables = {},
-                          .values_stack = {},
+                          .frame = Frame{frame_layout},
+                          .values_stack = OperandStack{max_stack_depth},
                           .current_instruction = 0};
 }
 
-}  // namespace
-
-void NoOp::Execute(ExecutionContext& context) const {}
+OperationValue ToReference(Slot slot, Frame& frame) {
+  return ast::VisitType(
+      [&frame, slot]<typename T>(utils::TypeTag<T>) -> OperationValue {
+        return Reference{std::ref(frame.Get<T>(slot.index))};
+      },
+      slot.type);
+}
 
-void InstructionsBlock::Execute(ExecutionContext& parent_context) const {
-  auto context = MakeChildExecutionContext(parent_context);
-  while (context.current_instruction < instructions_.size()) {
-    instructions_[context.current_instruction]->Execute(context);
-    ++context.current_instruction;
+// Generic operations work with the variables through the references, it's
+// the slow path for the operands which types are not proven statically
+OperationValue ToOperationValue(const Cell& cell, Frame& frame) {
+  if (cell.IsReference()) {
+    return ToReference(cell.GetSlot(), frame);
   }
+  return cell.ToValue();
 }
 
-void VariableDefinition::Execute(ExecutionContext& context) const {
-  if (context.variables.contains(name_)) {
-    throw RuntimeError{
-        utils::format("Variable {} is already declared.", name_)};
+// Same, but the string is moved out of the cell if nobody else sees it
+OperationValue TakeOperationValue(Cell& cell, Frame& frame) {
+  if (cell.IsReference()) {
+    return ToReference(cell.GetSlot(), frame);
   }
+  return cell.TakeValue();
+}
 
-  context.variables[name_] = initial_value_;
+Cell ToCell(OperationValue&& value) {
+  return Cell{std::get<Value>(std::move(value))};
 }
 
-void Write::Execute(ExecutionContext& context) const {
+template <OperationT Op>
+void ExecuteBinary(ExecutionContext& context) {
   auto& stack = context.values_stack;
-  if (stack.empty()) {
-    throw RuntimeError{"Nothing to write"};
+  auto rhs = TakeOperationValue(stack.Top(), context.frame);
+  stack.Drop();
+  auto& lhs = stack.Top();
+  lhs = ToCell(PerformOperation<Op>(TakeOperationValue(lhs, context.frame),
+                                    std::move(rhs)));
+}
+
+template <OperationT Op>
+void ExecuteUnary(ExecutionContext& context) {
+  auto& value = context.values_stack.Top();
+  value =
+      ToCell(PerformOperation<Op>(TakeOperationValue(value, context.frame)));
+}
+
+Slot DecodeSlot(const CodeUnit* operands) noexcept {
+  return {static_cast<ast::VariableType>(operands[0]), operands[1]};
+}
+
+void ReadVariable(ExecutionContext& context, Slot slot) {
+  ast::VisitType(
+      [&context, slot]<typename T>(utils::TypeTag<T>) -> void {
+        context.input >> context.frame.Get<T>(slot.index);
+      },
+      slot.type);
+}
+
+// Types of the operands of the specialized instructions are proven by
+// SpecializeTypes, so the tags of the cells are not checked
+
+template <OperationT Op, ValueT L, ValueT R>
+void ExecuteBinary(OperandStack& stack) {
+  auto& lhs = stack.Top(1);
+  lhs.Set(details::Rule<Op, L, R>{}(lhs.Take<L>(), stack.Top().Get<R>()));
+  stack.Drop();
+}
+
+template <OperationT Op, ValueT T>
+void ExecuteUnary(OperandStack& stack) {
+  auto& value = stack.Top();
+  value.Set(details::Rule<Op, T>{}(value.Get<T>()));
+}
+
+template <ValueT L, ValueT R>
+void ExecuteAssign(ExecutionContext& context, SlotIndex index) {
+  auto& value = context.values_stack.Top();
+  const auto& variable = details::Rule<op_type::Assign, L&, R>{}(
+      context.frame.Get<L>(index), value.Get<R>());
+  if constexpr (!std::is_same_v<L, R>) {
+    // the result is converted to the type of the variable
+    value.Set(variable);
+  }
+}
+
+template <ValueT L, ValueT R>
+void ExecuteStore(ExecutionContext& context, SlotIndex index) {
+  details::Rule<op_type::Assign, L&, R>{}(
+      context.frame.Get<L>(index), context.values_stack.Top().Take<R>());
+  context.values_stack.Drop();
+}
+
+// The buffer of the variable grows geometrically, so the appending is
+// amortized by the length of the appended string
+void AppendString(ExecutionContext& context, SlotIndex index) {
+  context.frame.Get<types::Str>(index) +=
+      context.values_stack.Top().Get<types::Str>();
+  context.values_stack.Drop();
+}
+
+template <OperationT Op>
+void ExecuteIncrement(ExecutionContext& context, const CodeUnit* operands) {
+  auto& variable = context.frame.Get<types::Int>(operands[0]);
+  variable = details::Rule<Op, types::Int, types::Int>{}(
+      variable, DecodeImmediate(operands[1]));
+}
+
+template <OperationT Op>
+bool CompareInts(types::Int lhs, types::Int rhs) {
+  return details::Rule<Op, types::Int, types::Int>{}(lhs, rhs);
+}
+
+[[gnu::always_inline]] inline types::Int PopInt(OperandStack& stack) {
+  const auto value = stack.Top().Get<types::Int>();
+  stack.DropScalar();
+  return value;
+}
+
+template <OperationT Op>
+bool PopCompareInts(OperandStack& stack, types::Int rhs) {
+  return CompareInts<Op>(PopInt(stack), rhs);
+}
+
+template <OperationT Op>
+bool PopCompareInts(OperandStack& stack) {
+  const auto rhs = PopInt(stack);
+  return PopCompareInts<Op>(stack, rhs);
+}
+
+template <ValueT T>
+void LoadVariable(ExecutionContext& context, SlotIndex index) {
+  context.values_stack.Push(Cell{context.frame.Get<T>(index)});
+}
+
+template <ValueT T>
+void WriteValue(ExecutionContext& context) {
+  context.output << context.values_stack.Top().Get<T>();
+  context.values_stack.Drop();
+}
+
+void WriteCell(ExecutionContext& context) {
+  VisitOperationValues(
+      Writer{context.output},
+      TakeOperationValue(context.values_stack.Top(), context.frame));
+  context.values_stack.Drop();
+}
+
+bool ToBool(const Cell& cell, Frame& frame) {
+  if (cell.GetTag() == Cell::Tag::BOOL) {
+    return cell.Get<types::Bool>();
+  }
+  return VisitOperationValues(ToBoolVisitor{}, ToOperationValue(cell, frame));
+}
+
+bool TopBool(ExecutionContext& context) {
+  return ToBool(context.values_stack.Top(), context.frame);
+}
+
+bool PopBool(ExecutionContext& context) {
+  const auto value = TopBool(context);
+  context.values_stack.Drop();
+  return value;
+}
+
+// The top of the operand stack cached in the local variable of the dispatch
+// loop when it's an int: the int instructions are the hot ones after
+// SpecializeTypes, and they pass the values through the register instead of
+// boxing them into the cells of the stack in memory. The methods are always
+// inlined, otherwise the cache escapes and isn't kept in the registers.
+class IntCache {
+ public:
+  [[nodiscard]] inline bool IsFull() const noexcept { return is_full_; }
+
+  // Moves the cached value to the stack in memory
+  [[gnu::always_inline]] inline void Flush(OperandStack& stack) noexcept {
+    if (is_full_) {
+      stack.Push(Cell{value_});
+      is_full_ = false;
+    }
+  }
+
+  [[gnu::always_inline]] inline void Push(OperandStack& stack,
+                                          types::Int value) noexcept {
+    Flush(stack);
+    value_ = value;
+    is_full_ = true;
+  }
+
+  [[nodiscard, gnu::always_inline]] inline types::Int Pop(
+      OperandStack& stack) noexcept {
+    if (is_full_) {
+      is_full_ = false;
+      return value_;
+    }
+    return PopInt(stack);
+  }
+
+  [[nodiscard, gnu::always_inline]] inline types::Int Top(
+      OperandStack& stack) noexcept {
+    return is_full_ ? value_ : stack.Top().Get<types::Int>();
+  }
+
+ private:
+  types::Int value_ = 0;
+  bool is_full_ = false;
+};
+
+constexpr bool IsIntInstruction(OpCode op_code) noexcept {
+  constexpr auto is_int = []<ValueT... T>() {
+    return (std::is_same_v<T, types::Int> && ...);
+  };
+
+  // waiting for c++20 using enums
+  switch (op_code) {
+    case OpCode::INVOKE_CONSTANT:
+    case OpCode::LOAD_INT:
+    case OpCode::WRITE_INT:
+      return true;
+
+#define CASE_BINARY(name, generic_name, op, lhs, rhs) \
+  case OpCode::name:                                  \
+    return is_int.template operator()<types::lhs, types::rhs>();
+#define CASE_UNARY(name, generic_name, op, type) \
+  case OpCode::name:                             \
+    return is_int.template operator()<types::type>();
+#define CASE_ASSIGN(name, lhs, rhs)                                 \
+  case OpCode::ASSIGN_##name:                                       \
+  case OpCode::STORE_##name:                                        \
+    return is_int.template operator()<types::lhs, types::rhs>();
+#define CASE_FUSED_JUMPS(name, ...)     \
+  case OpCode::JUMP_FALSE_##name##_INT: \
+  case OpCode::JUMP_FALSE_##name##_INT_C:
+
+      INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(CASE_BINARY)
+      INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(CASE_UNARY)
+      INTERPRETER_SPECIALIZED_ASSIGNMENTS(CASE_ASSIGN)
+      INTERPRETER_FUSED_COMPARISONS(CASE_FUSED_JUMPS)
+      return true;
+
+#undef CASE_BINARY
+#undef CASE_UNARY
+#undef CASE_ASSIGN
+#undef CASE_FUSED_JUMPS
+
+    default:
+      return false;
   }
+}
+
+// The instruction works with the cached int or doesn't touch the stack,
+// the cache is flushed before all the others
+constexpr bool KeepsIntCache(OpCode op_code) noexcept {
+  const auto info = GetOpCodeInfo(op_code);
+  return IsIntInstruction(op_code) || (info.pops == 0 && info.pushes == 0);
+}
+
+template <size_t... I>
+consteval auto MakeKeepsIntCache(std::index_sequence<I...>) noexcept {
+  return std::array<bool, sizeof...(I)>{
+      KeepsIntCache(static_cast<OpCode>(I))...};
+}
 
-  const auto value = stack.top();
-  stack.pop();
+constexpr auto KEEPS_INT_CACHE = MakeKeepsIntCache(
+    std::make_index_sequence<static_cast<size_t>(OpCode::_END)>{});
 
-  VisitOperationValues(Writer{context.output}, value);
+// Handlers of the int instructions specialized for the cache
+
+void InvokeConstant(OperandStack& stack, IntCache& cache,
+                    const Cell& constant) {
+  if (constant.GetTag() == Cell::Tag::INT) {
+    cache.Push(stack, constant.Get<types::Int>());
+  } else {
+    cache.Flush(stack);
+    stack.Push(constant);
+  }
 }
 
-void Read::Execute(ExecutionContext& context) const {
-  auto var_it = context.variables.find(variable_name_);
-  if (var_it == context.variables.cend()) {
-    throw RuntimeError{utils::format(
-        "Failed to read variable '{}', it is not declared.", variable_name_)};
+template <OperationT Op, ValueT L, ValueT R>
+void ExecuteBinary(OperandStack& stack, IntCache& cache) {
+  if constexpr (std::is_same_v<L, types::Int> &&
+                std::is_same_v<R, types::Int>) {
+    const auto rhs = cache.Pop(stack);
+    const auto lhs = cache.Pop(stack);
+    const auto result = details::Rule<Op, L, R>{}(lhs, rhs);
+    if constexpr (std::is_same_v<decltype(result), const types::Int>) {
+      cache.Push(stack, result);
+    } else {
+      stack.Push(Cell{result});
+    }
+  } else {
+    ExecuteBinary<Op, L, R>(stack);
   }
+}
 
-  auto& variable = var_it->second;
-  VisitValues([&context](auto& value) { context.input >> value; }, variable);
+template <OperationT Op, ValueT T>
+void ExecuteUnary(OperandStack& stack, IntCache& cache) {
+  if constexpr (std::is_same_v<T, types::Int>) {
+    cache.Push(stack, details::Rule<Op, T>{}(cache.Pop(stack)));
+  } else {
+    ExecuteUnary<Op, T>(stack);
+  }
 }
 
-void Pop::Execute(ExecutionContext& context) const {
-  if (context.values_stack.empty()) {
-    throw RuntimeError{"Empty expression error"};
+template <ValueT L, ValueT R>
+void ExecuteAssign(ExecutionContext& context, IntCache& cache,
+                   SlotIndex index) {
+  if constexpr (std::is_same_v<L, types::Int> &&
+                std::is_same_v<R, types::Int>) {
+    context.frame.Get<L>(index) = cache.Top(context.values_stack);
+  } else {
+    ExecuteAssign<L, R>(context, index);
   }
-  context.values_stack.pop();
 }
 
-void InvokeConstant::Execute(ExecutionContext& context) const {
-  context.values_stack.push(value_);
+template <ValueT L, ValueT R>
+void ExecuteStore(ExecutionContext& context, IntCache& cache,
+                  SlotIndex index) {
+  if constexpr (std::is_same_v<L, types::Int> &&
+                std::is_same_v<R, types::Int>) {
+    context.frame.Get<L>(index) = cache.Pop(context.values_stack);
+  } else {
+    ExecuteStore<L, R>(context, index);
+  }
 }
 
-void InvokeVariable::Execute(ExecutionContext& context) const {
-  if (!context.variables.contains(name_)) {
-    throw RuntimeError{utils::format("Variable {} is not defined", name_)};
+template <ValueT T>
+void LoadVariable(ExecutionContext& context, IntCache& cache,
+                  SlotIndex index) {
+  if constexpr (std::is_same_v<T, types::Int>) {
+    cache.Push(context.values_stack, context.frame.Get<T>(index));
+  } else {
+    LoadVariable<T>(context, index);
   }
-  auto& variable = context.variables.at(name_);
-  context.values_stack.push(VisitValues(
-      [](auto& value) -> OperationValue { return Reference{std::ref(value)}; },
-      variable));
 }
 
-void JumpBool::Execute(ExecutionContext& context) const {
-  if (context.values_stack.empty()) {
-    throw RuntimeError{"No expressions for perform bool jump"};
+template <ValueT T>
+void WriteValue(ExecutionContext& context, IntCache& cache) {
+  if constexpr (std::is_same_v<T, types::Int>) {
+    context.output << cache.Pop(context.values_stack);
+  } else {
+    WriteValue<T>(context);
   }
+}
+
+template <OperationT Op>
+bool PopCompareInts(OperandStack& stack, IntCache& cache, types::Int rhs) {
+  return CompareInts<Op>(cache.Pop(stack), rhs);
+}
+
+template <OperationT Op>
+bool PopCompareInts(OperandStack& stack, IntCache& cache) {
+  const auto rhs = cache.Pop(stack);
+  return PopCompareInts<Op>(stack, cache, rhs);
+}
+
+}  // namespace
+
+InstructionsBlock::InstructionsBlock(Bytecode bytecode)
+    : bytecode_{std::move(bytecode)},
+      constants_(bytecode_.constants.begin(), bytecode_.constants.end()),
+      max_stack_depth_{ComputeMaxStackDepth(bytecode_.code)} {}
+
+void InstructionsBlock::Execute(ExecutionContext& parent_context) const {
+  auto context = MakeChildExecutionContext(
+      parent_context, bytecode_.frame_layout, max_stack_depth_);
+  Resume(context);
+}
+
+std::optional<CodeUnit> InstructionsBlock::Resume(
+    ExecutionContext& context, LoopWatch* watch) const {
+  auto& stack = context.values_stack;
+  auto& pc = context.current_instruction;
+  const CodeUnit* const code = bytecode_.code.data();
+  const Cell* const constants = constants_.data();
+  IntCache cache;
+
+  for (;;) {
+    const auto op_code = static_cast<OpCode>(code[pc]);
+    const CodeUnit* const operands = code + pc + 1;
+    pc += GetInstructionSize(op_code);
+    if (cache.IsFull() && !KEEPS_INT_CACHE[static_cast<size_t>(op_code)]) {
+      cache.Flush(stack);
+    }
+
+    // waiting for c++20 using enums
+    switch (op_code) {
+      case OpCode::NOP:
+        break;
+      case OpCode::HALT:
+        return std::nullopt;
+      case OpCode::LOOP_HEADER:
+        // the operand stack is empty at the loop headers
+        if (watch != nullptr && watch->IsStopped(operands[0])) {
+          pc -= GetInstructionSize(op_code);
+          return operands[0];
+        }
+        break;
+      case OpCode::READ:
+        ReadVariable(context, DecodeSlot(operands));
+        break;
+      case OpCode::WRITE:
+        WriteCell(context);
+        break;
+      case OpCode::POP:
+        stack.Drop();
+        break;
+      case OpCode::INVOKE_CONSTANT:
+        InvokeConstant(stack, cache, constants[operands[0]]);
+        break;
+      case OpCode::INVOKE_VARIABLE:
+        stack.Push(Cell::MakeReference(DecodeSlot(operands)));
+        break;
+      case OpCode::GOTO:
+        pc = operands[0];
+        break;
+      case OpCode::JUMP_FALSE:
+        if (!PopBool(context)) pc = operands[0];
+        break;
+      case OpCode::JUMP_TRUE:
+        if (PopBool(context)) pc = operands[0];
+        break;
+      case OpCode::JUMP_FALSE_OR_POP:
+        if (!TopBool(context)) {
+          pc = operands[0];
+        } else {
+          stack.Drop();
+        }
+        break;
+      case OpCode::JUMP_TRUE_OR_POP:
+        if (TopBool(context)) {
+          pc = operands[0];
+        } else {
+          stack.Drop();
+        }
+        break;
+      case OpCode::ASSIGN:
+        ExecuteBinary<op_type::Assign>(context);
+        break;
+      case OpCode::PLUS:
+        ExecuteBinary<op_type::Plus>(context);
+        break;
+      case OpCode::MINUS:
+        ExecuteBinary<op_type::Minus>(context);
+        break;
+      case OpCode::MUL:
+        ExecuteBinary<op_type::Mul>(context);
+        break;
+      case OpCode::DIV:
+        ExecuteBinary<op_type::Div>(context);
+        break;
+      case OpCode::MOD:
+        ExecuteBinary<op_type::Mod>(context);
+        break;
+      case OpCode::EQUALS:
+        ExecuteBinary<op_type::Equals>(context);
+        break;
+      case OpCode::NOT_EQUALS:
+        ExecuteBinary<op_type::NotEquals>(context);
+        break;
+      case OpCode::LESS:
+        ExecuteBinary<op_type::Less>(context);
+        break;
+      case OpCode::GREATER:
+        ExecuteBinary<op_type::Greater>(context);
+        break;
+      case OpCode::LESS_OR_EQ:
+        ExecuteBinary<op_type::LessOrEq>(context);
+        break;
+      case OpCode::GREATER_OR_EQ:
+        ExecuteBinary<op_type::GreaterOrEq>(context);
+        break;
+      case OpCode::NOT:
+        ExecuteUnary<op_type::Not>(context);
+        break;
+      case OpCode::UNARY_MINUS:
+        ExecuteUnary<op_type::UnaryMinus>(context);
+        break;
+      case OpCode::UNARY_PLUS:
+        ExecuteUnary<op_type::UnaryPlus>(context);
+        break;
+
+#define CASE_TYPED(name, type)                              \
+  case OpCode::LOAD_##name:                                 \
+    LoadVariable<types::type>(context, cache, operands[0]); \
+    break;                                                  \
+  case OpCode::WRITE_##name:                                \
+    WriteValue<types::type>(context, cache);                \
+    break;
+#define CASE_BINARY(name, generic_name, op, lhs, rhs)                 \
+  case OpCode::name:                                                  \
+    ExecuteBinary<op_type::op, types::lhs, types::rhs>(stack, cache); \
+    break;
+#define CASE_UNARY(name, generic_name, op, type)          \
+  case OpCode::name:                                      \
+    ExecuteUnary<op_type::op, types::type>(stack, cache); \
+    break;
+#define CASE_ASSIGN(name, lhs, rhs)                                     \
+  case OpCode::ASSIGN_##name:                                           \
+    ExecuteAssign<types::lhs, types::rhs>(context, cache, operands[0]); \
+    break;                                                              \
+  case OpCode::STORE_##name:                                            \
+    ExecuteStore<types::lhs, types::rhs>(context, cache, operands[0]);  \
+    break;
+#define CASE_FUSED_JUMPS(name, op, ...)                                \
+  case OpCode::JUMP_FALSE_##name##_INT:                                \
+    if (!PopCompareInts<op_type::op>(stack, cache)) pc = operands[0];  \
+    break;                                                             \
+  case OpCode::JUMP_FALSE_##name##_INT_C:                              \
+    if (!PopCompareInts<op_type::op>(stack, cache,                     \
+                                     DecodeImmediate(operands[1]))) {  \
+      pc = operands[0];                                                \
+    }                                                                  \
+    break;                                                             \
+  case OpCode::JUMP_FALSE_##name##_INT_VC:                             \
+    if (!CompareInts<op_type::op>(                                     \
+            context.frame.Get<types::Int>(operands[1]),                \
+            DecodeImmediate(operands[2]))) {                           \
+      pc = operands[0];                                                \
+    }                                                                  \
+    break;                                                             \
+  case OpCode::JUMP_FALSE_##name##_INT_VV:                             \
+    if (!CompareInts<op_type::op>(                                     \
+            context.frame.Get<types::Int>(operands[1]),                \
+            context.frame.Get<types::Int>(operands[2]))) {             \
+      pc = operands[0];                                                \
+    }                                                                  \
+    break;
 
-  auto value = context.values_stack.top();
-  context.values_stack.pop();
+        INTERPRETER_VALUE_TYPES(CASE_TYPED)
+        INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(CASE_BINARY)
+        INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(CASE_UNARY)
+        INTERPRETER_SPECIALIZED_ASSIGNMENTS(CASE_ASSIGN)
+        INTERPRETER_FUSED_COMPARISONS(CASE_FUSED_JUMPS)
 
-  const bool bool_on_stack =
-      VisitOperationValues(ToBoolVisitor{}, std::move(value));
-  if (bool_on_stack == jump_statement_) {
-    context.current_instruction = label_;
+#undef CASE_TYPED
+#undef CASE_BINARY
+#undef CASE_UNARY
+#undef CASE_ASSIGN
+#undef CASE_FUSED_JUMPS
+
+      case OpCode::APPEND_STR:
+        AppendString(context, operands[0]);
+        break;
+
+      case OpCode::INCREMENT_INT:
+        ExecuteIncrement<op_type::Plus>(context, operands);
+        break;
+      case OpCode::DECREMENT_INT:
+        ExecuteIncrement<op_type::Minus>(context, operands);
+        break;
+
+      case OpCode::_END:
+        throw RuntimeError{utils::format("Unknown instruction at {}", pc)};
+    }
   }
 }
 
-void GoTo::Execute(ExecutionContext& context) const {
-  context.current_instruction = label_;
+void Disassemble(const InstructionsBlock& block, std::ostream& output) {
+  const auto& code = block.GetCode();
+  for (Label pc = 0; pc < code.size();) {
+    const auto op_code = static_cast<OpCode>(code[pc]);
+    const auto info = GetOpCodeInfo(op_code);
+
+    output << pc << ": " << info.name;
+    for (size_t i = 1; i <= info.operands_count; ++i) {
+      output << ' ' << code[pc + i];
+    }
+    output << '\n';
+
+    pc += GetInstructionSize(op_code);
+  }
 }
 
 }  // namespace interpreter::instructions
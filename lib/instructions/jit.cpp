@@ -0,0 +1,490 @@
+#include "interpreter/instructions/jit.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <unordered_map>
+
+#include "interpreter/instructions/operations.hpp"
+
+#if defined(__x86_64__) && defined(__unix__)
+#include <sys/mman.h>
+#define INTERPRETER_JIT_X86_64
+#endif
+
+namespace interpreter::instructions {
+
+namespace {
+
+// Encodings of the few x86-64 instructions the loops need. The register file
+// is addressed by rdi, the values go through eax, ecx, edx, xmm0 and xmm1,
+// which the callee doesn't have to preserve, so there is no prologue
+
+enum Gpr : std::uint8_t { EAX = 0, ECX = 1, EDX = 2 };
+enum Xmm : std::uint8_t { XMM0 = 0, XMM1 = 1 };
+
+// condition codes of jcc and setcc
+enum Condition : std::uint8_t {
+  ABOVE_OR_EQUAL = 0x3,
+  EQUAL = 0x4,
+  NOT_EQUAL = 0x5,
+  ABOVE = 0x7,
+  PARITY = 0xA,
+  NO_PARITY = 0xB,
+  LESS = 0xC,
+  GREATER_OR_EQUAL = 0xD,
+  LESS_OR_EQUAL = 0xE,
+  GREATER = 0xF,
+};
+
+[[nodiscard]] constexpr Condition Negate(Condition condition) noexcept {
+  return static_cast<Condition>(condition ^ 1);
+}
+
+template <OperationT Op>
+[[nodiscard]] consteval Condition GetIntCondition() noexcept {
+  if constexpr (std::is_same_v<Op, op_type::Equals>) {
+    return EQUAL;
+  } else if constexpr (std::is_same_v<Op, op_type::NotEquals>) {
+    return NOT_EQUAL;
+  } else if constexpr (std::is_same_v<Op, op_type::Less>) {
+    return LESS;
+  } else if constexpr (std::is_same_v<Op, op_type::Greater>) {
+    return GREATER;
+  } else if constexpr (std::is_same_v<Op, op_type::LessOrEq>) {
+    return LESS_OR_EQUAL;
+  } else {
+    static_assert(std::is_same_v<Op, op_type::GreaterOrEq>);
+    return GREATER_OR_EQUAL;
+  }
+}
+
+class Assembler {
+ public:
+  inline void Emit(std::initializer_list<std::uint8_t> bytes) {
+    code_.insert(code_.end(), bytes);
+  }
+
+  inline void Emit32(std::uint32_t value) {
+    for (size_t i = 0; i < sizeof(value); ++i) {
+      code_.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+  }
+
+  // The op code with the operand [rdi + offset of the register]
+  inline void EmitMemory(std::initializer_list<std::uint8_t> op_code,
+                         std::uint8_t reg, Register operand,
+                         size_t offset = 0) {
+    Emit(op_code);
+    code_.push_back(static_cast<std::uint8_t>(0x80 | (reg << 3) | 7));
+    Emit32(static_cast<std::uint32_t>(operand * CellLayout::kSize + offset));
+  }
+
+  inline void EmitTag(Register destination, Cell::Tag tag) {
+    EmitMemory({0xC6}, 0, destination, CellLayout::kTagOffset);
+    Emit({static_cast<std::uint8_t>(tag)});
+  }
+
+  // The target is resolved by Link
+  inline void EmitJump(std::initializer_list<std::uint8_t> op_code,
+                       Label target, bool is_exit = false) {
+    Emit(op_code);
+    jumps_.push_back({code_.size(), target, is_exit});
+    Emit32(0);
+  }
+
+  inline void EmitJump(Condition condition, Label target) {
+    EmitJump({0x0F, static_cast<std::uint8_t>(0x80 | condition)}, target);
+  }
+
+  // Leaves the native code even if the label is compiled
+  inline void EmitExitJump(Condition condition, Label label) {
+    EmitJump({0x0F, static_cast<std::uint8_t>(0x80 | condition)}, label,
+             true);
+  }
+
+  inline void EmitSet(Condition condition, Gpr destination) {
+    Emit({0x0F, static_cast<std::uint8_t>(0x90 | condition),
+          static_cast<std::uint8_t>(0xC0 | destination)});
+  }
+
+  // mov eax, label; ret
+  inline void EmitExit(Label label) {
+    Emit({0xB8});
+    Emit32(static_cast<std::uint32_t>(label));
+    Emit({0xC3});
+  }
+
+  // The jumps to the compiled labels go to their code, the others exit
+  void Link(const std::unordered_map<Label, size_t>& offsets) {
+    std::unordered_map<Label, size_t> exits;
+    for (const auto& [at, target, is_exit] : jumps_) {
+      size_t offset = 0;
+      const auto it = offsets.find(target);
+      if (!is_exit && it != offsets.end()) {
+        offset = it->second;
+      } else if (const auto exit = exits.find(target); exit != exits.end()) {
+        offset = exit->second;
+      } else {
+        offset = exits[target] = code_.size();
+        EmitExit(target);
+      }
+      const auto relative = static_cast<std::uint32_t>(offset - (at + 4));
+      std::memcpy(code_.data() + at, &relative, sizeof(relative));
+    }
+    jumps_.clear();
+  }
+
+  [[nodiscard]] inline size_t GetSize() const noexcept { return code_.size(); }
+  [[nodiscard]] inline const auto& GetCode() const noexcept { return code_; }
+
+ private:
+  struct Jump {
+    // position of the rel32
+    size_t at;
+    Label target;
+    bool is_exit;
+  };
+
+  std::vector<std::uint8_t> code_;
+  std::vector<Jump> jumps_;
+};
+
+void LoadInt(Assembler& assembler, Gpr destination, Register source) {
+  assembler.EmitMemory({0x8B}, destination, source);
+}
+
+void StoreInt(Assembler& assembler, Register destination, Gpr source) {
+  assembler.EmitMemory({0x89}, source, destination);
+  assembler.EmitTag(destination, Cell::Tag::INT);
+}
+
+void LoadBool(Assembler& assembler, Register source) {
+  // movzx eax, byte
+  assembler.EmitMemory({0x0F, 0xB6}, EAX, source);
+}
+
+void StoreBool(Assembler& assembler, Register destination) {
+  // mov byte, al
+  assembler.EmitMemory({0x88}, EAX, destination);
+  assembler.EmitTag(destination, Cell::Tag::BOOL);
+}
+
+// The ints are converted, the same way as the operations of the mixed types
+template <ValueT T>
+void LoadReal(Assembler& assembler, Xmm destination, Register source) {
+  if constexpr (std::is_same_v<T, types::Int>) {
+    // cvtsi2sd
+    assembler.EmitMemory({0xF2, 0x0F, 0x2A}, destination, source);
+  } else {
+    // movsd
+    assembler.EmitMemory({0xF2, 0x0F, 0x10}, destination, source);
+  }
+}
+
+void StoreReal(Assembler& assembler, Register destination) {
+  assembler.EmitMemory({0xF2, 0x0F, 0x11}, XMM0, destination);
+  assembler.EmitTag(destination, Cell::Tag::REAL);
+}
+
+// Compares xmm0 with xmm1 into al, the unordered values are not equal and
+// not ordered
+template <OperationT Op>
+void EmitRealComparison(Assembler& assembler) {
+  // ucomisd xmm0, xmm1 and ucomisd xmm1, xmm0 for the swapped operands
+  const auto compare = [&assembler] {
+    assembler.Emit({0x66, 0x0F, 0x2E, 0xC1});
+  };
+  const auto compare_swapped = [&assembler] {
+    assembler.Emit({0x66, 0x0F, 0x2E, 0xC8});
+  };
+
+  if constexpr (std::is_same_v<Op, op_type::Equals>) {
+    compare();
+    assembler.EmitSet(EQUAL, EAX);
+    assembler.EmitSet(NO_PARITY, ECX);
+    // and al, cl
+    assembler.Emit({0x20, 0xC8});
+  } else if constexpr (std::is_same_v<Op, op_type::NotEquals>) {
+    compare();
+    assembler.EmitSet(NOT_EQUAL, EAX);
+    assembler.EmitSet(PARITY, ECX);
+    // or al, cl
+    assembler.Emit({0x08, 0xC8});
+  } else if constexpr (std::is_same_v<Op, op_type::Less>) {
+    compare_swapped();
+    assembler.EmitSet(ABOVE, EAX);
+  } else if constexpr (std::is_same_v<Op, op_type::Greater>) {
+    compare();
+    assembler.EmitSet(ABOVE, EAX);
+  } else if constexpr (std::is_same_v<Op, op_type::LessOrEq>) {
+    compare_swapped();
+    assembler.EmitSet(ABOVE_OR_EQUAL, EAX);
+  } else {
+    static_assert(std::is_same_v<Op, op_type::GreaterOrEq>);
+    compare();
+    assembler.EmitSet(ABOVE_OR_EQUAL, EAX);
+  }
+}
+
+template <typename Op>
+inline constexpr bool kIsComparison =
+    std::is_same_v<Op, op_type::Equals> ||
+    std::is_same_v<Op, op_type::NotEquals> ||
+    std::is_same_v<Op, op_type::Less> ||
+    std::is_same_v<Op, op_type::Greater> ||
+    std::is_same_v<Op, op_type::LessOrEq> ||
+    std::is_same_v<Op, op_type::GreaterOrEq>;
+
+// Returns false for the operations which are left to the interpreter. The
+// divisions by zero exit at the label of the instruction, so the interpreter
+// throws the error.
+template <OperationT Op, ValueT L, ValueT R>
+bool CompileBinary(Assembler& assembler, const CodeUnit* operands,
+                   Label label) {
+  const Register destination = operands[0];
+  const Register lhs = operands[1];
+  const Register rhs = operands[2];
+
+  if constexpr (std::is_same_v<L, types::Str> ||
+                std::is_same_v<R, types::Str>) {
+    return false;
+  } else if constexpr (std::is_same_v<L, types::Int> &&
+                       std::is_same_v<R, types::Int>) {
+    LoadInt(assembler, EAX, lhs);
+    if constexpr (kIsComparison<Op>) {
+      // cmp eax, [rhs]
+      assembler.EmitMemory({0x3B}, EAX, rhs);
+      assembler.EmitSet(GetIntCondition<Op>(), EAX);
+      StoreBool(assembler, destination);
+      return true;
+    } else {
+      LoadInt(assembler, ECX, rhs);
+      if constexpr (std::is_same_v<Op, op_type::Plus>) {
+        assembler.Emit({0x01, 0xC8});
+      } else if constexpr (std::is_same_v<Op, op_type::Minus>) {
+        assembler.Emit({0x29, 0xC8});
+      } else if constexpr (std::is_same_v<Op, op_type::Mul>) {
+        assembler.Emit({0x0F, 0xAF, 0xC1});
+      } else {
+        static_assert(std::is_same_v<Op, op_type::Div> ||
+                      std::is_same_v<Op, op_type::Mod>);
+        // test ecx, ecx; cdq; idiv ecx
+        assembler.Emit({0x85, 0xC9});
+        assembler.EmitExitJump(EQUAL, label);
+        assembler.Emit({0x99, 0xF7, 0xF9});
+      }
+      StoreInt(assembler, destination,
+               std::is_same_v<Op, op_type::Mod> ? EDX : EAX);
+      return true;
+    }
+  } else {
+    LoadReal<L>(assembler, XMM0, lhs);
+    LoadReal<R>(assembler, XMM1, rhs);
+    if constexpr (kIsComparison<Op>) {
+      EmitRealComparison<Op>(assembler);
+      StoreBool(assembler, destination);
+    } else {
+      if constexpr (std::is_same_v<Op, op_type::Plus>) {
+        assembler.Emit({0xF2, 0x0F, 0x58, 0xC1});
+      } else if constexpr (std::is_same_v<Op, op_type::Minus>) {
+        assembler.Emit({0xF2, 0x0F, 0x5C, 0xC1});
+      } else if constexpr (std::is_same_v<Op, op_type::Mul>) {
+        assembler.Emit({0xF2, 0x0F, 0x59, 0xC1});
+      } else {
+        static_assert(std::is_same_v<Op, op_type::Div>);
+        // xorpd xmm2, xmm2; ucomisd xmm1, xmm2; jp over the exit
+        assembler.Emit({0x66, 0x0F, 0x57, 0xD2, 0x66, 0x0F, 0x2E, 0xCA});
+        assembler.Emit({0x7A, 0x06});
+        assembler.EmitExitJump(EQUAL, label);
+        assembler.Emit({0xF2, 0x0F, 0x5E, 0xC1});
+      }
+      StoreReal(assembler, destination);
+    }
+    return true;
+  }
+}
+
+template <OperationT Op, ValueT T>
+bool CompileUnary(Assembler& assembler, const CodeUnit* operands) {
+  const Register destination = operands[0];
+  const Register operand = operands[1];
+
+  if constexpr (std::is_same_v<T, types::Bool>) {
+    static_assert(std::is_same_v<Op, op_type::Not>);
+    LoadBool(assembler, operand);
+    // xor eax, 1
+    assembler.Emit({0x83, 0xF0, 0x01});
+    StoreBool(assembler, destination);
+  } else if constexpr (std::is_same_v<T, types::Int>) {
+    LoadInt(assembler, EAX, operand);
+    if constexpr (std::is_same_v<Op, op_type::UnaryMinus>) {
+      // neg eax
+      assembler.Emit({0xF7, 0xD8});
+    }
+    StoreInt(assembler, destination, EAX);
+  } else if constexpr (std::is_same_v<T, types::Real>) {
+    // the sign bit is flipped, so -0.0 is kept: mov rax; btc rax, 63
+    assembler.EmitMemory({0x48, 0x8B}, EAX, operand);
+    if constexpr (std::is_same_v<Op, op_type::UnaryMinus>) {
+      assembler.Emit({0x48, 0x0F, 0xBA, 0xF8, 0x3F});
+    }
+    assembler.EmitMemory({0x48, 0x89}, EAX, destination);
+    assembler.EmitTag(destination, Cell::Tag::REAL);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+template <ValueT L, ValueT R>
+bool CompileAssign(Assembler& assembler, const CodeUnit* operands) {
+  const Register destination = operands[0];
+  const Register source = operands[1];
+
+  if constexpr (std::is_same_v<L, types::Str>) {
+    return false;
+  } else if constexpr (std::is_same_v<L, types::Bool>) {
+    LoadBool(assembler, source);
+    StoreBool(assembler, destination);
+  } else if constexpr (std::is_same_v<L, types::Real>) {
+    LoadReal<R>(assembler, XMM0, source);
+    StoreReal(assembler, destination);
+  } else if constexpr (std::is_same_v<R, types::Real>) {
+    // truncated, as the conversion of C++: cvttsd2si eax
+    assembler.EmitMemory({0xF2, 0x0F, 0x2C}, EAX, source);
+    StoreInt(assembler, destination, EAX);
+  } else {
+    LoadInt(assembler, EAX, source);
+    StoreInt(assembler, destination, EAX);
+  }
+  return true;
+}
+
+bool CompileInstruction(Assembler& assembler, RegisterOpCode op_code,
+                        const CodeUnit* operands, Label label) {
+  // waiting for c++20 using enums
+  switch (op_code) {
+    case RegisterOpCode::GOTO:
+      assembler.EmitJump({0xE9}, operands[0]);
+      return true;
+    case RegisterOpCode::JUMP_FALSE:
+    case RegisterOpCode::JUMP_TRUE:
+      // cmp byte, 0
+      assembler.EmitMemory({0x80}, 7, operands[1]);
+      assembler.Emit({0x00});
+      assembler.EmitJump(
+          op_code == RegisterOpCode::JUMP_FALSE ? EQUAL : NOT_EQUAL,
+          operands[0]);
+      return true;
+
+#define CASE_BINARY(name, generic_name, op, lhs, rhs)                 \
+  case RegisterOpCode::name:                                          \
+    return CompileBinary<op_type::op, types::lhs, types::rhs>(        \
+        assembler, operands, label);
+#define CASE_UNARY(name, generic_name, op, type) \
+  case RegisterOpCode::name:                     \
+    return CompileUnary<op_type::op, types::type>(assembler, operands);
+#define CASE_ASSIGN(name, lhs, rhs) \
+  case RegisterOpCode::ASSIGN_##name: \
+    return CompileAssign<types::lhs, types::rhs>(assembler, operands);
+#define CASE_FUSED_JUMP(name, op, ...)                                  \
+  case RegisterOpCode::JUMP_FALSE_##name##_INT:                         \
+    LoadInt(assembler, EAX, operands[1]);                               \
+    assembler.EmitMemory({0x3B}, EAX, operands[2]);                     \
+    assembler.EmitJump(Negate(GetIntCondition<op_type::op>()),          \
+                       operands[0]);                                    \
+    return true;
+
+      INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(CASE_BINARY)
+      INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(CASE_UNARY)
+      INTERPRETER_SPECIALIZED_ASSIGNMENTS(CASE_ASSIGN)
+      INTERPRETER_FUSED_COMPARISONS(CASE_FUSED_JUMP)
+
+#undef CASE_BINARY
+#undef CASE_UNARY
+#undef CASE_ASSIGN
+#undef CASE_FUSED_JUMP
+
+    default:
+      // the strings, the input and the output stay in the interpreter
+      return false;
+  }
+}
+
+}  // namespace
+
+void JitCode::Unmap::operator()(std::uint8_t* memory) const noexcept {
+#ifdef INTERPRETER_JIT_X86_64
+  munmap(memory, size);
+#endif
+}
+
+JitCode::JitCode(std::unique_ptr<std::uint8_t, Unmap> memory,
+                 std::vector<Register> destinations)
+    : memory_{std::move(memory)}, destinations_{std::move(destinations)} {}
+
+Label JitCode::Run(Cell* registers) const {
+  // the interpreter could leave a string in a temporary register, the native
+  // code overwrites it without releasing
+  for (const auto destination : destinations_) {
+    if (registers[destination].GetTag() == Cell::Tag::STR) {
+      registers[destination].Reset();
+    }
+  }
+  return reinterpret_cast<Entry>(memory_.get())(registers);
+}
+
+std::optional<JitCode> CompileLoop(std::span<const CodeUnit> code,
+                                   Label header, Label end) {
+#ifndef INTERPRETER_JIT_X86_64
+  return std::nullopt;
+#else
+  Assembler assembler;
+  std::unordered_map<Label, size_t> offsets;
+  std::vector<Register> destinations;
+
+  size_t compiled_count = 0;
+  for (Label pc = header; pc < end;) {
+    const auto op_code = static_cast<RegisterOpCode>(code[pc]);
+    const auto info = GetRegisterOpCodeInfo(op_code);
+    offsets[pc] = assembler.GetSize();
+
+    if (CompileInstruction(assembler, op_code, &code[pc + 1], pc)) {
+      ++compiled_count;
+      if (info.has_destination) {
+        destinations.push_back(code[pc + 1]);
+      }
+    } else {
+      assembler.EmitExit(pc);
+    }
+    pc += GetRegisterInstructionSize(op_code);
+  }
+  if (compiled_count == 0) {
+    return std::nullopt;
+  }
+  assembler.EmitExit(end);
+  assembler.Link(offsets);
+
+  const auto& machine_code = assembler.GetCode();
+  void* memory = mmap(nullptr, machine_code.size(), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    return std::nullopt;
+  }
+  std::unique_ptr<std::uint8_t, JitCode::Unmap> executable{
+      static_cast<std::uint8_t*>(memory), {machine_code.size()}};
+  std::memcpy(memory, machine_code.data(), machine_code.size());
+  if (mprotect(memory, machine_code.size(), PROT_READ | PROT_EXEC) != 0) {
+    return std::nullopt;
+  }
+
+  std::sort(destinations.begin(), destinations.end());
+  destinations.erase(std::unique(destinations.begin(), destinations.end()),
+                     destinations.end());
+  return JitCode{std::move(executable), std::move(destinations)};
+#endif
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,150 @@
+#include <optional>
+#include <vector>
+
+#include "interpreter/instructions/passes.hpp"
+#include "interpreter/instructions/rewriter.hpp"
+
+namespace interpreter::instructions {
+
+namespace {
+
+bool IsConditionalJump(OpCode op_code) {
+  return op_code == OpCode::JUMP_FALSE || op_code == OpCode::JUMP_TRUE ||
+         op_code == OpCode::JUMP_FALSE_OR_POP ||
+         op_code == OpCode::JUMP_TRUE_OR_POP;
+}
+
+bool JumpsOnTrue(OpCode op_code) {
+  return op_code == OpCode::JUMP_TRUE || op_code == OpCode::JUMP_TRUE_OR_POP;
+}
+
+OpCode InvertJump(OpCode op_code) {
+  return op_code == OpCode::JUMP_FALSE ? OpCode::JUMP_TRUE : OpCode::JUMP_FALSE;
+}
+
+class JumpThreader {
+ public:
+  explicit JumpThreader(const Bytecode& bytecode)
+      : code_{bytecode.code},
+        is_jump_target_(code_.size()),
+        rewriter_{code_} {
+    ForEachInstruction(code_,
+                       [this](Label, OpCode op_code,
+                              std::span<const CodeUnit> operands) {
+                         if (GetOpCodeInfo(op_code).is_jump) {
+                           is_jump_target_[operands[0]] = true;
+                         }
+                       });
+  }
+
+  std::vector<CodeUnit> Run() && {
+    for (Label label = 0; label < code_.size();) {
+      label += Visit(label);
+    }
+    return std::move(rewriter_).Finish();
+  }
+
+ private:
+  // Returns size of the visited instructions
+  size_t Visit(Label label) {
+    const auto op_code = GetOpCode(label);
+    const auto size = GetInstructionSize(op_code);
+    const auto info = GetOpCodeInfo(op_code);
+    // the label is the first operand of the jumps
+    const auto target = info.is_jump ? code_[label + 1] : 0;
+
+    if (op_code == OpCode::NOP) {
+      rewriter_.Bind(label);
+    } else if (op_code == OpCode::GOTO) {
+      rewriter_.Bind(label);
+      const auto final_target = SkipGoto(target);
+      if (GetOpCode(final_target) == OpCode::HALT) {
+        rewriter_.Emit(OpCode::HALT);
+      } else {
+        rewriter_.Emit(OpCode::GOTO, {static_cast<CodeUnit>(final_target)});
+      }
+    } else if (op_code == OpCode::JUMP_FALSE ||
+               op_code == OpCode::JUMP_TRUE) {
+      // JUMP_FALSE L; GOTO M; L: -> JUMP_TRUE M; L:
+      const auto next = label + size;
+      if (next < code_.size() && GetOpCode(next) == OpCode::GOTO &&
+          !is_jump_target_[next] && target == next + 2) {
+        rewriter_.Bind(label);
+        rewriter_.Bind(next);
+        rewriter_.Emit(InvertJump(op_code),
+                       {static_cast<CodeUnit>(SkipGoto(code_[next + 1]))});
+        return size + GetInstructionSize(OpCode::GOTO);
+      }
+      rewriter_.Bind(label);
+      rewriter_.Emit(op_code, {static_cast<CodeUnit>(SkipGoto(target))});
+    } else if (op_code == OpCode::JUMP_FALSE_OR_POP ||
+               op_code == OpCode::JUMP_TRUE_OR_POP) {
+      rewriter_.Bind(label);
+      ThreadKnownCondition(op_code, target);
+    } else if (info.is_jump) {
+      rewriter_.Bind(label);
+      auto operands = std::vector<CodeUnit>(code_.begin() + label + 1,
+                                            code_.begin() + label + size);
+      operands[0] = static_cast<CodeUnit>(SkipGoto(target));
+      rewriter_.Emit(op_code, operands);
+    } else {
+      rewriter_.Copy(label);
+    }
+    return size;
+  }
+
+  // The jump is taken with the known condition on the stack, so the
+  // conditional jumps at the target are resolved at compile time:
+  // 'a and b and c' jumps to the end of the chain, 'while (a and b)' jumps
+  // to the loop exit.
+  void ThreadKnownCondition(OpCode op_code, Label target) {
+    const bool condition = JumpsOnTrue(op_code);
+    bool is_popped = false;
+    // every step moves forward or through GOTO, the bound avoids cycles
+    for (size_t step = 0; step < code_.size() && !is_popped; ++step) {
+      target = SkipGoto(target);
+      const auto target_op_code = GetOpCode(target);
+      if (!IsConditionalJump(target_op_code)) {
+        break;
+      }
+
+      const auto info = GetOpCodeInfo(target_op_code);
+      is_popped = !info.keeps_operand_on_jump;
+      if (JumpsOnTrue(target_op_code) == condition) {
+        target = code_[target + 1];
+      } else {
+        is_popped = true;
+        target += GetInstructionSize(target_op_code);
+      }
+    }
+
+    if (is_popped) {
+      op_code = condition ? OpCode::JUMP_TRUE : OpCode::JUMP_FALSE;
+    }
+    rewriter_.Emit(op_code, {static_cast<CodeUnit>(SkipGoto(target))});
+  }
+
+  Label SkipGoto(Label label) const {
+    for (size_t step = 0;
+         step < code_.size() && GetOpCode(label) == OpCode::GOTO; ++step) {
+      label = code_[label + 1];
+    }
+    return label;
+  }
+
+  OpCode GetOpCode(Label label) const {
+    return static_cast<OpCode>(code_[label]);
+  }
+
+  std::span<const CodeUnit> code_;
+  std::vector<bool> is_jump_target_;
+  CodeRewriter rewriter_;
+};
+
+}  // namespace
+
+void ThreadJumps(Bytecode& bytecode) {
+  bytecode.code = JumpThreader{bytecode}.Run();
+}
+
+}  // namespace interpreter::instructions
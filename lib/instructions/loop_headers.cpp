@@ -0,0 +1,29 @@
+#include "interpreter/instructions/passes.hpp"
+#include "interpreter/instructions/rewriter.hpp"
+
+namespace interpreter::instructions {
+
+std::vector<std::optional<Label>> StripLoopHeaders(Bytecode& bytecode) {
+  std::vector<std::optional<Label>> headers;
+  CodeRewriter rewriter{bytecode.code};
+
+  ForEachInstruction(
+      bytecode.code, [&](Label label, OpCode op_code, auto operands) {
+        if (op_code != OpCode::LOOP_HEADER) {
+          rewriter.Copy(label);
+          return;
+        }
+        // the jumps to the header land on the first instruction of the loop
+        rewriter.Bind(label);
+        const auto loop = operands[0];
+        if (loop >= headers.size()) {
+          headers.resize(loop + 1);
+        }
+        headers[loop] = rewriter.CurrentLabel();
+      });
+
+  bytecode.code = std::move(rewriter).Finish();
+  return headers;
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,17 @@
+#include "interpreter/instructions/passes.hpp"
+
+namespace interpreter::instructions {
+
+void OptimizeBytecode(Bytecode& bytecode) {
+  SpecializeTypes(bytecode);
+  // the removed jumps let the folding join more constants
+  for (size_t size = 0; size != bytecode.code.size();) {
+    size = bytecode.code.size();
+    FoldConstants(bytecode);
+    EliminateDeadCode(bytecode);
+  }
+  ThreadJumps(bytecode);
+  EliminateDeadCode(bytecode);
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,454 @@
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "interpreter/instructions/analysis.hpp"
+#include "interpreter/instructions/registers.hpp"
+#include "interpreter/instructions/specialization.hpp"
+#include "interpreter/utils/format.hpp"
+
+namespace interpreter::instructions {
+
+namespace {
+
+using ast::VariableType;
+
+template <ValueT T>
+inline constexpr VariableType TYPE_OF = ast::EnumByType<T>::value;
+
+RegisterOpCode ToRegisterOpCode(OpCode op_code) {
+#define TO_REGISTER_OPCODE(name, ...) \
+  if (op_code == OpCode::name) {      \
+    return RegisterOpCode::name;      \
+  }
+
+  INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(TO_REGISTER_OPCODE)
+  INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(TO_REGISTER_OPCODE)
+#undef TO_REGISTER_OPCODE
+
+  throw AnalysisError{"Instruction has no register form"};
+}
+
+RegisterOpCode GetRegisterWriteOpCode(VariableType type) {
+#define GET_WRITE(name, value_type)           \
+  if (type == TYPE_OF<types::value_type>) {   \
+    return RegisterOpCode::WRITE_##name;      \
+  }
+
+  INTERPRETER_VALUE_TYPES(GET_WRITE)
+#undef GET_WRITE
+
+  throw AnalysisError{"Unknown type of the value"};
+}
+
+RegisterOpCode GetRegisterReadOpCode(VariableType type) {
+#define GET_READ(name, value_type)            \
+  if (type == TYPE_OF<types::value_type>) {   \
+    return RegisterOpCode::READ_##name;       \
+  }
+
+  INTERPRETER_VALUE_TYPES(GET_READ)
+#undef GET_READ
+
+  throw AnalysisError{"Unknown type of the variable"};
+}
+
+// The comparison of ints followed by the conditional jump
+std::optional<RegisterOpCode> FindFusedJump(RegisterOpCode compare,
+                                            bool jump_on_true) {
+#define FIND_FUSED_JUMP(name, op, negation)                  \
+  if (compare == RegisterOpCode::name##_INT_INT) {           \
+    return jump_on_true ? RegisterOpCode::JUMP_FALSE_##negation##_INT \
+                        : RegisterOpCode::JUMP_FALSE_##name##_INT;    \
+  }
+
+  INTERPRETER_FUSED_COMPARISONS(FIND_FUSED_JUMP)
+#undef FIND_FUSED_JUMP
+
+  return std::nullopt;
+}
+
+// Value of the operand stack at the translation time: the register which
+// holds it, the instructions which use the value read the register directly
+struct Operand {
+  Register reg;
+  VariableType type;
+  // the variable is pushed by INVOKE_VARIABLE, it's read when the operand is
+  // used, so it's never copied to a temporary
+  bool is_lazy = false;
+
+  [[nodiscard]] inline constexpr bool operator==(
+      const Operand& other) const noexcept = default;
+};
+
+using StackState = std::vector<Operand>;
+
+// Walks the stack code once, simulating the operand stack. Values are not
+// copied until it's needed: the loads of the variables and the constants
+// become the operands of the instructions which use them. The temporaries are
+// allocated by the stack depth, so the value at depth i is always in the
+// temporary i at the jumps and the labels.
+class RegisterTranslator {
+ public:
+  explicit RegisterTranslator(const Bytecode& bytecode)
+      : bytecode_{bytecode},
+        is_jump_target_(bytecode.code.size()),
+        new_labels_(bytecode.code.size() + 1) {
+    const auto& layout = bytecode.frame_layout;
+#define ADD_BANK(name, type)                                          \
+  banks_[static_cast<size_t>(TYPE_OF<types::type>)] = registers_.size(); \
+  for (const auto& value : layout.GetInitialValues<types::type>()) {  \
+    registers_.emplace_back(types::type{value});                      \
+  }
+
+    INTERPRETER_VALUE_TYPES(ADD_BANK)
+#undef ADD_BANK
+
+    constants_begin_ = registers_.size();
+    for (const auto& constant : bytecode.constants) {
+      registers_.emplace_back(constant);
+    }
+    temporaries_begin_ = registers_.size();
+  }
+
+  void Run() {
+    const auto& code = bytecode_.code;
+    ForEachInstruction(code, [this](Label, OpCode op_code,
+                                    std::span<const CodeUnit> operands) {
+      if (GetOpCodeInfo(op_code).is_jump) {
+        is_jump_target_[operands[0]] = true;
+      }
+    });
+    ForEachInstruction(code, [this](Label label, OpCode op_code,
+                                    std::span<const CodeUnit> operands) {
+      Visit(label, op_code, operands);
+    });
+    new_labels_[code.size()] = code_.size();
+
+    for (const auto position : relocations_) {
+      code_[position] = new_labels_[code_[position]];
+    }
+    registers_.resize(temporaries_begin_ + temporaries_count_);
+  }
+
+  [[nodiscard]] std::vector<CodeUnit> TakeCode() { return std::move(code_); }
+  [[nodiscard]] std::vector<Cell> TakeRegisters() {
+    return std::move(registers_);
+  }
+
+ private:
+  void Visit(Label label, OpCode op_code, std::span<const CodeUnit> operands) {
+    if (is_jump_target_[label]) {
+      EnterLabel(label);
+    }
+    new_labels_[label] = code_.size();
+    if (!is_reachable_) {
+      return;
+    }
+
+    // waiting for c++20 using enums
+    switch (op_code) {
+      case OpCode::NOP:
+        break;
+      case OpCode::HALT:
+        Emit(RegisterOpCode::HALT);
+        is_reachable_ = false;
+        break;
+      case OpCode::READ: {
+        const Slot slot{static_cast<VariableType>(operands[0]), operands[1]};
+        const auto variable = GetVariable(slot);
+        Clobber(variable);
+        Emit(GetRegisterReadOpCode(slot.type), {variable});
+        break;
+      }
+      case OpCode::WRITE:
+        Write();
+        break;
+      case OpCode::POP:
+        Pop();
+        break;
+      case OpCode::INVOKE_CONSTANT:
+        Push({static_cast<Register>(constants_begin_ + operands[0]),
+              GetValueType(bytecode_.constants[operands[0]])});
+        break;
+      case OpCode::INVOKE_VARIABLE: {
+        const Slot slot{static_cast<VariableType>(operands[0]), operands[1]};
+        Push({GetVariable(slot), slot.type, true});
+        break;
+      }
+      case OpCode::GOTO:
+        Jump(RegisterOpCode::GOTO, operands[0]);
+        is_reachable_ = false;
+        break;
+      case OpCode::JUMP_FALSE:
+      case OpCode::JUMP_TRUE:
+        ConditionalJump(op_code == OpCode::JUMP_TRUE, operands[0]);
+        break;
+      case OpCode::JUMP_FALSE_OR_POP:
+      case OpCode::JUMP_TRUE_OR_POP:
+        // the condition is the result if the jump is taken
+        Materialize(stack_.size() - 1);
+        Jump(op_code == OpCode::JUMP_TRUE_OR_POP ? RegisterOpCode::JUMP_TRUE
+                                                 : RegisterOpCode::JUMP_FALSE,
+             operands[0], {stack_.back().reg});
+        Pop();
+        break;
+      case OpCode::APPEND_STR: {
+        const auto variable = GetVariable({VariableType::STR, operands[0]});
+        if (stack_.back().reg == variable) {
+          // s = s + s, the variable is changed while it's read
+          Materialize(stack_.size() - 1);
+        }
+        const auto value = Pop();
+        Clobber(variable);
+        Emit(RegisterOpCode::APPEND_STR, {variable, value.reg});
+        break;
+      }
+
+#define CASE_TYPED(name, type)                                        \
+  case OpCode::LOAD_##name:                                           \
+    Push({GetVariable({TYPE_OF<types::type>, operands[0]}),           \
+          TYPE_OF<types::type>});                                     \
+    break;                                                            \
+  case OpCode::WRITE_##name:                                          \
+    Write();                                                          \
+    break;
+#define CASE_ASSIGN(name, lhs, rhs)                                   \
+  case OpCode::ASSIGN_##name:                                         \
+    Assign(RegisterOpCode::ASSIGN_##name,                             \
+           {TYPE_OF<types::lhs>, operands[0]}, TYPE_OF<types::rhs>);  \
+    break;
+
+        INTERPRETER_VALUE_TYPES(CASE_TYPED)
+        INTERPRETER_SPECIALIZED_ASSIGNMENTS(CASE_ASSIGN)
+
+#undef CASE_TYPED
+#undef CASE_ASSIGN
+
+      default: {
+        const auto info = GetOpCodeInfo(op_code);
+        if (op_code != OpCode::ASSIGN && info.operands_count == 0 &&
+            info.pushes == 1 && info.pops == 2) {
+          Binary(op_code);
+        } else if (info.operands_count == 0 && info.pushes == 1 &&
+                   info.pops == 1) {
+          Unary(op_code);
+        } else {
+          throw AnalysisError{
+              utils::format("Instruction {} at {} has no register form",
+                            std::string{info.name}, label)};
+        }
+      }
+    }
+  }
+
+  void Binary(OpCode op_code) {
+    const auto rhs = Pop();
+    const auto lhs = Pop();
+    const auto specialization =
+        FindBinarySpecialization(GetGenericOpCode(op_code), lhs.type, rhs.type);
+    if (!specialization) {
+      throw AnalysisError{"Operation is not defined for the operands types"};
+    }
+    const auto result = GetTemporary(stack_.size());
+    Emit(ToRegisterOpCode(specialization->op_code),
+         {result, lhs.reg, rhs.reg});
+    Push({result, specialization->result_type});
+  }
+
+  void Unary(OpCode op_code) {
+    const auto operand = Pop();
+    const auto specialization =
+        FindUnarySpecialization(GetGenericOpCode(op_code), operand.type);
+    if (!specialization) {
+      throw AnalysisError{"Operation is not defined for the operand type"};
+    }
+    const auto result = GetTemporary(stack_.size());
+    Emit(ToRegisterOpCode(specialization->op_code), {result, operand.reg});
+    Push({result, specialization->result_type});
+  }
+
+  void Assign(RegisterOpCode op_code, Slot slot, VariableType value_type) {
+    const auto value = Pop();
+    const auto variable = GetVariable(slot);
+    Clobber(variable);
+    if (slot.type == value_type && IsLastResult(value.reg)) {
+      // x = a + b: the operation writes the variable directly
+      code_[*last_ + 1] = variable;
+    } else {
+      Emit(slot.type == value_type ? RegisterOpCode::MOVE : op_code,
+           {variable, value.reg});
+    }
+    Push({variable, slot.type});
+  }
+
+  void Write() {
+    const auto value = Pop();
+    Emit(GetRegisterWriteOpCode(value.type), {value.reg});
+  }
+
+  void ConditionalJump(bool jump_on_true, Label target) {
+    const auto condition = Pop();
+    if (IsLastResult(condition.reg)) {
+      const auto compare = static_cast<RegisterOpCode>(code_[*last_]);
+      if (const auto fused = FindFusedJump(compare, jump_on_true)) {
+        const CodeUnit lhs = code_[*last_ + 2];
+        const CodeUnit rhs = code_[*last_ + 3];
+        code_.resize(*last_);
+        last_ = std::nullopt;
+        Jump(*fused, target, {lhs, rhs});
+        return;
+      }
+    }
+    Jump(jump_on_true ? RegisterOpCode::JUMP_TRUE : RegisterOpCode::JUMP_FALSE,
+         target, {condition.reg});
+  }
+
+  // The operands are emitted after the label
+  void Jump(RegisterOpCode op_code, Label target,
+            std::initializer_list<CodeUnit> operands = {}) {
+    PrepareJump(target);
+    const auto position = code_.size();
+    code_.push_back(static_cast<CodeUnit>(op_code));
+    relocations_.push_back(code_.size());
+    code_.push_back(static_cast<CodeUnit>(target));
+    code_.insert(code_.end(), operands);
+    last_ = position;
+  }
+
+  // Brings the stack to the state expected at the target
+  void PrepareJump(Label target) {
+    if (auto it = label_states_.find(target); it != label_states_.end()) {
+      Reconcile(it->second);
+      return;
+    }
+    for (size_t i = 0; i < stack_.size(); ++i) {
+      // the variable may be changed on the other path to the target
+      if (!stack_[i].is_lazy && stack_[i].reg < constants_begin_) {
+        Materialize(i);
+      }
+    }
+    label_states_.emplace(target, stack_);
+  }
+
+  void EnterLabel(Label label) {
+    auto it = label_states_.find(label);
+    if (is_reachable_) {
+      if (it == label_states_.end()) {
+        label_states_.emplace(label, stack_);
+      } else {
+        Reconcile(it->second);
+      }
+    } else {
+      // without the recorded state the label is reached only by the backward
+      // jumps, the loops start with the empty stack
+      stack_ = it != label_states_.end() ? it->second : StackState{};
+      label_states_.try_emplace(label, stack_);
+      is_reachable_ = true;
+    }
+    last_ = std::nullopt;
+  }
+
+  void Reconcile(const StackState& expected) {
+    if (expected.size() != stack_.size()) {
+      throw AnalysisError{"Inconsistent stack depth at the jump"};
+    }
+    for (size_t i = 0; i < stack_.size(); ++i) {
+      if (stack_[i] == expected[i]) {
+        continue;
+      }
+      if (expected[i].reg != GetTemporary(i)) {
+        throw AnalysisError{"Inconsistent operands at the jump"};
+      }
+      Materialize(i);
+    }
+  }
+
+  // Copies the value at the depth to its temporary
+  void Materialize(size_t depth) {
+    auto& operand = stack_[depth];
+    const auto temporary = GetTemporary(depth);
+    if (operand.reg != temporary) {
+      Emit(RegisterOpCode::MOVE, {temporary, operand.reg});
+      operand = {temporary, operand.type};
+    }
+  }
+
+  // The loaded values of the variable keep the value before the change
+  void Clobber(Register variable) {
+    for (size_t i = 0; i < stack_.size(); ++i) {
+      if (stack_[i].reg == variable && !stack_[i].is_lazy) {
+        Materialize(i);
+      }
+    }
+  }
+
+  [[nodiscard]] bool IsLastResult(Register reg) const {
+    if (!last_ || reg != GetTemporary(stack_.size())) {
+      return false;
+    }
+    const auto info =
+        GetRegisterOpCodeInfo(static_cast<RegisterOpCode>(code_[*last_]));
+    return info.has_destination && code_[*last_ + 1] == reg;
+  }
+
+  void Emit(RegisterOpCode op_code,
+            std::initializer_list<CodeUnit> operands = {}) {
+    last_ = code_.size();
+    code_.push_back(static_cast<CodeUnit>(op_code));
+    code_.insert(code_.end(), operands);
+  }
+
+  void Push(Operand operand) {
+    stack_.push_back(operand);
+    temporaries_count_ = std::max(temporaries_count_, stack_.size());
+  }
+
+  Operand Pop() {
+    if (stack_.empty()) {
+      throw AnalysisError{"Operand stack underflow"};
+    }
+    const auto operand = stack_.back();
+    stack_.pop_back();
+    return operand;
+  }
+
+  [[nodiscard]] Register GetVariable(Slot slot) const {
+    return static_cast<Register>(banks_[static_cast<size_t>(slot.type)] +
+                                 slot.index);
+  }
+
+  [[nodiscard]] Register GetTemporary(size_t depth) const {
+    return static_cast<Register>(temporaries_begin_ + depth);
+  }
+
+  const Bytecode& bytecode_;
+  std::vector<bool> is_jump_target_;
+  std::unordered_map<Label, StackState> label_states_;
+  std::vector<Label> new_labels_;
+  std::vector<size_t> relocations_;
+
+  std::array<size_t, static_cast<size_t>(VariableType::_END)> banks_{};
+  size_t constants_begin_ = 0;
+  size_t temporaries_begin_ = 0;
+  size_t temporaries_count_ = 0;
+  std::vector<Cell> registers_;
+
+  std::vector<CodeUnit> code_;
+  // the last instruction after the last label, its result may be redirected
+  std::optional<size_t> last_;
+  StackState stack_;
+  bool is_reachable_ = true;
+};
+
+}  // namespace
+
+RegisterBlock::RegisterBlock(const Bytecode& bytecode) {
+  RegisterTranslator translator{bytecode};
+  translator.Run();
+  code_ = translator.TakeCode();
+  registers_ = translator.TakeRegisters();
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,222 @@
+#include "interpreter/instructions/registers.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+#include "interpreter/instructions/jit.hpp"
+#include "interpreter/instructions/operations.hpp"
+#include "interpreter/utils/format.hpp"
+
+namespace interpreter::instructions {
+
+namespace {
+
+// Types of the registers are proven by the translation of the specialized
+// code, so the tags of the cells are not checked
+
+template <OperationT Op, ValueT L, ValueT R>
+void ExecuteBinary(Cell* registers, const CodeUnit* operands) {
+  registers[operands[0]].Set(details::Rule<Op, L, R>{}(
+      registers[operands[1]].Get<L>(), registers[operands[2]].Get<R>()));
+}
+
+template <OperationT Op, ValueT T>
+void ExecuteUnary(Cell* registers, const CodeUnit* operands) {
+  registers[operands[0]].Set(
+      details::Rule<Op, T>{}(registers[operands[1]].Get<T>()));
+}
+
+template <ValueT L, ValueT R>
+void ExecuteAssign(Cell* registers, const CodeUnit* operands) {
+  L value{};
+  details::Rule<op_type::Assign, L&, R>{}(value,
+                                          registers[operands[1]].Get<R>());
+  registers[operands[0]].Set(std::move(value));
+}
+
+// The buffer is reused if the string isn't shared with other registers
+void AppendString(Cell* registers, const CodeUnit* operands) {
+  auto& variable = registers[operands[0]];
+  auto value = variable.Take<types::Str>();
+  value += registers[operands[1]].Get<types::Str>();
+  variable.Set(std::move(value));
+}
+
+template <ValueT T>
+void ReadValue(ExecutionContext& context, Cell& variable) {
+  auto value = variable.Take<T>();
+  context.input >> value;
+  variable.Set(std::move(value));
+}
+
+template <OperationT Op>
+bool CompareInts(const Cell* registers, const CodeUnit* operands) {
+  return details::Rule<Op, types::Int, types::Int>{}(
+      registers[operands[1]].Get<types::Int>(),
+      registers[operands[2]].Get<types::Int>());
+}
+
+// Counts the backward jumps to the headers of the loops and runs the hot
+// loops natively
+class HotLoops {
+ public:
+  HotLoops(std::span<const CodeUnit> code, std::optional<JitOptions> options)
+      : code_{code}, options_{options} {}
+
+  [[nodiscard]] inline bool IsEnabled() const noexcept {
+    return options_.has_value();
+  }
+
+  // Returns the label where the interpretation continues
+  Label Enter(Label header, Cell* registers) {
+    auto& loop = loops_[header];
+    if (!loop.code) {
+      if (loop.is_rejected ||
+          loop.iterations++ < options_->hot_loop_iterations) {
+        return header;
+      }
+      loop.code = CompileLoop(code_, header, FindEnd(header));
+      if (!loop.code) {
+        loop.is_rejected = true;
+        return header;
+      }
+    }
+    return loop.code->Run(registers);
+  }
+
+ private:
+  struct Loop {
+    size_t iterations = 0;
+    bool is_rejected = false;
+    std::optional<JitCode> code;
+  };
+
+  // The loop ends after the last jump back to its header, continue jumps
+  // back from the middle of the body
+  Label FindEnd(Label header) const {
+    Label end = header;
+    for (Label pc = header; pc < code_.size();) {
+      const auto op_code = static_cast<RegisterOpCode>(code_[pc]);
+      const auto next = pc + GetRegisterInstructionSize(op_code);
+      if (GetRegisterOpCodeInfo(op_code).is_jump && code_[pc + 1] == header) {
+        end = next;
+      }
+      pc = next;
+    }
+    return end;
+  }
+
+  std::span<const CodeUnit> code_;
+  std::optional<JitOptions> options_;
+  std::unordered_map<Label, Loop> loops_;
+};
+
+}  // namespace
+
+void RegisterBlock::Execute(ExecutionContext& context,
+                            std::optional<JitOptions> jit) const {
+  const auto register_file = std::make_unique<Cell[]>(registers_.size());
+  std::copy(registers_.begin(), registers_.end(), register_file.get());
+  Resume(context, {register_file.get(), registers_.size()}, 0, jit);
+}
+
+void RegisterBlock::Resume(ExecutionContext& context,
+                           std::span<Cell> register_file, Label pc,
+                           std::optional<JitOptions> jit) const {
+  Cell* const registers = register_file.data();
+  const CodeUnit* const code = code_.data();
+
+  HotLoops hot_loops{code_, jit};
+  const auto jump = [&](Label label) {
+    pc = label < pc && hot_loops.IsEnabled() ? hot_loops.Enter(label, registers)
+                                             : label;
+  };
+
+  for (;;) {
+    const auto op_code = static_cast<RegisterOpCode>(code[pc]);
+    const CodeUnit* const operands = code + pc + 1;
+    pc += GetRegisterInstructionSize(op_code);
+
+    // waiting for c++20 using enums
+    switch (op_code) {
+      case RegisterOpCode::HALT:
+        return;
+      case RegisterOpCode::MOVE:
+        registers[operands[0]] = registers[operands[1]];
+        break;
+      case RegisterOpCode::GOTO:
+        jump(operands[0]);
+        break;
+      case RegisterOpCode::JUMP_FALSE:
+        if (!registers[operands[1]].Get<types::Bool>()) jump(operands[0]);
+        break;
+      case RegisterOpCode::JUMP_TRUE:
+        if (registers[operands[1]].Get<types::Bool>()) jump(operands[0]);
+        break;
+      case RegisterOpCode::APPEND_STR:
+        AppendString(registers, operands);
+        break;
+
+#define CASE_TYPED(name, type)                                          \
+  case RegisterOpCode::READ_##name:                                     \
+    ReadValue<types::type>(context, registers[operands[0]]);            \
+    break;                                                              \
+  case RegisterOpCode::WRITE_##name:                                    \
+    context.output << registers[operands[0]].Get<types::type>();        \
+    break;
+#define CASE_BINARY(name, generic_name, op, lhs, rhs)                   \
+  case RegisterOpCode::name:                                            \
+    ExecuteBinary<op_type::op, types::lhs, types::rhs>(registers,       \
+                                                       operands);       \
+    break;
+#define CASE_UNARY(name, generic_name, op, type)                        \
+  case RegisterOpCode::name:                                            \
+    ExecuteUnary<op_type::op, types::type>(registers, operands);        \
+    break;
+#define CASE_ASSIGN(name, lhs, rhs)                                     \
+  case RegisterOpCode::ASSIGN_##name:                                   \
+    ExecuteAssign<types::lhs, types::rhs>(registers, operands);         \
+    break;
+#define CASE_FUSED_JUMP(name, op, ...)                                  \
+  case RegisterOpCode::JUMP_FALSE_##name##_INT:                         \
+    if (!CompareInts<op_type::op>(registers, operands)) {               \
+      jump(operands[0]);                                                \
+    }                                                                   \
+    break;
+
+        INTERPRETER_VALUE_TYPES(CASE_TYPED)
+        INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(CASE_BINARY)
+        INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(CASE_UNARY)
+        INTERPRETER_SPECIALIZED_ASSIGNMENTS(CASE_ASSIGN)
+        INTERPRETER_FUSED_COMPARISONS(CASE_FUSED_JUMP)
+
+#undef CASE_TYPED
+#undef CASE_BINARY
+#undef CASE_UNARY
+#undef CASE_ASSIGN
+#undef CASE_FUSED_JUMP
+
+      case RegisterOpCode::_END:
+        throw RuntimeError{utils::format("Unknown instruction at {}", pc)};
+    }
+  }
+}
+
+void Disassemble(const RegisterBlock& block, std::ostream& output) {
+  const auto& code = block.GetCode();
+  for (Label pc = 0; pc < code.size();) {
+    const auto op_code = static_cast<RegisterOpCode>(code[pc]);
+    const auto info = GetRegisterOpCodeInfo(op_code);
+
+    output << pc << ": " << info.name;
+    for (size_t i = 1; i <= info.operands_count; ++i) {
+      output << ' ' << code[pc + i];
+    }
+    output << '\n';
+
+    pc += GetRegisterInstructionSize(op_code);
+  }
+}
+
+}  // namespace interpreter::instructions
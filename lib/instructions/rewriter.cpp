@@ -0,0 +1,43 @@
+#include "interpreter/instructions/rewriter.hpp"
+
+namespace interpreter::instructions {
+
+CodeRewriter::CodeRewriter(std::span<const CodeUnit> old_code)
+    : old_code_{old_code}, relocations_(old_code.size() + 1) {}
+
+void CodeRewriter::Bind(Label old_label) {
+  relocations_[old_label] = code_.size();
+}
+
+void CodeRewriter::Emit(OpCode op_code,
+                        std::initializer_list<CodeUnit> operands) {
+  code_.push_back(static_cast<CodeUnit>(op_code));
+  code_.insert(code_.end(), operands);
+}
+
+void CodeRewriter::Emit(OpCode op_code, std::span<const CodeUnit> operands) {
+  code_.push_back(static_cast<CodeUnit>(op_code));
+  code_.insert(code_.end(), operands.begin(), operands.end());
+}
+
+void CodeRewriter::Copy(Label old_label) {
+  Bind(old_label);
+  const auto size =
+      GetInstructionSize(static_cast<OpCode>(old_code_[old_label]));
+  const auto instruction = old_code_.subspan(old_label, size);
+  code_.insert(code_.end(), instruction.begin(), instruction.end());
+}
+
+std::vector<CodeUnit> CodeRewriter::Finish() && {
+  relocations_.back() = code_.size();
+
+  ForEachInstruction(code_, [this](Label label, OpCode op_code, auto) {
+    if (GetOpCodeInfo(op_code).is_jump) {
+      auto& jump_label = code_[label + 1];
+      jump_label = static_cast<CodeUnit>(relocations_[jump_label]);
+    }
+  });
+  return std::move(code_);
+}
+
+}  // namespace interpreter::instructions
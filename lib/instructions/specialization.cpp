@@ -0,0 +1,488 @@
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "interpreter/instructions/passes.hpp"
+#include "interpreter/instructions/rewriter.hpp"
+#include "interpreter/instructions/specialization.hpp"
+#include "interpreter/utils/format.hpp"
+
+namespace interpreter::instructions {
+
+namespace {
+
+using ast::VariableType;
+
+template <ValueT T>
+inline constexpr VariableType TYPE_OF = ast::EnumByType<T>::value;
+
+template <OperationT Op, ValueT... Types>
+consteval VariableType GetResultType() {
+  using Result = decltype(details::Rule<Op, Types...>{}(
+      std::declval<const Types&>()...));
+  return TYPE_OF<std::decay_t<Result>>;
+}
+
+}  // namespace
+
+std::optional<Specialization> FindBinarySpecialization(OpCode generic,
+                                                       VariableType lhs,
+                                                       VariableType rhs) {
+#define FIND_BINARY(name, generic_name, op, lhs_type, rhs_type)      \
+  if (generic == OpCode::generic_name &&                             \
+      lhs == TYPE_OF<types::lhs_type> &&                             \
+      rhs == TYPE_OF<types::rhs_type>) {                             \
+    return Specialization{                                           \
+        OpCode::name,                                                \
+        GetResultType<op_type::op, types::lhs_type, types::rhs_type>()}; \
+  }
+
+  INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(FIND_BINARY)
+#undef FIND_BINARY
+
+  return std::nullopt;
+}
+
+std::optional<Specialization> FindUnarySpecialization(OpCode generic,
+                                                      VariableType type) {
+#define FIND_UNARY(name, generic_name, op, value_type)                       \
+  if (generic == OpCode::generic_name && type == TYPE_OF<types::value_type>) { \
+    return Specialization{OpCode::name,                                      \
+                          GetResultType<op_type::op, types::value_type>()};  \
+  }
+
+  INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(FIND_UNARY)
+#undef FIND_UNARY
+
+  return std::nullopt;
+}
+
+std::optional<OpCode> FindAssignSpecialization(VariableType variable,
+                                               VariableType value) {
+#define FIND_ASSIGN(name, variable_type, value_type)    \
+  if (variable == TYPE_OF<types::variable_type> &&      \
+      value == TYPE_OF<types::value_type>) {            \
+    return OpCode::ASSIGN_##name;                       \
+  }
+
+  INTERPRETER_SPECIALIZED_ASSIGNMENTS(FIND_ASSIGN)
+#undef FIND_ASSIGN
+
+  return std::nullopt;
+}
+
+OpCode GetGenericOpCode(OpCode op_code) {
+#define GET_GENERIC(name, generic_name, ...) \
+  if (op_code == OpCode::name) {              \
+    return OpCode::generic_name;              \
+  }
+
+  INTERPRETER_SPECIALIZED_BINARY_OPERATIONS(GET_GENERIC)
+  INTERPRETER_SPECIALIZED_UNARY_OPERATIONS(GET_GENERIC)
+#undef GET_GENERIC
+
+  return op_code;
+}
+
+VariableType GetValueType(const Value& value) {
+  return std::visit([]<typename T>(const T&) { return TYPE_OF<T>; }, value);
+}
+
+namespace {
+
+OpCode GetLoadOpCode(VariableType type) {
+#define GET_LOAD(name, value_type)                \
+  if (type == TYPE_OF<types::value_type>) {       \
+    return OpCode::LOAD_##name;                   \
+  }
+
+  INTERPRETER_VALUE_TYPES(GET_LOAD)
+#undef GET_LOAD
+
+  throw AnalysisError{"Unknown type of the variable"};
+}
+
+OpCode GetWriteOpCode(VariableType type) {
+#define GET_WRITE(name, value_type)               \
+  if (type == TYPE_OF<types::value_type>) {       \
+    return OpCode::WRITE_##name;                  \
+  }
+
+  INTERPRETER_VALUE_TYPES(GET_WRITE)
+#undef GET_WRITE
+
+  throw AnalysisError{"Unknown type of the value"};
+}
+
+bool IsBinaryOperation(const OpCodeInfo& info) {
+  return info.pops == 2 && info.pushes == 1 && info.operands_count == 0;
+}
+
+bool IsUnaryOperation(const OpCodeInfo& info) {
+  return info.pops == 1 && info.pushes == 1 && info.operands_count == 0;
+}
+
+struct StackEntry {
+  VariableType type;
+  // label of the INVOKE_VARIABLE which pushed the reference
+  std::optional<Label> variable;
+  // label of the INVOKE_VARIABLE of the string which is the left operand of
+  // the concatenations which produced the value: s + a + b
+  std::optional<Label> concatenated;
+
+  [[nodiscard]] inline constexpr bool operator==(
+      const StackEntry& other) const noexcept = default;
+};
+
+using StackState = std::vector<StackEntry>;
+
+// How the reference pushed by INVOKE_VARIABLE is used, ordered by priority
+enum class VariableUse {
+  VALUE,
+  ASSIGN_TARGET,
+  // the variable is changed before the operand is used, so the operand
+  // must be read lazily through the reference
+  LAZY_REFERENCE,
+};
+
+class TypeInference {
+ public:
+  explicit TypeInference(const Bytecode& bytecode)
+      : bytecode_{bytecode}, states_(bytecode.code.size()) {}
+
+  void Run() {
+    if (!bytecode_.code.empty()) {
+      Merge(0, {});
+    }
+
+    while (!labels_to_visit_.empty()) {
+      const auto label = labels_to_visit_.back();
+      labels_to_visit_.pop_back();
+      Visit(label);
+    }
+  }
+
+  [[nodiscard]] const std::optional<StackState>& GetState(Label label) const {
+    return states_[label];
+  }
+
+  [[nodiscard]] std::optional<VariableUse> GetUse(Label label) const {
+    if (auto it = uses_.find(label); it != uses_.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] bool IsLazy(const StackEntry& entry) const {
+    return entry.variable &&
+           GetUse(*entry.variable) == VariableUse::LAZY_REFERENCE;
+  }
+
+  [[nodiscard]] Slot GetVariableSlot(Label invoke_label) const {
+    const auto& code = bytecode_.code;
+    return {static_cast<VariableType>(code[invoke_label + 1]),
+            code[invoke_label + 2]};
+  }
+
+ private:
+  void Visit(Label label) {
+    const auto& code = bytecode_.code;
+    const auto op_code = static_cast<OpCode>(code[label]);
+    const auto info = GetOpCodeInfo(op_code);
+    auto state = *states_[label];
+
+    const auto pop = [&state]() {
+      auto entry = state.back();
+      state.pop_back();
+      return entry;
+    };
+
+    switch (op_code) {
+      case OpCode::NOP:
+      case OpCode::HALT:
+      case OpCode::LOOP_HEADER:
+      case OpCode::GOTO:
+        break;
+      case OpCode::READ:
+        Clobber(state, {static_cast<VariableType>(code[label + 1]),
+                        code[label + 2]});
+        break;
+      case OpCode::WRITE:
+      case OpCode::POP:
+        Consume(pop());
+        break;
+      case OpCode::JUMP_FALSE:
+      case OpCode::JUMP_TRUE:
+      case OpCode::JUMP_FALSE_OR_POP:
+      case OpCode::JUMP_TRUE_OR_POP: {
+        const auto condition = pop();
+        if (condition.type != VariableType::BOOL) {
+          throw TypeError{utils::format(
+              "Condition at {} should be boolean expression", label)};
+        }
+        Consume(condition);
+        break;
+      }
+      case OpCode::INVOKE_CONSTANT:
+        state.push_back({GetValueType(bytecode_.constants[code[label + 1]])});
+        break;
+      case OpCode::INVOKE_VARIABLE:
+        state.push_back({GetVariableSlot(label).type, label});
+        break;
+      case OpCode::ASSIGN: {
+        const auto value = pop();
+        const auto variable = pop();
+        if (!variable.variable) {
+          throw TypeError{
+              utils::format("Only variable can be assigned at {}", label)};
+        }
+        if (!FindAssignSpecialization(variable.type, value.type)) {
+          throw TypeError{
+              utils::format("Incompatible types of assignment at {}", label)};
+        }
+        MarkUse(*variable.variable, VariableUse::ASSIGN_TARGET);
+        Consume(value);
+        Clobber(state, GetVariableSlot(*variable.variable));
+        state.push_back({variable.type});
+        break;
+      }
+      default:
+        if (IsBinaryOperation(info)) {
+          const auto rhs = pop();
+          const auto lhs = pop();
+          const auto specialization =
+              FindBinarySpecialization(op_code, lhs.type, rhs.type);
+          if (!specialization) {
+            throw TypeError{utils::format(
+                "Operation {} at {} is not defined for the operands types",
+                std::string{info.name}, label)};
+          }
+          Consume(lhs);
+          Consume(rhs);
+          std::optional<Label> concatenated;
+          if (specialization->op_code == OpCode::PLUS_STR_STR) {
+            concatenated = lhs.variable ? lhs.variable : lhs.concatenated;
+          }
+          state.push_back({specialization->result_type, std::nullopt,
+                           concatenated});
+        } else if (IsUnaryOperation(info)) {
+          const auto operand = pop();
+          const auto specialization =
+              FindUnarySpecialization(op_code, operand.type);
+          if (!specialization) {
+            throw TypeError{utils::format(
+                "Operation {} at {} is not defined for the operand type",
+                std::string{info.name}, label)};
+          }
+          Consume(operand);
+          state.push_back({specialization->result_type});
+        } else {
+          throw AnalysisError{utils::format(
+              "Unexpected instruction {} at {}", std::string{info.name},
+              label)};
+        }
+    }
+
+    if (info.is_jump) {
+      auto jump_state = state;
+      if (info.keeps_operand_on_jump) {
+        // the condition is already read as a value
+        jump_state.push_back({VariableType::BOOL});
+      }
+      Merge(code[label + 1], std::move(jump_state));
+    }
+    if (info.falls_through) {
+      Merge(label + GetInstructionSize(op_code), std::move(state));
+    }
+  }
+
+  void Merge(Label label, StackState state) {
+    auto& current = states_.at(label);
+    if (!current) {
+      current = std::move(state);
+      labels_to_visit_.push_back(label);
+      return;
+    }
+    if (*current == state) {
+      return;
+    }
+
+    if (current->size() != state.size()) {
+      throw AnalysisError{
+          utils::format("Inconsistent stack depth at {}", label)};
+    }
+    for (size_t i = 0; i < state.size(); ++i) {
+      auto& entry = (*current)[i];
+      if (entry.type != state[i].type) {
+        throw TypeError{utils::format("Inconsistent types at {}", label)};
+      }
+      if (entry.variable != state[i].variable) {
+        // different variables can't be used as a reference after the merge
+        Consume(entry);
+        Consume(state[i]);
+        entry.variable = std::nullopt;
+      }
+      if (entry.concatenated != state[i].concatenated) {
+        entry.concatenated = std::nullopt;
+      }
+    }
+    labels_to_visit_.push_back(label);
+  }
+
+  void Consume(const StackEntry& entry) {
+    if (entry.variable) {
+      MarkUse(*entry.variable, VariableUse::VALUE);
+    }
+  }
+
+  void Clobber(const StackState& state, Slot slot) {
+    for (const auto& entry : state) {
+      if (entry.variable && GetVariableSlot(*entry.variable) == slot) {
+        MarkUse(*entry.variable, VariableUse::LAZY_REFERENCE);
+      }
+      if (entry.concatenated &&
+          GetVariableSlot(*entry.concatenated) == slot) {
+        // the string can't be appended in place, the changed variable is
+        // still read by the first concatenation through the reference
+        MarkUse(*entry.concatenated, VariableUse::LAZY_REFERENCE);
+      }
+    }
+  }
+
+  // The target of an assignment is never read through the stack, so it stays
+  // the target even if the right-hand side changes the variable: x = x = 1
+  void MarkUse(Label label, VariableUse use) {
+    auto [it, inserted] = uses_.try_emplace(label, use);
+    if (!inserted && it->second != VariableUse::ASSIGN_TARGET &&
+        (it->second < use || use == VariableUse::ASSIGN_TARGET)) {
+      it->second = use;
+    }
+  }
+
+  const Bytecode& bytecode_;
+  std::vector<std::optional<StackState>> states_;
+  std::unordered_map<Label, VariableUse> uses_;
+  std::vector<Label> labels_to_visit_;
+};
+
+// Returns labels of the INVOKE_VARIABLE of the strings which are concatenated
+// and assigned back: s = s + a + b. Such concatenations append to the
+// variable in place, instead of copying it on every iteration of a loop.
+std::unordered_set<Label> FindAppends(const Bytecode& bytecode,
+                                      const TypeInference& inference) {
+  std::unordered_set<Label> appends;
+  std::unordered_set<Label> generic_concatenations;
+  ForEachInstruction(bytecode.code, [&](Label label, OpCode op_code,
+                                        std::span<const CodeUnit>) {
+    const auto& state = inference.GetState(label);
+    if (state && op_code == OpCode::INVOKE_VARIABLE) {
+      // s + a + s: the variable would be read after a is appended to it
+      const auto slot = inference.GetVariableSlot(label);
+      for (const auto& entry : *state) {
+        if (entry.concatenated &&
+            inference.GetVariableSlot(*entry.concatenated) == slot) {
+          generic_concatenations.insert(*entry.concatenated);
+        }
+      }
+    }
+    if (!state || state->size() < 2) {
+      return;
+    }
+    const auto& lhs = state->rbegin()[1];
+    const auto& rhs = state->rbegin()[0];
+
+    if (op_code == OpCode::ASSIGN && rhs.concatenated &&
+        inference.GetVariableSlot(*rhs.concatenated) ==
+            inference.GetVariableSlot(*lhs.variable)) {
+      appends.insert(*rhs.concatenated);
+    } else if (op_code == OpCode::PLUS && lhs.type == VariableType::STR &&
+               rhs.type == VariableType::STR) {
+      const auto root = lhs.variable ? lhs.variable : lhs.concatenated;
+      if (root && (inference.IsLazy(lhs) || inference.IsLazy(rhs))) {
+        generic_concatenations.insert(*root);
+      }
+    }
+  });
+
+  std::erase_if(appends, [&](Label label) {
+    return generic_concatenations.contains(label);
+  });
+  return appends;
+}
+
+}  // namespace
+
+void SpecializeTypes(Bytecode& bytecode) {
+  TypeInference inference{bytecode};
+  inference.Run();
+  const auto appends = FindAppends(bytecode, inference);
+
+  CodeRewriter rewriter{bytecode.code};
+  ForEachInstruction(bytecode.code, [&](Label label, OpCode op_code,
+                                        std::span<const CodeUnit> operands) {
+    const auto& state = inference.GetState(label);
+    if (!state) {
+      // unreachable code
+      rewriter.Copy(label);
+      return;
+    }
+
+    const auto info = GetOpCodeInfo(op_code);
+    const auto top = [&state](size_t i) { return state->rbegin()[i]; };
+
+    const auto append = [&](const StackEntry& entry) -> std::optional<Slot> {
+      const auto root = entry.variable ? entry.variable : entry.concatenated;
+      if (root && appends.contains(*root)) {
+        return inference.GetVariableSlot(*root);
+      }
+      return std::nullopt;
+    };
+
+    if (op_code == OpCode::INVOKE_VARIABLE && appends.contains(label)) {
+      // the string is appended to the variable, it's not loaded
+      rewriter.Bind(label);
+    } else if (op_code == OpCode::PLUS && append(top(1))) {
+      rewriter.Bind(label);
+      rewriter.Emit(OpCode::APPEND_STR, {append(top(1))->index});
+    } else if (op_code == OpCode::ASSIGN && append(top(0))) {
+      // the result of the assignment is the variable itself
+      rewriter.Bind(label);
+      rewriter.Emit(OpCode::LOAD_STR, {append(top(0))->index});
+    } else if (op_code == OpCode::INVOKE_VARIABLE) {
+      const auto use = inference.GetUse(label);
+      if (use == VariableUse::VALUE) {
+        rewriter.Bind(label);
+        rewriter.Emit(GetLoadOpCode(static_cast<VariableType>(operands[0])),
+                      {operands[1]});
+      } else if (use == VariableUse::ASSIGN_TARGET) {
+        // assignment takes the slot of the variable from its own operand
+        rewriter.Bind(label);
+      } else {
+        rewriter.Copy(label);
+      }
+    } else if (op_code == OpCode::ASSIGN) {
+      const auto variable_slot = inference.GetVariableSlot(*top(1).variable);
+      rewriter.Bind(label);
+      rewriter.Emit(*FindAssignSpecialization(top(1).type, top(0).type),
+                    {variable_slot.index});
+    } else if (op_code == OpCode::WRITE && !inference.IsLazy(top(0))) {
+      rewriter.Bind(label);
+      rewriter.Emit(GetWriteOpCode(top(0).type));
+    } else if (IsBinaryOperation(info) && !inference.IsLazy(top(1)) &&
+               !inference.IsLazy(top(0))) {
+      rewriter.Bind(label);
+      rewriter.Emit(
+          FindBinarySpecialization(op_code, top(1).type, top(0).type)->op_code);
+    } else if (IsUnaryOperation(info) && !inference.IsLazy(top(0))) {
+      rewriter.Bind(label);
+      rewriter.Emit(FindUnarySpecialization(op_code, top(0).type)->op_code);
+    } else {
+      rewriter.Copy(label);
+    }
+  });
+
+  bytecode.code = std::move(rewriter).Finish();
+}
+
+}  // namespace interpreter::instructions
@@ -0,0 +1,109 @@
+#include "interpreter/instructions/tiered.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include "interpreter/instructions/passes.hpp"
+
+namespace interpreter::instructions {
+
+namespace {
+
+struct OptimizedCode {
+  InstructionsBlock block;
+  // labels of the loop headers in the optimized code
+  std::vector<std::optional<Label>> headers;
+};
+
+OptimizedCode Optimize(Bytecode bytecode) {
+  OptimizeBytecode(bytecode);
+  FuseInstructions(bytecode);
+  auto headers = StripLoopHeaders(bytecode);
+  return {InstructionsBlock{std::move(bytecode)}, std::move(headers)};
+}
+
+// Shared by the execution and the background thread, which outlives the
+// execution if the program ends first
+struct Optimization {
+  // set by the thread after the code or the error
+  std::atomic<bool> is_done = false;
+  // empty if the optimization fails on the types
+  std::optional<OptimizedCode> code;
+  std::exception_ptr error;
+};
+
+std::shared_ptr<const Optimization> StartOptimization(Bytecode bytecode) {
+  auto optimization = std::make_shared<Optimization>();
+  std::thread{[optimization, bytecode = std::move(bytecode)]() mutable {
+    try {
+      optimization->code.emplace(Optimize(std::move(bytecode)));
+    } catch (const AnalysisError&) {
+    } catch (...) {
+      optimization->error = std::current_exception();
+    }
+    optimization->is_done.store(true, std::memory_order_release);
+  }}.detach();
+  return optimization;
+}
+
+}  // namespace
+
+TieredBlock::TieredBlock(Bytecode bytecode, TieringOptions options)
+    : baseline_{std::move(bytecode)}, options_{options} {
+  ForEachInstruction(baseline_.GetCode(),
+                     [this](Label, OpCode op_code, auto operands) {
+                       if (op_code == OpCode::LOOP_HEADER) {
+                         loops_count_ = std::max<size_t>(loops_count_,
+                                                         operands[0] + 1);
+                       }
+                     });
+}
+
+void TieredBlock::Execute(ExecutionContext& parent_context) const {
+  ExecutionContext context{
+      .input = parent_context.input,
+      .output = parent_context.output,
+      .frame = Frame{baseline_.GetFrameLayout()},
+      .values_stack = OperandStack{baseline_.GetMaxStackDepth()},
+      .current_instruction = 0};
+
+  // the loop which gets hot stops the code as written
+  LoopWatch watch{.iterations = std::vector<size_t>(loops_count_),
+                  .max_iterations = options_.hot_loop_iterations};
+  if (!baseline_.Resume(context, &watch)) {
+    return;
+  }
+
+  // then it runs until the optimized code is ready, the program doesn't wait
+  // for the optimization if it ends before
+  const auto optimization = StartOptimization(
+      Bytecode{.code = baseline_.GetCode(),
+               .constants = baseline_.GetConstants(),
+               .frame_layout = baseline_.GetFrameLayout()});
+  watch.max_iterations = std::numeric_limits<size_t>::max();
+  watch.stop = &optimization->is_done;
+  const auto loop = baseline_.Resume(context, &watch);
+  if (!loop) {
+    return;
+  }
+
+  if (optimization->error) {
+    std::rethrow_exception(optimization->error);
+  }
+  const auto& code = optimization->code;
+  if (!code || *loop >= code->headers.size() || !code->headers[*loop]) {
+    baseline_.Resume(context);
+    return;
+  }
+
+  // on-stack replacement
+  context.current_instruction = *code->headers[*loop];
+  context.values_stack = OperandStack{code->block.GetMaxStackDepth()};
+  code->block.Resume(context);
+}
+
+}  // namespace interpreter::instructions
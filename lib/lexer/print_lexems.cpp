@@ -1,59 +1,39 @@
+#include <array>
 #include <iostream>
-#include <unordered_map>
+#include <string_view>
 
 #include "interpreter/lexer/lexeme.hpp"
+#include "interpreter/lexer/scanner.hpp"
 
 namespace interpreter::lexer {
 
-std::ostream& operator<<(std::ostream& out, const Lexeme& lexeme) {
-  static const std::unordered_map<LexType, std::string> words = {
-      {LexType::AND, "and"},
-      {LexType::ASSIGN, "="},
-      {LexType::BREAK, "break"},
-      {LexType::CASE, "case"},
-      {LexType::CLOSING_BRACE, "}"},
-      {LexType::CLOSING_PARENTHESIS, ")"},
-      {LexType::COMMA, ","},
-      {LexType::CONTINUE, "continue"},
-      {LexType::DIV, "/"},
-      {LexType::DO, "do"},
-      {LexType::ELSE, "else"},
-      {LexType::END, "end"},
-      {LexType::EQ, "=="},
-      {LexType::FALSE, "false"},
-      {LexType::FOR, "for"},
-      {LexType::GE, ">="},
-      {LexType::GT, ">"},
-      {LexType::IF, "if"},
-      {LexType::LE, "<="},
-      {LexType::LT, "<"},
-      {LexType::MINUS, "-"},
-      {LexType::MOD, "%"},
-      {LexType::MUL, "*"},
-      {LexType::NE, "!="},
-      {LexType::NOT, "not"},
-      {LexType::NONE, "<none>"},
-      {LexType::OF, "of"},
-      {LexType::OPENING_BRACE, "{"},
-      {LexType::OPENING_PARENTHESIS, "("},
-      {LexType::OR, "or"},
-      {LexType::PLUS, "+"},
-      {LexType::PROGRAM, "program"},
-      {LexType::READ, "read"},
-      {LexType::SEMICOLON, ";"},
-      {LexType::TYPE_BOOL, "boolean"},
-      {LexType::TYPE_INT, "int"},
-      {LexType::TYPE_REAL, "real"},
-      {LexType::TYPE_STR, "string"},
-      {LexType::TRUE, "true"},
-      {LexType::WHILE, "while"},
-      {LexType::WRITE, "write"},
-  };
+namespace {
 
+// The text of the lexeme by its type, empty for the lexems with values
+constexpr auto WORDS = [] {
+  std::array<std::string_view,
+             static_cast<size_t>(LexType::_ARITHMETICAL_OPS_END) + 1>
+      words{};
+  for (const auto& [word, type] : details::KEYWORDS) {
+    words[static_cast<size_t>(type)] = word;
+  }
+  for (const auto& [text, type] : details::TWO_CHAR_OPERATORS) {
+    words[static_cast<size_t>(type)] = text;
+  }
+  for (const auto& [ch, type] : details::SINGLE_CHAR) {
+    words[static_cast<size_t>(type)] = std::string_view{&ch, 1};
+  }
+  words[static_cast<size_t>(LexType::NONE)] = "<none>";
+  return words;
+}();
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& out, const Lexeme& lexeme) {
   const auto type = lexeme.type;
 
-  if (words.contains(type)) {
-    out << words.at(type);
+  if (const auto word = WORDS[static_cast<size_t>(type)]; !word.empty()) {
+    out << word;
   } else if (type == LexType::VALUE_STR || type == LexType::VALUE_INT ||
              type == LexType::VALUE_REAL || type == LexType::ID) {
     std::visit(
@@ -0,0 +1,494 @@
+#include "interpreter/transpiler/transpiler.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+
+#include "interpreter/ast/types_helpers.hpp"
+#include "interpreter/instructions/operations.hpp"
+#include "interpreter/utils/format.hpp"
+
+namespace interpreter::transpiler {
+
+namespace {
+
+namespace op_type = instructions::op_type;
+namespace types = instructions::types;
+
+template <typename Op, typename... Types>
+using Rule = instructions::details::Rule<Op, Types...>;
+
+template <typename Op, typename... Types>
+inline constexpr bool kIsPerformable =
+    instructions::details::IsPerformableV<Op, Types...>;
+
+// The types and the helpers of the generated code, the division follows
+// details::operations::Div
+constexpr std::string_view kPrelude = R"cpp(#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// the uncaught error is reported the same way as by the interpreter
+namespace interpreter::instructions {
+
+struct ZeroDivisionError : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+}  // namespace interpreter::instructions
+
+namespace {
+
+using Bool = bool;
+using Int = std::int32_t;
+using Real = double;
+using Str = std::string;
+using interpreter::instructions::ZeroDivisionError;
+using namespace std::string_literals;
+
+template <typename L, typename R>
+auto Div(const L& lhs, const R& rhs) {
+  if (rhs == 0) {
+    throw ZeroDivisionError{"zero division"};
+  }
+  return lhs / rhs;
+}
+
+}  // namespace
+
+int main() {
+  std::ios_base::sync_with_stdio(false);
+)cpp";
+
+std::string_view GetTypeName(ast::VariableType type) {
+  using Type = ast::VariableType;
+  // waiting for c++20 using enums
+  switch (type) {
+    case Type::INT:
+      return "Int";
+    case Type::REAL:
+      return "Real";
+    case Type::BOOL:
+      return "Bool";
+    case Type::STR:
+      return "Str";
+    case Type::_END:
+      break;
+  }
+  throw TranspileError{"Unknown variable type"};
+}
+
+std::string GetVariableName(std::string_view name) {
+  return "v_" + std::string{name};
+}
+
+std::string MakeStringLiteral(const types::Str& value) {
+  std::string literal = "\"";
+  for (const auto ch : value) {
+    if (ch == '"' || ch == '\\') {
+      literal += '\\';
+      literal += ch;
+    } else if (ch >= ' ' && ch <= '~') {
+      literal += ch;
+    } else {
+      // octal escapes take at most three digits, unlike the hex ones
+      char escape[5];
+      std::snprintf(escape, sizeof(escape), "\\%03o",
+                    static_cast<unsigned char>(ch));
+      literal += escape;
+    }
+  }
+  return literal + "\"s";
+}
+
+// Reals are written by their bits, so the constants are exactly the same
+std::string MakeRealLiteral(types::Real value) {
+  if (std::isnan(value)) {
+    return "std::numeric_limits<Real>::quiet_NaN()";
+  }
+  if (std::isinf(value)) {
+    return value > 0 ? "std::numeric_limits<Real>::infinity()"
+                     : "-std::numeric_limits<Real>::infinity()";
+  }
+  std::ostringstream literal;
+  literal << std::hexfloat << value;
+  return literal.str();
+}
+
+std::string MakeLiteral(const instructions::Value& value) {
+  return std::visit(
+      []<typename T>(const T& value) -> std::string {
+        if constexpr (std::is_same_v<T, types::Bool>) {
+          return value ? "true" : "false";
+        } else if constexpr (std::is_same_v<T, types::Int>) {
+          if (value == std::numeric_limits<types::Int>::min()) {
+            return "std::numeric_limits<Int>::min()";
+          }
+          return std::to_string(value);
+        } else if constexpr (std::is_same_v<T, types::Real>) {
+          return MakeRealLiteral(value);
+        } else {
+          return MakeStringLiteral(value);
+        }
+      },
+      value);
+}
+
+template <typename Op>
+std::optional<ast::VariableType> FindResultType(ast::VariableType lhs,
+                                                ast::VariableType rhs) {
+  return ast::VisitType(
+      [rhs]<typename L>(
+          utils::TypeTag<L>) -> std::optional<ast::VariableType> {
+        return ast::VisitType(
+            []<typename R>(
+                utils::TypeTag<R>) -> std::optional<ast::VariableType> {
+              if constexpr (kIsPerformable<Op, L, R>) {
+                using Result =
+                    std::decay_t<decltype(Rule<Op, L, R>{}(L{}, R{}))>;
+                return ast::EnumByType<Result>::value;
+              } else {
+                return std::nullopt;
+              }
+            },
+            rhs);
+      },
+      lhs);
+}
+
+// (a < b) is written as a < b in the conditions and the statements
+std::string_view StripParentheses(std::string_view code) {
+  if (code.empty() || code.front() != '(') {
+    return code;
+  }
+  size_t depth = 0;
+  for (size_t i = 0; i < code.size(); ++i) {
+    if (code[i] == '(') {
+      ++depth;
+    } else if (code[i] == ')' && --depth == 0) {
+      return i + 1 == code.size() ? code.substr(1, i - 1) : code;
+    }
+  }
+  return code;
+}
+
+}  // namespace
+
+void CppTranspiler::VisitProgram() {}
+
+void CppTranspiler::VisitDeclarations() {}
+
+void CppTranspiler::VisitVariableDeclaration(
+    ast::VariableType type, lexer::Symbol symbol, std::string_view name,
+    std::optional<ast::Constant>&& initial_value) {
+  auto value = ast::VisitType(
+      [&]<typename T>(utils::TypeTag<T>) -> instructions::Value {
+        T variable{};
+        if (initial_value) {
+          // initialization follows the same rules as the assignment
+          std::visit(
+              [&]<typename V>(V&& initial) {
+                if constexpr (kIsPerformable<op_type::Assign, T&, V>) {
+                  Rule<op_type::Assign, T&, V>{}(variable, std::move(initial));
+                } else {
+                  throw TranspileError{utils::format(
+                      "Incorrect initial value of variable {}", name)};
+                }
+              },
+              std::move(initial_value->value));
+        }
+        return variable;
+      },
+      type);
+
+  // the initial value is converted here, so it's written as is
+  declarations_.push_back(std::string{GetTypeName(type)} + " " +
+                          GetVariableName(name) + " = " +
+                          MakeLiteral(value) + ";");
+  if (!frame_layout_.Declare(symbol, std::move(value))) {
+    throw TranspileError{
+        utils::format("Variable {} is already declared.", name)};
+  }
+}
+
+void CppTranspiler::VisitOperators() {}
+
+void CppTranspiler::VisitRead(lexer::Symbol symbol, std::string_view name) {
+  if (!frame_layout_.Find(symbol)) {
+    throw TranspileError{utils::format(
+        "Failed to read variable '{}', it is not declared.", name)};
+  }
+  AddLine("std::cin >> " + GetVariableName(name) + ";");
+}
+
+void CppTranspiler::VisitWrite() {
+  AddLine("std::cout << " + PopExpression().code + ";");
+}
+
+void CppTranspiler::VisitExpressionOperator() {
+  // the operations are kept even without the assignments, they may throw
+  const auto expression = PopExpression();
+  if (expression.is_assignment) {
+    AddLine(std::string{StripParentheses(expression.code)} + ";");
+  } else if (!expression.is_variable) {
+    AddLine("static_cast<void>(" + expression.code + ");");
+  }
+}
+
+void CppTranspiler::VisitIf() {
+  AddLine("if (" + PopCondition() + ") {");
+  ++indent_;
+}
+
+void CppTranspiler::VisitElse() {
+  --indent_;
+  AddLine("} else {");
+  ++indent_;
+}
+
+void CppTranspiler::VisitEndIf() {
+  --indent_;
+  AddLine("}");
+}
+
+void CppTranspiler::VisitWhile() {}
+
+void CppTranspiler::VisitWhileBody() {
+  AddLine("while (" + PopCondition() + ") {");
+  ++indent_;
+  ++loops_depth_;
+}
+
+void CppTranspiler::VisitEndWhile() {
+  --loops_depth_;
+  --indent_;
+  AddLine("}");
+}
+
+void CppTranspiler::VisitDoWhile() {
+  // continue jumps to the beginning of the body, not to the condition
+  AddLine("for (;;) {");
+  ++indent_;
+  ++loops_depth_;
+}
+
+void CppTranspiler::VisitDoWhileEnd() {
+  AddLine("if (!(" + PopCondition() + ")) break;");
+  --loops_depth_;
+  --indent_;
+  AddLine("}");
+}
+
+void CppTranspiler::VisitBreak() {
+  if (loops_depth_ == 0) {
+    throw TranspileError{"break instruction outside the loop"};
+  }
+  AddLine("break;");
+}
+
+void CppTranspiler::VisitContinue() {
+  if (loops_depth_ == 0) {
+    throw TranspileError{"continue instruction outside the loop"};
+  }
+  AddLine("continue;");
+}
+
+void CppTranspiler::VisitAssign() {
+  const auto value = PopExpression();
+  const auto target = PopExpression();
+  if (!target.is_variable) {
+    throw TypeError{"Only variable can be assigned"};
+  }
+  const auto is_performable = ast::VisitType(
+      [&]<typename L>(utils::TypeTag<L>) -> bool {
+        return ast::VisitType(
+            []<typename R>(utils::TypeTag<R>) -> bool {
+              return kIsPerformable<op_type::Assign, L&, R>;
+            },
+            value.type);
+      },
+      target.type);
+  if (!is_performable) {
+    throw TypeError{"Incompatible types of assignment"};
+  }
+
+  // the value is evaluated before the store, the result is the variable
+  expressions_.push_back(
+      Expression{.type = target.type,
+                 .code = "(" + target.code + " = " +
+                         std::string{StripParentheses(value.code)} + ")",
+                 .has_effects = true,
+                 .is_assignment = true});
+}
+
+void CppTranspiler::VisitOrRightOperand() {}
+
+void CppTranspiler::VisitOr() { TranspileLogical<op_type::Or>("||"); }
+
+void CppTranspiler::VisitAndRightOperand() {}
+
+void CppTranspiler::VisitAnd() { TranspileLogical<op_type::And>("&&"); }
+
+void CppTranspiler::VisitCompare(ast::CompareType compare_type) {
+  using Compare = ast::CompareType;
+  // waiting for c++20 using enums
+  switch (compare_type) {
+    case Compare::EQ:
+      return TranspileBinary<op_type::Equals>("==");
+    case Compare::NE:
+      return TranspileBinary<op_type::NotEquals>("!=");
+    case Compare::LT:
+      return TranspileBinary<op_type::Less>("<");
+    case Compare::GT:
+      return TranspileBinary<op_type::Greater>(">");
+    case Compare::LE:
+      return TranspileBinary<op_type::LessOrEq>("<=");
+    case Compare::GE:
+      return TranspileBinary<op_type::GreaterOrEq>(">=");
+  }
+  throw TranspileError{"Unknown compare operation"};
+}
+
+void CppTranspiler::VisitAdd(ast::AddType add_type) {
+  // waiting for c++20 using enums
+  switch (add_type) {
+    case ast::AddType::PLUS:
+      return TranspileBinary<op_type::Plus>("+");
+    case ast::AddType::MINUS:
+      return TranspileBinary<op_type::Minus>("-");
+  }
+  throw TranspileError{"Unknown add operation"};
+}
+
+void CppTranspiler::VisitMul(ast::MulType mul_type) {
+  // waiting for c++20 using enums
+  switch (mul_type) {
+    case ast::MulType::MUL:
+      return TranspileBinary<op_type::Mul>("*");
+    case ast::MulType::DIV:
+      return TranspileBinary<op_type::Div>("/");
+    case ast::MulType::MOD:
+      return TranspileBinary<op_type::Mod>("%");
+  }
+  throw TranspileError{"Unknown mul operation"};
+}
+
+void CppTranspiler::VisitNot() {
+  auto operand = PopExpression();
+  if (operand.type != ast::VariableType::BOOL) {
+    throw TypeError{"Operation is not defined for the operand"};
+  }
+  operand.code = "(!" + operand.code + ")";
+  operand.is_variable = false;
+  expressions_.push_back(std::move(operand));
+}
+
+void CppTranspiler::VisitVariableInvokation(lexer::Symbol symbol,
+                                           std::string_view name) {
+  const auto slot = frame_layout_.Find(symbol);
+  if (!slot) {
+    throw TranspileError{utils::format("Variable {} is not defined", name)};
+  }
+  expressions_.push_back(Expression{.type = slot->type,
+                                    .code = GetVariableName(name),
+                                    .is_variable = true});
+}
+
+void CppTranspiler::VisitConstantInvokation(ast::Constant&& constant) {
+  expressions_.push_back(Expression{
+      .type = constant.type,
+      .code = std::visit(
+          [](auto&& value) { return MakeLiteral(instructions::Value{value}); },
+          constant.value)});
+}
+
+std::string CppTranspiler::MakeSource() const {
+  std::string source{kPrelude};
+  for (const auto& declaration : declarations_) {
+    source += "  " + declaration + "\n";
+  }
+  source += body_;
+  source += "  return 0;\n}\n";
+  return source;
+}
+
+// The variable on the left is a reference which is read after the right
+// operand is evaluated, the same way as the instructions do. The order is
+// fixed by the lambda only when some operand contains an assignment.
+template <typename Op>
+void CppTranspiler::TranspileBinary(std::string_view op) {
+  const auto rhs = PopExpression();
+  const auto lhs = PopExpression();
+  const auto type = FindResultType<Op>(lhs.type, rhs.type);
+  if (!type) {
+    throw TypeError{"Operation is not defined for the operands"};
+  }
+
+  const auto apply = [op](const std::string& l, const std::string& r) {
+    if constexpr (std::is_same_v<Op, op_type::Div>) {
+      return "Div(" + l + ", " + r + ")";
+    } else {
+      return "(" + l + " " + std::string{op} + " " + r + ")";
+    }
+  };
+
+  Expression result{.type = *type};
+  if (!lhs.has_effects && !rhs.has_effects) {
+    result.code = apply(lhs.code, rhs.code);
+  } else if (lhs.is_variable) {
+    result.code = "[&] { const auto rhs = " + rhs.code + "; return " +
+                  apply(lhs.code, "rhs") + "; }()";
+    result.has_effects = true;
+  } else {
+    result.code = "[&] { const auto lhs = " + lhs.code +
+                  "; const auto rhs = " + rhs.code + "; return " +
+                  apply("lhs", "rhs") + "; }()";
+    result.has_effects = true;
+  }
+  expressions_.push_back(std::move(result));
+}
+
+// The right operand is evaluated only when it decides the result, the same
+// way as the jumps of the instructions do
+template <typename Op>
+void CppTranspiler::TranspileLogical(std::string_view op) {
+  const auto rhs = PopExpression();
+  const auto lhs = PopExpression();
+  if (lhs.type != ast::VariableType::BOOL ||
+      rhs.type != ast::VariableType::BOOL) {
+    throw TypeError{"Condition must be boolean"};
+  }
+  expressions_.push_back(Expression{
+      .type = ast::VariableType::BOOL,
+      .code = "(" + lhs.code + " " + std::string{op} + " " + rhs.code + ")",
+      .has_effects = lhs.has_effects || rhs.has_effects});
+}
+
+CppTranspiler::Expression CppTranspiler::PopExpression() {
+  if (expressions_.empty()) {
+    throw TranspileError{"Missing operand of the expression"};
+  }
+  auto expression = std::move(expressions_.back());
+  expressions_.pop_back();
+  return expression;
+}
+
+std::string CppTranspiler::PopCondition() {
+  auto condition = PopExpression();
+  if (condition.type != ast::VariableType::BOOL) {
+    throw TypeError{"Condition must be boolean"};
+  }
+  return std::string{StripParentheses(condition.code)};
+}
+
+void CppTranspiler::AddLine(std::string_view line) {
+  body_.append(indent_ * 2, ' ');
+  body_ += line;
+  body_ += '\n';
+}
+
+}  // namespace interpreter::transpiler
@@ -0,0 +1,80 @@
+#include "interpreter/utils/mapped_file.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define INTERPRETER_MMAP
+#endif
+
+namespace interpreter::utils {
+
+std::optional<MappedFile> MappedFile::Open(const std::string& path) {
+  MappedFile file;
+
+#ifdef INTERPRETER_MMAP
+  const int descriptor = open(path.c_str(), O_RDONLY);
+  if (descriptor < 0) {
+    return std::nullopt;
+  }
+  struct stat status {};
+  if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) &&
+      status.st_size > 0) {
+    const auto size = static_cast<size_t>(status.st_size);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (memory != MAP_FAILED) {
+      // the source is scanned once from the beginning to the end
+      madvise(memory, size, MADV_SEQUENTIAL);
+      file.mapping_ = memory;
+      file.mapping_size_ = size;
+    }
+  }
+  // the mapping keeps the file
+  close(descriptor);
+  if (file.mapping_) {
+    return file;
+  }
+#endif
+
+  // pipes and the empty files can't be mapped
+  std::ifstream input{path, std::ios::binary};
+  if (!input) {
+    return std::nullopt;
+  }
+  file.buffer_.assign(std::istreambuf_iterator<char>{input}, {});
+  return file;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mapping_{std::exchange(other.mapping_, nullptr)},
+      mapping_size_{std::exchange(other.mapping_size_, 0)},
+      buffer_{std::move(other.buffer_)} {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Unmap();
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    mapping_size_ = std::exchange(other.mapping_size_, 0);
+    buffer_ = std::move(other.buffer_);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { Unmap(); }
+
+void MappedFile::Unmap() noexcept {
+#ifdef INTERPRETER_MMAP
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+  }
+#endif
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+}
+
+}  // namespace interpreter::utils
@@ -1,29 +1,152 @@
-#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
 
+#include "interpreter/ast/reader.hpp"
+#include "interpreter/closures/compiler.hpp"
 #include "interpreter/instructions/writer.hpp"
+#include "interpreter/transpiler/transpiler.hpp"
+#include "interpreter/utils/mapped_file.hpp"
+
+enum class Engine { STACK, REGISTER, CLOSURE, JIT, TIERED, BATCH };
+
+// Every line of the input is the input of a separate run, the output of each
+// run is printed on its own line
+template <typename Code>
+void interpret_batch(Code& code, std::istream& input, std::ostream& output) {
+  constexpr size_t kChunkSize = 4096;
 
-// TODO: move it in library
-void interpret(std::istream& code, std::istream& input, std::ostream& output) {
   interpreter::instructions::InstructionsWriter writer;
   interpreter::ast::VisitCode(code, writer);
-  const auto instructions_block = writer.MakeBlock();
+  const auto batch_block = writer.MakeBatchBlock();
 
+  for (std::string line; input;) {
+    std::vector<std::istringstream> inputs;
+    while (inputs.size() < kChunkSize && std::getline(input, line)) {
+      inputs.emplace_back(line);
+    }
+    std::vector<std::ostringstream> outputs(inputs.size());
+    std::vector<interpreter::instructions::ExecutionContext> contexts;
+    contexts.reserve(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      contexts.push_back({.input = inputs[i], .output = outputs[i]});
+    }
+
+    batch_block.Execute(contexts);
+    for (const auto& run_output : outputs) {
+      output << run_output.str() << '\n';
+    }
+  }
+}
+
+// The code is the stream or the source in memory, see ast::VisitCode
+// TODO: move it in library
+template <typename Code>
+void interpret(Code& code, std::istream& input, std::ostream& output,
+               Engine engine) {
   interpreter::instructions::ExecutionContext context{
-      .input = input, .output = output, .variables = {}};
-  instructions_block.Execute(context);
+      .input = input, .output = output};
+  // waiting for c++20 using enums
+  switch (engine) {
+    case Engine::STACK: {
+      interpreter::instructions::InstructionsWriter writer;
+      interpreter::ast::VisitCode(code, writer);
+      writer.MakeBlock().Execute(context);
+      break;
+    }
+    case Engine::REGISTER: {
+      interpreter::instructions::InstructionsWriter writer;
+      interpreter::ast::VisitCode(code, writer);
+      writer.MakeRegisterBlock().Execute(context);
+      break;
+    }
+    case Engine::JIT: {
+      interpreter::instructions::InstructionsWriter writer;
+      interpreter::ast::VisitCode(code, writer);
+      writer.MakeRegisterBlock().Execute(
+          context, interpreter::instructions::JitOptions{});
+      break;
+    }
+    case Engine::TIERED: {
+      interpreter::instructions::InstructionsWriter writer;
+      interpreter::ast::VisitCode(code, writer);
+      writer.MakeTieredBlock().Execute(context);
+      break;
+    }
+    case Engine::BATCH:
+      interpret_batch(code, input, output);
+      break;
+    case Engine::CLOSURE: {
+      interpreter::closures::ClosureCompiler compiler;
+      interpreter::ast::VisitCode(code, compiler);
+      compiler.MakeProgram().Execute(context);
+      break;
+    }
+  }
+}
+
+// Prints the C++ source of the program instead of running it
+template <typename Code>
+void transpile(Code& code, std::ostream& output) {
+  interpreter::transpiler::CppTranspiler transpiler;
+  interpreter::ast::VisitCode(code, transpiler);
+  output << transpiler.MakeSource();
 }
 
 int main(int argc, char** argv) {
-  if (argc == 1) {
-    interpret(std::cin, std::cin, std::cout);
+  constexpr std::string_view kEngineFlag = "--engine=";
+  constexpr std::string_view kEmitCppFlag = "--emit-cpp";
+
+  Engine engine = Engine::STACK;
+  bool emit_cpp = false;
+  const char* file_name = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (arg == kEmitCppFlag) {
+      emit_cpp = true;
+    } else if (arg.starts_with(kEngineFlag)) {
+      const auto name = arg.substr(kEngineFlag.size());
+      if (name == "stack") {
+        engine = Engine::STACK;
+      } else if (name == "register") {
+        engine = Engine::REGISTER;
+      } else if (name == "closure") {
+        engine = Engine::CLOSURE;
+      } else if (name == "jit") {
+        engine = Engine::JIT;
+      } else if (name == "tiered") {
+        engine = Engine::TIERED;
+      } else if (name == "batch") {
+        engine = Engine::BATCH;
+      } else {
+        std::cout << "Unknown engine " << name << std::endl;
+        return -1;
+      }
+    } else {
+      file_name = argv[i];
+    }
+  }
+
+  if (!file_name) {
+    if (emit_cpp) {
+      transpile(std::cin, std::cout);
+    } else {
+      interpret(std::cin, std::cin, std::cout, engine);
+    }
   } else {
-    std::ifstream code{argv[1]};
-    if (!code) {
-      std::cout << "Error while opening file " << argv[1] << std::endl;
+    const auto file = interpreter::utils::MappedFile::Open(file_name);
+    if (!file) {
+      std::cout << "Error while opening file " << file_name << std::endl;
       return -1;
     }
-    interpret(code, std::cin, std::cout);
+    auto code = file->View();
+    if (emit_cpp) {
+      transpile(code, std::cout);
+    } else {
+      interpret(code, std::cin, std::cout, engine);
+    }
   }
   return 0;
 }
@@ -11,11 +11,12 @@ class MockModelVisitor : public ModelVisitor {
   MOCK_METHOD(void, VisitProgram, (), (override));
   MOCK_METHOD(void, VisitDeclarations, (), (override));
   MOCK_METHOD(void, VisitVariableDeclaration,
-              (VariableType type, std::string&& name,
+              (VariableType type, lexer::Symbol symbol, std::string_view name,
                std::optional<Constant>&& initial_value),
               (override));
   MOCK_METHOD(void, VisitOperators, (), (override));
-  MOCK_METHOD(void, VisitRead, (std::string && name), (override));
+  MOCK_METHOD(void, VisitRead, (lexer::Symbol symbol, std::string_view name),
+              (override));
   MOCK_METHOD(void, VisitWrite, (), (override));
   MOCK_METHOD(void, VisitExpressionOperator, (), (override));
 
@@ -34,14 +35,16 @@ class MockModelVisitor : public ModelVisitor {
   MOCK_METHOD(void, VisitContinue, (), (override));
 
   MOCK_METHOD(void, VisitAssign, (), (override));
+  MOCK_METHOD(void, VisitOrRightOperand, (), (override));
   MOCK_METHOD(void, VisitOr, (), (override));
+  MOCK_METHOD(void, VisitAndRightOperand, (), (override));
   MOCK_METHOD(void, VisitAnd, (), (override));
   MOCK_METHOD(void, VisitCompare, (CompareType compare_type), (override));
   MOCK_METHOD(void, VisitAdd, (AddType add_type), (override));
   MOCK_METHOD(void, VisitMul, (MulType mul_type), (override));
   MOCK_METHOD(void, VisitNot, (), (override));
-  MOCK_METHOD(void, VisitVariableInvokation, (std::string && variable_name),
-              (override));
+  MOCK_METHOD(void, VisitVariableInvokation,
+              (lexer::Symbol symbol, std::string_view name), (override));
   MOCK_METHOD(void, VisitConstantInvokation, (Constant && constant),
               (override));
 };
@@ -20,4 +20,23 @@ TEST(TestAst, TestEmpty) {
   VisitCode(code, visitor);
 }
 
+TEST(TestAst, TestSymbols) {
+  std::stringstream code{
+      "program { int x, y; string s; read(y); x = y + x; write(x, s); }"};
+
+  using ::testing::_;
+  ::testing::NiceMock<MockModelVisitor> visitor;
+
+  // the symbols are given in the order of the first appearance of the names
+  EXPECT_CALL(visitor, VisitVariableDeclaration(VariableType::INT, 0, "x", _));
+  EXPECT_CALL(visitor, VisitVariableDeclaration(VariableType::INT, 1, "y", _));
+  EXPECT_CALL(visitor, VisitVariableDeclaration(VariableType::STR, 2, "s", _));
+  EXPECT_CALL(visitor, VisitRead(1, "y"));
+  EXPECT_CALL(visitor, VisitVariableInvokation(0, "x")).Times(3);
+  EXPECT_CALL(visitor, VisitVariableInvokation(1, "y"));
+  EXPECT_CALL(visitor, VisitVariableInvokation(2, "s"));
+
+  VisitCode(code, visitor);
+}
+
 }  // namespace test
@@ -0,0 +1,91 @@
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include "interpreter/instructions/writer.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+size_t allocations_count = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  ++allocations_count;
+  if (auto* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+
+namespace interpreter::test {
+
+namespace {
+
+// Allocations made by the execution of the program, without the compilation
+size_t CountAllocations(const std::string& code, const std::string& input) {
+  std::istringstream code_stream{code};
+  instructions::InstructionsWriter writer;
+  ast::VisitCode(code_stream, writer);
+  const auto block = writer.MakeBlock();
+
+  std::istringstream input_stream{input};
+  std::ostringstream output_stream;
+  instructions::ExecutionContext context{.input = input_stream,
+                                         .output = output_stream};
+  const auto before = allocations_count;
+  block.Execute(context);
+  return allocations_count - before;
+}
+
+}  // namespace
+
+TEST(TestAllocations, StringOperations) {
+  const auto program = R"abc(
+    program {
+        int i = 0, n, count = 0;
+        string s, t = "the string which doesn't fit into the small buffer";
+        read(n);
+        while (i < n) {
+            s = t + ", " + t + "!";
+            if (s != t) count = count + 1;
+            write("");
+            i = i + 1;
+        }
+        write(count);
+    }
+  )abc";
+  const auto per_iteration =
+      (CountAllocations(program, "1010") - CountAllocations(program, "10")) /
+      1000;
+  // 4 loads of the string variable, each one copies the string into a new
+  // cell, the concatenations extend the buffer of their left operand
+  ASSERT_LE(per_iteration, 10);
+}
+
+TEST(TestAllocations, AppendToString) {
+  const auto program = R"abc(
+    program {
+        int i = 0, n;
+        string s;
+        read(n);
+        while (i < n) {
+            s = s + "the string which doesn't fit into the small buffer" + "\n";
+            i = i + 1;
+        }
+        write(s == "");
+    }
+  )abc";
+  // the buffer of the variable grows geometrically
+  const auto allocations =
+      CountAllocations(program, "10010") - CountAllocations(program, "10");
+  ASSERT_LT(allocations, 100);
+}
+
+}  // namespace interpreter::test
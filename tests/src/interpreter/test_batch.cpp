@@ -0,0 +1,145 @@
+#include "interpreter/instructions/batch.hpp"
+#include "test_interpreter.hpp"
+
+#include <gtest/gtest.h>
+
+namespace interpreter::test {
+
+namespace {
+
+std::vector<std::string> RunEach(const std::string& code,
+                                 const std::vector<std::string>& inputs) {
+  std::vector<std::string> outputs;
+  for (const auto& input : inputs) {
+    outputs.push_back(RunInterpreter(code, input));
+  }
+  return outputs;
+}
+
+std::vector<std::string> MakeInputs(int begin, int end) {
+  std::vector<std::string> inputs;
+  for (int i = begin; i < end; ++i) {
+    inputs.push_back(std::to_string(i));
+  }
+  return inputs;
+}
+
+}  // namespace
+
+TEST(TestBatch, IsPrime) {
+  const auto program = R"abc(
+    program {
+        int i, n;
+        boolean is_prime = true;
+        read(n);
+
+        i = 2;
+        while (i < n) {
+            if (n % i == 0) {
+                is_prime = false;
+                break;
+            }
+            i = i + 1;
+        }
+
+        write(is_prime, " ", i);
+    }
+  )abc";
+  const auto inputs = MakeInputs(0, 300);
+  ASSERT_EQ(RunBatchInterpreter(program, inputs), RunEach(program, inputs));
+  ASSERT_EQ(RunBatchInterpreter(program, inputs,
+                                instructions::JitOptions{
+                                    .hot_loop_iterations = 0}),
+            RunEach(program, inputs));
+}
+
+TEST(TestBatch, PartialBatches) {
+  const auto program = R"abc(
+    program {
+        int n;
+        read(n);
+        write(n * n);
+    }
+  )abc";
+  ASSERT_TRUE(RunBatchInterpreter(program, {}).empty());
+  ASSERT_EQ(RunBatchInterpreter(program, {"3"}),
+            std::vector<std::string>{"9"});
+  const auto inputs = MakeInputs(-5, 6);
+  ASSERT_EQ(RunBatchInterpreter(program, inputs), RunEach(program, inputs));
+}
+
+TEST(TestBatch, AllTypes) {
+  const auto program = R"abc(
+    program {
+        int i = 0, n, a = 0, b = 0;
+        real r = 1, half;
+        boolean flag = false;
+        string s = "", word;
+        read(n);
+        read(word);
+        half = n / 2.0;
+        while (i < n) {
+            i = i + 1;
+            if (i % 3 == 0) continue;
+            if (i % 2 == 0 and not flag or i > 7) {
+                a = a + i;
+                s = s + word;
+            } else {
+                b = b - i;
+                r = r * 1.5 + a;
+            }
+            flag = not flag;
+        }
+        a = r;
+        write(a, " ", b, " ", r, " ", half, " ", flag, " ", s, " ",
+              s == word + word, " ", 0 - r);
+    }
+  )abc";
+  std::vector<std::string> inputs;
+  for (int n = 0; n < 20; ++n) {
+    inputs.push_back(std::to_string(n % 13) + " w" + std::to_string(n));
+  }
+  ASSERT_EQ(RunBatchInterpreter(program, inputs), RunEach(program, inputs));
+}
+
+TEST(TestBatch, ShortCircuit) {
+  const auto program = R"abc(
+    program {
+        int x = 0, n;
+        boolean t = true, f;
+        read(n);
+        f = n % 2 == 0;
+        write(f and (x = 1) > 0, " ", x, " ");
+        write(t or (x = 2) > 0, " ", x, " ");
+        write(f or n > 3 and (x = 3) > 0, " ", x);
+    }
+  )abc";
+  const auto inputs = MakeInputs(0, 10);
+  ASSERT_EQ(RunBatchInterpreter(program, inputs), RunEach(program, inputs));
+}
+
+TEST(TestBatch, ZeroDivision) {
+  const auto program = R"abc(
+    program {
+        int n;
+        read(n);
+        if (n != 0) write(10 / n, " ", 10 % n);
+        else write("none");
+    }
+  )abc";
+  // the lanes of zero don't divide
+  const auto inputs = MakeInputs(-3, 4);
+  ASSERT_EQ(RunBatchInterpreter(program, inputs), RunEach(program, inputs));
+
+  const auto failing = R"abc(
+    program {
+        int n;
+        read(n);
+        write(10 / n);
+    }
+  )abc";
+  ASSERT_THROW(RunBatchInterpreter(failing, inputs),
+               instructions::ZeroDivisionError);
+}
+
+}  // namespace interpreter::test
@@ -0,0 +1,32 @@
+#include "interpreter/closures/compiler.hpp"
+#include "test_interpreter.hpp"
+
+#include <gtest/gtest.h>
+
+namespace interpreter::test {
+
+TEST(TestClosures, TypeMismatch) {
+  ASSERT_THROW(RunClosureInterpreter(R"abc(
+    program {
+        int x = 1;
+        string s;
+        s = x;
+    }
+  )abc"),
+               closures::TypeError);
+  ASSERT_THROW(RunClosureInterpreter(R"abc(
+    program {
+        int x = 1;
+        while (x) x = x - 1;
+    }
+  )abc"),
+               closures::TypeError);
+  ASSERT_THROW(RunClosureInterpreter(R"abc(
+    program {
+        write(y);
+    }
+  )abc"),
+               closures::CompileError);
+}
+
+}  // namespace interpreter::test
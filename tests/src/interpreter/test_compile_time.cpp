@@ -0,0 +1,158 @@
+#include "interpreter/compile_time/program.hpp"
+#include "test_interpreter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace interpreter::test {
+
+namespace {
+
+constexpr utils::FixedString kPrimes = R"abc(
+    program {
+        int i = 1, j, count = 0;
+        boolean is_prime;
+        string primes = "";
+        while (i < 60) {
+            i = i + 1;
+            is_prime = true;
+            j = 2;
+            while (j * j <= i) {
+                if (i % j == 0) {
+                    is_prime = false;
+                    break;
+                }
+                j = j + 1;
+            }
+            if (is_prime and not (i == 2)) {
+                count = count + 1;
+                primes = primes + " " + "x";
+                write(i, " ");
+            } else continue;
+        }
+        do { count = count - 1; } while (count > 10 or count % 7 != 0);
+        write(count, primes, " ", primes == "", " ", i);
+    }
+  )abc";
+
+constexpr utils::FixedString kReals = R"abc(
+    program {
+        real big = 1, small = 1, third;
+        int i = 0, n = 7.9;
+        third = 1.0 / 3;
+        while (i < 12) {
+            write(big, " ", small, " ");
+            big = big * 10;
+            small = small / 10;
+            i = i + 1;
+        }
+        write(1234565.0, " ", 1234575.0, " ", 0.5, " ", third, " ");
+        write(2.5 * 4, " ", 100000.0, " ", 999999.5, " ", 0.0001, " ");
+        write(0 - 123.456, " ", n, " ", 3.14159265358979323846, " ");
+        write(0.1 + 0.2 == 0.30000000000000004, " ", 0.1 + 0.2 == 0.3);
+    }
+  )abc";
+
+constexpr utils::FixedString kIsPrime = R"abc(
+    program {
+        int i, n;
+        boolean is_prime = true;
+        read(n);
+
+        i = 2;
+        while (i < n) {
+            if (n % i == 0) {
+                is_prime = false;
+                break;
+            }
+            i = i + 1;
+        }
+
+        write(is_prime, " ", i);
+    }
+  )abc";
+
+template <compile_time::ProgramSizes sizes>
+std::string RunCompiled(const compile_time::Program<sizes>& program,
+                        const std::string& input) {
+  std::istringstream input_stream{input};
+  std::ostringstream output_stream{};
+
+  const auto instructions_block = program.MakeBlock();
+  instructions::ExecutionContext context{.input = input_stream,
+                                         .output = output_stream};
+  instructions_block.Execute(context);
+
+  return output_stream.str();
+}
+
+static_assert(compile_time::EvaluateProgram<R"(
+    program { write(2 + 2 * 2, " ", "a" + "b", " ", 7 / 2.0); }
+  )">().View() == "6 ab 3.5");
+
+static_assert(utils::FormatReal(std::numeric_limits<double>::infinity()) ==
+              "inf");
+static_assert(utils::FormatReal(-std::numeric_limits<double>::denorm_min()) ==
+              "-4.94066e-324");
+
+}  // namespace
+
+TEST(TestCompileTime, EvaluatesProgram) {
+  constexpr auto output = compile_time::EvaluateProgram<kPrimes>();
+  ASSERT_EQ(output.View(), RunInterpreter(std::string{kPrimes.View()}));
+}
+
+TEST(TestCompileTime, FormatsReals) {
+  constexpr auto output = compile_time::EvaluateProgram<kReals>();
+  ASSERT_EQ(output.View(), RunInterpreter(std::string{kReals.View()}));
+}
+
+TEST(TestCompileTime, RunsCompiledProgram) {
+  constexpr auto program = compile_time::CompileProgram<kIsPrime>();
+  ASSERT_EQ(RunCompiled(program, "1000003"), "1 1000003");
+  ASSERT_EQ(RunCompiled(program, "999997"), "0 757");
+}
+
+TEST(TestCompileTime, EvaluatesExamples) {
+  // the programs which read the input are left to the runtime
+  size_t evaluated = 0;
+  for (const auto& entry :
+       std::filesystem::directory_iterator{INTERPRETER2_EXAMPLES_DIR}) {
+    std::ifstream file{entry.path()};
+    const std::string program{std::istreambuf_iterator<char>{file}, {}};
+
+    std::string output;
+    try {
+      output = compile_time::Evaluate(compile_time::Compile(program));
+    } catch (const compile_time::EvaluationError&) {
+      continue;
+    }
+    ASSERT_EQ(output, RunInterpreter(program)) << entry.path();
+    ++evaluated;
+  }
+  ASSERT_GT(evaluated, 0);
+}
+
+TEST(TestCompileTime, Errors) {
+  // the same functions are called at runtime, so the errors are thrown
+  const auto evaluate = [](std::string_view source) {
+    return compile_time::Evaluate(compile_time::Compile(source));
+  };
+
+  ASSERT_THROW(evaluate(kIsPrime.View()), compile_time::EvaluationError);
+  ASSERT_THROW(evaluate("program { int a = 0; write(1 / a); }"),
+               instructions::ZeroDivisionError);
+  ASSERT_THROW(evaluate(R"(program { int a; a = "s"; })"),
+               instructions::NotDefinedOperationError);
+  ASSERT_THROW(evaluate("program { write(b); }"), instructions::WriterError);
+  ASSERT_THROW(evaluate("program { write(1) }"), ast::SyntaxError);
+  ASSERT_THROW(evaluate("program { write(1 $ 2); }"), lexer::LexicalError);
+  ASSERT_THROW(evaluate("program { write(2147483648); }"),
+               lexer::LexicalError);
+}
+
+}  // namespace interpreter::test
@@ -0,0 +1,248 @@
+#include <functional>
+
+#include "test_interpreter.hpp"
+
+#include <gtest/gtest.h>
+
+namespace interpreter::test {
+
+namespace {
+
+using Runner =
+    std::function<std::string(const std::string& code, const std::string&)>;
+
+struct Engine {
+  std::string name;
+  Runner run;
+};
+
+// The batch engine runs the input in two lanes, they give the same output
+std::string RunBothLanes(const std::string& code, const std::string& input) {
+  const auto outputs = RunBatchInterpreter(code, {input, input});
+  EXPECT_EQ(outputs[0], outputs[1]);
+  return outputs[1];
+}
+
+// The jit and the tiered engines compile every loop on the first jump back to
+// its header
+const Engine kEngines[] = {
+    {"Stack",
+     [](const auto& code, const auto& input) {
+       return RunInterpreter(code, input);
+     }},
+    {"Register",
+     [](const auto& code, const auto& input) {
+       return RunRegisterInterpreter(code, input);
+     }},
+    {"Jit",
+     [](const auto& code, const auto& input) {
+       return RunRegisterInterpreter(code, input,
+                                     {{.hot_loop_iterations = 0}});
+     }},
+    {"Batch", RunBothLanes},
+    {"Tiered",
+     [](const auto& code, const auto& input) {
+       return RunTieredInterpreter(code, input, {.hot_loop_iterations = 0});
+     }},
+    {"Closure",
+     [](const auto& code, const auto& input) {
+       return RunClosureInterpreter(code, input);
+     }},
+};
+
+}  // namespace
+
+// The same programs run by every backend, see the files of the backends for
+// their own cases
+class TestEngines : public ::testing::TestWithParam<Engine> {
+ protected:
+  std::string Run(const std::string& code, const std::string& input = "") {
+    return GetParam().run(code, input);
+  }
+};
+
+TEST_P(TestEngines, Expressions) {
+  const auto program = R"abc(
+    program {
+        int x, y;
+        real r = 1;
+        read(x);
+        read(y);
+        write(x + y, "123", "456" + "00", "\n");
+        r = r / 2 + x;
+        write(r, " ", r * 2, " ", not (x > y), " ", x * 1.5 < y, "\n");
+
+        x = 20;
+        write(x, x = 10, " ", x = r, " ", r = x / 4);
+    }
+  )abc";
+  ASSERT_EQ(Run(program, "1 2"), "312345600\n1.5 3 1 1\n2010 1 0");
+}
+
+TEST_P(TestEngines, WhileWithBreak) {
+  const auto program = R"abc(
+    program {
+        int i, n;
+        boolean is_prime = true;
+        read(n);
+
+        i = 2;
+        while (i < n) {
+            if (n % i == 0) {
+                is_prime = false;
+                break;
+            }
+            i = i + 1;
+        }
+
+        write(is_prime, " ", i);
+    }
+  )abc";
+  ASSERT_EQ(Run(program, "97"), "1 97");
+  ASSERT_EQ(Run(program, "91"), "0 7");
+}
+
+TEST_P(TestEngines, ShortCircuit) {
+  const auto program = R"abc(
+    program {
+        int x = 0;
+        boolean t = true, f = false;
+        write(f and (x = 1) > 0, " ", x, " ");
+        write(t or (x = 2) > 0, " ", x, " ");
+        write(t and (x = 3) > 0, " ", x, " ");
+        write(f or t and f, " ", f or t and t, " ", not f and (f or t));
+    }
+  )abc";
+  ASSERT_EQ(Run(program), "0 0 1 0 1 3 0 1 1");
+}
+
+TEST_P(TestEngines, NestedControlFlow) {
+  const auto program = R"abc(
+    program {
+        int i = 0, j, n, a = 0, b = 0, c = 0;
+        boolean found = false;
+        read(n);
+        while (i < n and not found) {
+            j = 0;
+            while (true) {
+                if (j >= i) break;
+                if (j % 2 == 0) {
+                    if (j % 3 == 0) a = a + 1;
+                    else b = b + 1;
+                } else {
+                    if (j % 5 == 0 or j % 7 == 0) c = c + 1;
+                    else { j = j + 1; continue; }
+                }
+                j = j + 1;
+            }
+            if (a > 100000000) found = true;
+            i = i + 1;
+        }
+        do { i = i - 1; } while (i > 0 and i % 10 != 0);
+        write(a, " ", b, " ", c, " ", i);
+    }
+  )abc";
+  ASSERT_EQ(Run(program, "60"), "320 580 274 50");
+}
+
+TEST_P(TestEngines, DoWhileContinue) {
+  const auto program = R"abc(
+    program {
+        int i = 0, s = 0;
+        do {
+            i = i + 1;
+            if (i % 2 == 0) continue;
+            s = s + i;
+        } while (i < 9);
+        write(i, " ", s);
+    }
+  )abc";
+  ASSERT_EQ(Run(program), "9 25");
+}
+
+TEST_P(TestEngines, AssignInsideExpression) {
+  const auto program = R"abc(
+    program {
+        int x = 1, y;
+        y = x + (x = 5);
+        write(x, " ", y, " ");
+        y = (x = 2) + x;
+        write(x, " ", y);
+    }
+  )abc";
+  ASSERT_EQ(Run(program), "5 10 2 4");
+}
+
+TEST_P(TestEngines, AssignToItself) {
+  const auto program = R"abc(
+    program {
+        int x = 0;
+        boolean b = true;
+        if (b) x = (x = 1) + 1;
+        write(x, " ");
+        while (x < 5) x = x = x + 1;
+        write(x, " ");
+        x = x + (x = 10);
+        write(x, " ");
+        do x = x = x - 1; while (x > 15);
+        write(x);
+    }
+  )abc";
+  // the target isn't left on the stack when the value assigns it too
+  ASSERT_EQ(Run(program), "2 5 20 15");
+}
+
+TEST_P(TestEngines, Strings) {
+  const auto program = R"abc(
+    program {
+        string s = "a", t = "b", u;
+        int i = 0;
+        while (i < 2) {
+            s = s + s;
+            u = t;
+            t = t + "c" + u + t;
+            i = i + 1;
+        }
+        write(s, " ", t, " ", u, " ");
+        s = s + t + (s = "y");
+        write(s, " ");
+        write(s = s + "z" + t, " ", s, " ", s == u + "c", " ", s < t);
+    }
+  )abc";
+  ASSERT_EQ(Run(program),
+            "aaaa bcbbcbcbbbcbb bcbb aaaabcbbcbcbbbcbby "
+            "aaaabcbbcbcbbbcbbyzbcbbcbcbbbcbb "
+            "aaaabcbbcbcbbbcbbyzbcbbcbcbbbcbb 0 1");
+}
+
+TEST_P(TestEngines, ZeroDivision) {
+  ASSERT_THROW(Run(R"abc(
+    program {
+        int x = 0;
+        write(1 / x);
+    }
+  )abc"),
+               instructions::ZeroDivisionError);
+}
+
+// The division fails in the compiled code of the hot loop
+TEST_P(TestEngines, ZeroDivisionInLoop) {
+  ASSERT_THROW(Run(R"abc(
+    program {
+        int i = 5, s = 0;
+        while (true) {
+            s = s + 10 / i;
+            i = i - 1;
+        }
+    }
+  )abc"),
+               instructions::ZeroDivisionError);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , TestEngines, ::testing::ValuesIn(kEngines),
+    [](const ::testing::TestParamInfo<Engine>& info) {
+      return info.param.name;
+    });
+
+}  // namespace interpreter::test
@@ -1,5 +1,9 @@
 #include "test_interpreter.hpp"
 
+#include <algorithm>
+
+#include "interpreter/instructions/passes.hpp"
+
 #include <gtest/gtest.h>
 
 namespace interpreter::test {
@@ -73,4 +77,215 @@ TEST(TestInterpreter, DoWhile) {
   ASSERT_EQ(RunInterpreter(program), "10\n9\n8\n7\n6\n5\n4\n3\n2\n1\n0\n");
 }
 
+TEST(TestInterpreter, UndeclaredVariable) {
+  const auto program = R"abc(
+    program {
+        int x;
+        write("unreachable");
+        y = x;
+    }
+  )abc";
+  ASSERT_THROW(RunInterpreter(program), instructions::WriterError);
+}
+
+TEST(TestInterpreter, RedeclaredVariable) {
+  const auto program = R"abc(
+    program {
+        int x;
+        string x;
+    }
+  )abc";
+  ASSERT_THROW(RunInterpreter(program), instructions::WriterError);
+}
+
+TEST(TestInterpreter, InitialValues) {
+  const auto program = R"abc(
+    program {
+        int x = 5;
+        real y = 2;
+        string s = "str";
+        boolean b = true;
+        write(x, " ", y + 0.5, " ", s, " ", b);
+    }
+  )abc";
+  ASSERT_EQ(RunInterpreter(program), "5 2.5 str 1");
+}
+
+TEST(TestInterpreter, MaxStackDepth) {
+  std::istringstream code{R"abc(
+    program {
+        int x, y;
+        x = y + (y + (y + y));
+        if (x > 0) write(x);
+    }
+  )abc"};
+
+  instructions::InstructionsWriter writer;
+  ast::VisitCode(code, writer);
+  // the assigned variable is not pushed after the type specialization
+  ASSERT_EQ(writer.MakeBlock().GetMaxStackDepth(), 4);
+}
+
+TEST(TestInterpreter, FusedInstructions) {
+  const auto program = R"abc(
+    program {
+        int i = 10, odd = 0, n = 3;
+        while (i > 0) {
+            if (i % 2 != 0) odd = odd + i;
+            if (i <= n) n = n - 1;
+            i = i - 1;
+        }
+        write(odd, " ", i, " ", n);
+    }
+  )abc";
+
+  std::istringstream code{program};
+  instructions::InstructionsWriter writer;
+  ast::VisitCode(code, writer);
+  std::ostringstream listing;
+  instructions::Disassemble(writer.MakeBlock(), listing);
+
+  // the comparisons jump by themselves, the counters are decremented in place
+  ASSERT_NE(listing.str().find("JUMP_FALSE_GREATER_INT"), std::string::npos);
+  ASSERT_NE(listing.str().find("JUMP_FALSE_LESS_OR_EQ_INT"),
+            std::string::npos);
+  ASSERT_NE(listing.str().find("DECREMENT_INT"), std::string::npos);
+  ASSERT_EQ(listing.str().find("MINUS"), std::string::npos);
+  ASSERT_EQ(RunInterpreter(program), "25 0 0");
+}
+
+TEST(TestInterpreter, ConstantFolding) {
+  std::istringstream code{R"abc(
+    program {
+        if (true and 2 * 3 > 5) write("456" + "00", " ", (1 + 2.5) * 2);
+        else write("never");
+        while (false) write("never");
+    }
+  )abc"};
+
+  instructions::InstructionsWriter writer;
+  ast::VisitCode(code, writer);
+  const auto block = writer.MakeBlock();
+
+  std::ostringstream listing;
+  instructions::Disassemble(block, listing);
+  ASSERT_EQ(listing.str().find("JUMP"), std::string::npos);
+  ASSERT_EQ(listing.str().find("GOTO"), std::string::npos);
+  ASSERT_EQ(listing.str().find("PLUS"), std::string::npos);
+
+  std::istringstream input;
+  std::ostringstream output;
+  instructions::ExecutionContext context{.input = input, .output = output};
+  block.Execute(context);
+  ASSERT_EQ(output.str(), "45600 7");
+}
+
+TEST(TestInterpreter, ZeroDivisionIsNotFolded) {
+  ASSERT_THROW(RunInterpreter("program { write(1 / 0); }"),
+               instructions::ZeroDivisionError);
+}
+
+TEST(TestInterpreter, TypeMismatch) {
+  std::istringstream code{R"abc(
+    program {
+        int x;
+        x = "str";
+    }
+  )abc"};
+
+  instructions::InstructionsWriter writer;
+  ast::VisitCode(code, writer);
+  ASSERT_THROW(writer.MakeBlock(), instructions::TypeError);
+}
+
+TEST(TestInterpreter, SharedStrings) {
+  const auto program = R"abc(
+    program {
+        string s = "ab", t, u;
+        int i = 0;
+        while (i < 3) {
+            t = s;
+            s = s + "c";
+            u = t + s;
+            i = i + 1;
+        }
+        write(s, " ", t, " ", u, " ", s == t + "c");
+    }
+  )abc";
+  ASSERT_EQ(RunInterpreter(program), "abccc abcc abccabccc 1");
+}
+
+TEST(TestInterpreter, ConstantPool) {
+  std::istringstream code{R"abc(
+    program {
+        int i = 0;
+        while (i < 3) {
+            write(i, "\n");
+            write("\n", 0.0 * (0 - 1), " ", 0.0);
+            i = i + 1;
+        }
+    }
+  )abc"};
+
+  instructions::InstructionsWriter writer;
+  ast::VisitCode(code, writer);
+  const auto block = writer.MakeBlock();
+  const auto& constants = block.GetConstants();
+  ASSERT_EQ(std::count(constants.begin(), constants.end(),
+                       instructions::Value{"\n"}),
+            1);
+
+  std::istringstream input;
+  std::ostringstream output;
+  instructions::ExecutionContext context{.input = input, .output = output};
+  block.Execute(context);
+  // -0.0 is not merged with 0.0
+  ASSERT_EQ(output.str(), "0\n\n-0 01\n\n-0 02\n\n-0 0");
+}
+
+TEST(TestInterpreter, AppendToString) {
+  const auto program = R"abc(
+    program {
+        string s = "a", t = "b", u;
+        int i = 0;
+        while (i < 3) {
+            s = s + s;
+            i = i + 1;
+        }
+        write(s, " ");
+        s = s + t + (s = "y");
+        write(s, " ");
+        u = s + "c";
+        write(u, " ", s, " ");
+        write(s = s + "z" + t, " ", s, " ");
+        t = t + "1";
+        s = t + s;
+        write(s, " ", t, " ");
+        t = t + "c" + t;
+        write(t);
+    }
+  )abc";
+  ASSERT_EQ(RunInterpreter(program),
+            "aaaaaaaa aaaaaaaaby aaaaaaaabyc aaaaaaaaby aaaaaaaabyzb "
+            "aaaaaaaabyzb b1aaaaaaaabyzb b1 b1cb1");
+}
+
+TEST(TestInterpreter, CachedTopOfStack) {
+  const auto program = R"abc(
+    program {
+        int x = 7, y;
+        real r = 0.5;
+        string s = "s";
+        boolean b;
+        y = x * (x - 1) / 2 % 5;
+        write(y, " ", x + 1.5, " ", 2 * r + x, " ");
+        b = x * 2 > y + 10 and x < 8;
+        write(b, " ", s + "t", x, " ", (x = 3) + x * 2, " ");
+        r = x + y;
+        write(r, " ", x == 3, " ", 10 - (y = 4) - y, " ", y);
+    }
+  )abc";
+  ASSERT_EQ(RunInterpreter(program), "1 8.5 8 1 st7 9 4 1 2 4");
+}
+
 }  // namespace interpreter::test
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "interpreter/closures/compiler.hpp"
 #include "interpreter/instructions/writer.hpp"
 
 namespace interpreter::test {
@@ -18,10 +21,90 @@ inline std::string RunInterpreter(const std::string& code,
   const auto instructions_block = writer.MakeBlock();
 
   interpreter::instructions::ExecutionContext context{
-      .input = input_stream, .output = output_stream, .variables = {}};
+      .input = input_stream, .output = output_stream};
   instructions_block.Execute(context);
 
   return output_stream.str();
 }
 
+inline std::string RunRegisterInterpreter(
+    const std::string& code, const std::string& input = "",
+    std::optional<instructions::JitOptions> jit = std::nullopt) {
+  std::istringstream code_stream{code};
+  std::istringstream input_stream{input};
+  std::ostringstream output_stream{};
+
+  interpreter::instructions::InstructionsWriter writer;
+  interpreter::ast::VisitCode(code_stream, writer);
+  const auto register_block = writer.MakeRegisterBlock();
+
+  interpreter::instructions::ExecutionContext context{
+      .input = input_stream, .output = output_stream};
+  register_block.Execute(context, jit);
+
+  return output_stream.str();
+}
+
+inline std::string RunTieredInterpreter(
+    const std::string& code, const std::string& input = "",
+    instructions::TieringOptions options = {}) {
+  std::istringstream code_stream{code};
+  std::istringstream input_stream{input};
+  std::ostringstream output_stream{};
+
+  interpreter::instructions::InstructionsWriter writer;
+  interpreter::ast::VisitCode(code_stream, writer);
+  const auto tiered_block = writer.MakeTieredBlock(options);
+
+  interpreter::instructions::ExecutionContext context{
+      .input = input_stream, .output = output_stream};
+  tiered_block.Execute(context);
+
+  return output_stream.str();
+}
+
+// Runs the program once per input in a single batch
+inline std::vector<std::string> RunBatchInterpreter(
+    const std::string& code, const std::vector<std::string>& inputs,
+    std::optional<instructions::JitOptions> jit = std::nullopt) {
+  std::istringstream code_stream{code};
+  std::vector<std::istringstream> input_streams(inputs.begin(), inputs.end());
+  std::vector<std::ostringstream> output_streams(inputs.size());
+
+  interpreter::instructions::InstructionsWriter writer;
+  interpreter::ast::VisitCode(code_stream, writer);
+  const auto batch_block = writer.MakeBatchBlock();
+
+  std::vector<interpreter::instructions::ExecutionContext> contexts;
+  contexts.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    contexts.push_back(
+        {.input = input_streams[i], .output = output_streams[i]});
+  }
+  batch_block.Execute(contexts, jit);
+
+  std::vector<std::string> outputs;
+  for (const auto& output_stream : output_streams) {
+    outputs.push_back(output_stream.str());
+  }
+  return outputs;
+}
+
+inline std::string RunClosureInterpreter(const std::string& code,
+                                         const std::string& input = "") {
+  std::istringstream code_stream{code};
+  std::istringstream input_stream{input};
+  std::ostringstream output_stream{};
+
+  interpreter::closures::ClosureCompiler compiler;
+  interpreter::ast::VisitCode(code_stream, compiler);
+  const auto program = compiler.MakeProgram();
+
+  interpreter::instructions::ExecutionContext context{
+      .input = input_stream, .output = output_stream};
+  program.Execute(context);
+
+  return output_stream.str();
+}
+
 }  // namespace interpreter::test
@@ -0,0 +1,141 @@
+#include "interpreter/instructions/jit.hpp"
+#include "test_interpreter.hpp"
+
+#include <gtest/gtest.h>
+
+namespace interpreter::test {
+
+namespace {
+
+// Every loop is compiled on the first jump back to its header
+constexpr instructions::JitOptions kEagerJit{.hot_loop_iterations = 0};
+
+}  // namespace
+
+TEST(TestJit, IsPrime) {
+  const auto program = R"abc(
+    program {
+        int i, n;
+        boolean is_prime = true;
+        read(n);
+
+        i = 2;
+        while (i < n) {
+            if (n % i == 0) {
+                is_prime = false;
+                break;
+            }
+            i = i + 1;
+        }
+
+        write(is_prime, " ", i);
+    }
+  )abc";
+  ASSERT_EQ(RunRegisterInterpreter(program, "1000003", kEagerJit),
+            "1 1000003");
+  ASSERT_EQ(RunRegisterInterpreter(program, "999997", kEagerJit), "0 757");
+}
+
+TEST(TestJit, Arithmetic) {
+  const auto program = R"abc(
+    program {
+        int i = 0, n, k = 0, d;
+        real r = 0.5, s = 0, big = 1;
+        boolean b = false, c;
+        read(n);
+        while (i < n) {
+            k = k * 3 + i / 4 - i % 5;
+            s = s + r * i - i / 3.0 + (i + 1) / r;
+            d = s / 7;
+            b = not b and (i >= n / 2 or s < 100) or k == i;
+            c = s > k and r != s and i <= 10 and s >= r;
+            r = r + 0.25;
+            big = big * 10;
+            i = i + 1;
+        }
+        write(k, " ", s, " ", d, " ", b, " ", c, " ", r, " ", big, " ");
+
+        r = big - big;
+        write(r == r, r != r, r < 1, r > 1, r <= 1, r >= 1, r == 1);
+    }
+  )abc";
+  ASSERT_EQ(RunRegisterInterpreter(program, "400", kEagerJit),
+            RunInterpreter(program, "400"));
+}
+
+TEST(TestJit, NestedLoops) {
+  const auto program = R"abc(
+    program {
+        int i = 0, j, n, a = 0, b = 0, c = 0;
+        read(n);
+        while (i < n) {
+            j = 0;
+            while (true) {
+                if (j >= i) break;
+                if (j % 2 == 0) {
+                    if (j % 3 == 0) a = a + 1;
+                    else b = b + 1;
+                } else {
+                    if (j % 5 == 0 or j % 7 == 0) c = c + 1;
+                    else { j = j + 1; continue; }
+                }
+                j = j + 1;
+            }
+            i = i + 1;
+        }
+        do { i = i - 1; } while (i > 0 and i % 10 != 0);
+        write(a, " ", b, " ", c, " ", i);
+    }
+  )abc";
+  ASSERT_EQ(RunRegisterInterpreter(program, "60", kEagerJit),
+            "320 580 274 50");
+}
+
+TEST(TestJit, FallsBackToInterpreter) {
+  const auto program = R"abc(
+    program {
+        int i = 0, n;
+        string s = "", t;
+        read(n);
+        while (i < n) {
+            if (i % 3 == 0) {
+                write(i, " ");
+                s = s + "x";
+            }
+            t = s + "y";
+            i = i + 1;
+        }
+        write(s, " ", t);
+    }
+  )abc";
+  ASSERT_EQ(RunRegisterInterpreter(program, "20", kEagerJit),
+            RunInterpreter(program, "20"));
+}
+
+TEST(TestJit, CompilesLoop) {
+  std::istringstream code{R"abc(
+    program {
+        int n, result = 1;
+        read(n);
+        while (n > 0) {
+            result = result * n;
+            n = n - 1;
+        }
+        write(result);
+    }
+  )abc"};
+  instructions::InstructionsWriter writer;
+  ast::VisitCode(code, writer);
+  const auto block = writer.MakeRegisterBlock();
+
+  // the read and the write are left to the interpreter
+  const auto loop = instructions::CompileLoop(block.GetCode(), 0,
+                                              block.GetCode().size());
+#if defined(__x86_64__) && defined(__unix__)
+  ASSERT_TRUE(loop.has_value());
+#else
+  ASSERT_FALSE(loop.has_value());
+#endif
+}
+
+}  // namespace interpreter::test
@@ -0,0 +1,51 @@
+#include <algorithm>
+
+#include "interpreter/instructions/registers.hpp"
+#include "test_interpreter.hpp"
+
+#include <gtest/gtest.h>
+
+namespace interpreter::test {
+
+namespace {
+
+size_t CountLines(const std::string& listing) {
+  return std::count(listing.begin(), listing.end(), '\n');
+}
+
+}  // namespace
+
+TEST(TestRegisters, FewerInstructions) {
+  const auto program = R"abc(
+    program {
+        int i = 0, n, s = 0;
+        read(n);
+        while (i < n) {
+            s = s + i * i - (i % 7) * 2;
+            i = i + 1;
+        }
+        write(s);
+    }
+  )abc";
+
+  std::istringstream stack_code{program};
+  instructions::InstructionsWriter stack_writer;
+  ast::VisitCode(stack_code, stack_writer);
+  std::ostringstream stack_listing;
+  instructions::Disassemble(stack_writer.MakeBlock(), stack_listing);
+
+  std::istringstream register_code{program};
+  instructions::InstructionsWriter register_writer;
+  ast::VisitCode(register_code, register_writer);
+  std::ostringstream register_listing;
+  instructions::Disassemble(register_writer.MakeRegisterBlock(),
+                            register_listing);
+
+  // the operands of the stack code become the registers of the instructions
+  ASSERT_EQ(register_listing.str().find("MOVE"), std::string::npos);
+  ASSERT_LE(CountLines(register_listing.str()) * 5,
+            CountLines(stack_listing.str()) * 3);
+  ASSERT_EQ(RunRegisterInterpreter(program, "100"), "327760");
+}
+
+}  // namespace interpreter::test
@@ -0,0 +1,97 @@
+#include "interpreter/instructions/passes.hpp"
+#include "interpreter/instructions/tiered.hpp"
+#include "test_interpreter.hpp"
+
+#include <gtest/gtest.h>
+
+namespace interpreter::test {
+
+namespace {
+
+// The optimization starts at the first loop header
+constexpr instructions::TieringOptions kEagerTiering{.hot_loop_iterations =
+                                                         0};
+
+}  // namespace
+
+TEST(TestTiered, IsPrime) {
+  const auto program = R"abc(
+    program {
+        int i, n;
+        boolean is_prime = true;
+        read(n);
+
+        i = 2;
+        while (i < n) {
+            if (n % i == 0) {
+                is_prime = false;
+                break;
+            }
+            i = i + 1;
+        }
+
+        write(is_prime, " ", i);
+    }
+  )abc";
+  ASSERT_EQ(RunTieredInterpreter(program, "1000003"), "1 1000003");
+  ASSERT_EQ(RunTieredInterpreter(program, "999997", kEagerTiering), "0 757");
+  ASSERT_EQ(RunTieredInterpreter(program, "97", kEagerTiering), "1 97");
+}
+
+TEST(TestTiered, SwitchesInsideNestedLoops) {
+  const auto program = R"abc(
+    program {
+        int i = 0, j, n, a = 0, b = 0, c = 0;
+        string s = "";
+        read(n);
+        while (i < n) {
+            j = 0;
+            while (true) {
+                if (j >= i) break;
+                if (j % 2 == 0) {
+                    if (j % 3 == 0) a = a + 1;
+                    else b = b + 1;
+                } else {
+                    if (j % 5 == 0 or j % 7 == 0) c = c + 1;
+                    else { j = j + 1; continue; }
+                }
+                j = j + 1;
+            }
+            if (i % 10 == 0) s = s + "x" + s;
+            i = i + 1;
+        }
+        do {
+            i = i - 1;
+            if (i % 3 == 0) continue;
+            a = a - 1;
+        } while (i > 0 and i % 10 != 0);
+        write(a, " ", b, " ", c, " ", i, " ", s);
+    }
+  )abc";
+  const auto expected = RunInterpreter(program, "60");
+  for (const size_t iterations : {0, 1, 7, 100, 1000000}) {
+    ASSERT_EQ(RunTieredInterpreter(program, "60",
+                                   {.hot_loop_iterations = iterations}),
+              expected);
+  }
+}
+
+TEST(TestTiered, TypeErrorInColdCode) {
+  const auto program = R"abc(
+    program {
+        int i = 0, s = 0;
+        string t;
+        while (i < 10) {
+            s = s + i;
+            i = i + 1;
+        }
+        write(s);
+        if (s < 0) t = s;
+    }
+  )abc";
+  // the optimization fails, the code as written never reaches the error
+  ASSERT_EQ(RunTieredInterpreter(program, "", kEagerTiering), "45");
+  ASSERT_THROW(RunInterpreter(program), instructions::TypeError);
+}
+
+}  // namespace interpreter::test
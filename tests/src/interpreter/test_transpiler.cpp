@@ -0,0 +1,144 @@
+#include "interpreter/transpiler/transpiler.hpp"
+#include "test_interpreter.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+namespace interpreter::test {
+
+namespace {
+
+std::string Transpile(const std::string& code) {
+  std::istringstream code_stream{code};
+  transpiler::CppTranspiler transpiler;
+  ast::VisitCode(code_stream, transpiler);
+  return transpiler.MakeSource();
+}
+
+// Builds the generated source with the compiler of the tests and runs it,
+// returns std::nullopt if the program fails
+std::optional<std::string> RunTranspiled(const std::string& name,
+                                         const std::string& code,
+                                         const std::string& input = "") {
+  const auto directory = std::filesystem::temp_directory_path();
+  const auto path = [&](std::string_view extension) {
+    return (directory / ("interpreter2_" + name + std::string{extension}))
+        .string();
+  };
+  std::ofstream{path(".cpp")} << Transpile(code);
+  std::ofstream{path(".in")} << input;
+
+  const auto build = std::string{INTERPRETER2_CXX_COMPILER} +
+                     " -std=c++20 -o " + path(".out") + " " + path(".cpp");
+  if (std::system(build.c_str()) != 0) {
+    throw std::runtime_error{"Failed to build " + path(".cpp")};
+  }
+  const auto run = path(".out") + " < " + path(".in") + " > " +
+                   path(".txt") + " 2>/dev/null";
+  if (std::system(run.c_str()) != 0) {
+    return std::nullopt;
+  }
+
+  std::ifstream output{path(".txt")};
+  return std::string{std::istreambuf_iterator<char>{output}, {}};
+}
+
+}  // namespace
+
+TEST(TestTranspiler, SameOutput) {
+  const auto program = R"abc(
+    program {
+        int x = 1, y, n, i = 0, k = 7.9;
+        real r = 0.1, big = 100000.0, third;
+        boolean b = true, f = false;
+        string s = "a\"b\\", t = "tab\there", word;
+        read(n);
+        read(third);
+        read(word);
+        read(f);
+
+        y = x + (x = 5);
+        write(x, " ", y, " ");
+        y = (x = 2) + x;
+        write(x, " ", y, " ", k, "\n");
+
+        third = third / 3;
+        write(r + 0.2, " ", big * big * big * 3, " ", third, " ");
+        write(7 / 2, " ", (0 - 7) % 3);
+        write(" ", 7 / 2.0, " ", 1 < 1.5, " ", k = r * 30, "\n");
+
+        write(f and (x = 10) > 0, " ", x, " ", b or (x = 11) > 0, " ", x);
+        write(" ", not b or f, " ", f, "\n");
+
+        do {
+            i = i + 1;
+            if (i % 2 == 0) continue;
+            s = s + word + s;
+        } while (i < n);
+        write(s, " ", s < t, " ", s == s + "", " ", t, "\n");
+
+        i = 0;
+        while (true) {
+            i = i + 1;
+            if (i > 100) break;
+            if (i % 7 != 0) continue;
+            y = y + i;
+        }
+        write(i, " ", y);
+    }
+  )abc";
+  const auto input = "5 1.5 xy 1";
+  ASSERT_EQ(RunTranspiled("same_output", program, input),
+            RunInterpreter(program, input));
+}
+
+TEST(TestTranspiler, ZeroDivision) {
+  const auto program = R"abc(
+    program {
+        int i = 5, s = 0;
+        while (true) {
+            write(s, " ");
+            s = s + 10 / i;
+            i = i - 1;
+        }
+    }
+  )abc";
+  ASSERT_THROW(RunInterpreter(program), instructions::ZeroDivisionError);
+  ASSERT_EQ(RunTranspiled("zero_division", program), std::nullopt);
+}
+
+TEST(TestTranspiler, TypeMismatch) {
+  ASSERT_THROW(Transpile(R"abc(
+    program {
+        int x = 1;
+        string s;
+        s = x;
+    }
+  )abc"),
+               transpiler::TypeError);
+  ASSERT_THROW(Transpile(R"abc(
+    program {
+        int x = 1;
+        while (x) x = x - 1;
+    }
+  )abc"),
+               transpiler::TypeError);
+  ASSERT_THROW(Transpile(R"abc(
+    program {
+        boolean b;
+        b = true + false;
+    }
+  )abc"),
+               transpiler::TypeError);
+  ASSERT_THROW(Transpile(R"abc(
+    program {
+        write(y);
+    }
+  )abc"),
+               transpiler::TranspileError);
+}
+
+}  // namespace interpreter::test
@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <sstream>
 
 #include "interpreter/lexer/lexer.hpp"
+#include "interpreter/lexer/scanner.hpp"
+#include "interpreter/lexer/symbols.hpp"
+#include "interpreter/lexer/tokens.hpp"
 
 namespace test {
 
@@ -14,12 +18,14 @@ void MakeTestLexer(const std::string& program,
                    const std::vector<Lexeme>& expected_lexems) {
   std::istringstream input_stream{program};
 
-  std::vector<Lexeme> given_lexems;
-  for (auto lex : ParseLexems(input_stream)) {
-    given_lexems.push_back(std::move(lex));
+  // the lexeme is valid until the next one is scanned
+  size_t count = 0;
+  for (const auto& lex : ParseLexems(input_stream)) {
+    ASSERT_LT(count, expected_lexems.size());
+    ASSERT_EQ(lex, expected_lexems[count++]);
   }
 
-  ASSERT_EQ(given_lexems, expected_lexems);
+  ASSERT_EQ(count, expected_lexems.size());
 }
 
 void JustParse(const std::string& program) {
@@ -53,12 +59,18 @@ TEST(TestLexer, TestSpaces) {
 }
 
 TEST(TestLexer, EscapeSymbols) {
+  // the strings are kept as written
   MakeTestLexer(R"(  "a\b" "a\n" "a\t" "a\"" )",  //
-                {{LexType::VALUE_STR, "ab"},
-                 {LexType::VALUE_STR, "a\n"},
-                 {LexType::VALUE_STR, "a\t"},
-                 {LexType::VALUE_STR, "a\""},
+                {{LexType::VALUE_STR, R"(a\b)"},
+                 {LexType::VALUE_STR, R"(a\n)"},
+                 {LexType::VALUE_STR, R"(a\t)"},
+                 {LexType::VALUE_STR, R"(a\")"},
                  {LexType::NONE}});
+
+  ASSERT_EQ(Unescape(R"(a\b)"), "ab");
+  ASSERT_EQ(Unescape(R"(a\n)"), "a\n");
+  ASSERT_EQ(Unescape(R"(a\t\r)"), "a\t\r");
+  ASSERT_EQ(Unescape(R"(a\"\\)"), "a\"\\");
 }
 
 TEST(TestLexer, TestDeclarations) {
@@ -107,4 +119,200 @@ TEST(TestLexer, UnexpectedSymbols) {
   ASSERT_THROW(JustParse("!>"), LexicalError);
 }
 
+TEST(TestLexer, LexemsReferToSource) {
+  const std::string program = R"(
+    program {
+      // line comment
+      real r = 12.75, s = 0.1; /* block * comment */ int x_y;
+      string t = "a\"b\n";
+      x_y = (x_y + 10) * 2 - 3 / 4 % 5;
+      write(r >= s, r <= s, r != s, r == s, r < s, r > s, not (r / s));
+    }
+  )";
+  const auto lexems = ScanLexems(program);
+
+  ASSERT_EQ(lexems.back().type, LexType::NONE);
+
+  const auto is_in_source = [&program](std::string_view text) {
+    return program.data() <= text.data() &&
+           text.data() + text.size() <= program.data() + program.size();
+  };
+  for (const auto& lexeme : lexems) {
+    if (const auto* text = std::get_if<std::string_view>(&lexeme.data)) {
+      ASSERT_TRUE(is_in_source(*text));
+    }
+  }
+  const auto string = std::find_if(
+      lexems.begin(), lexems.end(),
+      [](const Lexeme& lexeme) { return lexeme.type == LexType::VALUE_STR; });
+  ASSERT_EQ(std::get<std::string_view>(string->data), R"(a\"b\n)");
+
+  static_assert(ScanLexems("x1")[1] == Lexeme{LexType::VALUE_INT, 1});
+
+  ASSERT_THROW(ScanLexems("@"), LexicalError);
+  ASSERT_THROW(ScanLexems("!"), LexicalError);
+  ASSERT_THROW(ScanLexems("12ab"), LexicalError);
+  ASSERT_THROW(ScanLexems("\"abc"), LexicalError);
+  ASSERT_THROW(ScanLexems("\"abc\\"), LexicalError);
+  ASSERT_THROW(ScanLexems("\"a\nbc\""), LexicalError);
+}
+
+TEST(TestLexer, KeywordsAndOperators) {
+  for (const auto& [word, type] : details::KEYWORDS) {
+    ASSERT_EQ(ScanLexems(word)[0], Lexeme{type});
+  }
+  for (const std::string_view word :
+       {"a", "re", "reads", "rea", "Program", "whilex", "if_", "iff", "o",
+        "endd", "booleans", "strinG"}) {
+    ASSERT_EQ(ScanLexems(word)[0], (Lexeme{LexType::ID, word}));
+  }
+
+  // the text of a lexeme is scanned to the same lexeme
+  const std::string program =
+      "program { int x = 1; write(x <= 2 != (x >= 3) == not x < 4 > 5); "
+      "x = x + 1 - 2 * 3 / 4 % 5; if (x and x or x) break; else continue; }";
+  std::ostringstream printed;
+  for (const auto& lexeme : ScanLexems(program)) {
+    printed << lexeme << ' ';
+  }
+  const auto text = printed.str();
+  ASSERT_TRUE(text.ends_with("} <none> "));
+  ASSERT_EQ(ScanLexems(text.substr(0, text.size() - 8)), ScanLexems(program));
+}
+
+TEST(TestLexer, LongSpacesCommentsAndStrings) {
+  // longer than the blocks of the vector instructions
+  const std::string spaces = " \t\n\v\f\r" + std::string(40, ' ') + "\n\n";
+  const std::string text(100, 'x');
+  const std::string program =
+      "/*" + text + "\n" + text + "\n*/" + spaces + "x" + spaces + "\"" + text +
+      "\\\"" + text + "\\\n" + text + "\\\\\"" + spaces + "// " + text +
+      "\n" + spaces + "y /* * */ " + spaces;
+
+  Scanner scanner{program};
+  std::vector<Lexeme> lexems;
+  do {
+    lexems.push_back(scanner.GetNext());
+    const auto newlines =
+        std::count(program.begin(), program.begin() + scanner.GetPosition(),
+                   '\n');
+    ASSERT_EQ(scanner.GetLine(), newlines + 1);
+  } while (lexems.back().type != LexType::NONE);
+
+  const auto string = text + "\\\"" + text + "\\\n" + text + "\\\\";
+  ASSERT_EQ(lexems, (std::vector<Lexeme>{{LexType::ID, "x"},
+                                          {LexType::VALUE_STR, string},
+                                          {LexType::ID, "y"},
+                                          {LexType::NONE}}));
+
+  std::string comment = "/*";
+  for (int i = 0; i < 10000; ++i) {
+    comment += i % 7 == 0 ? '\n' : 'c';
+  }
+  Scanner comment_scanner{comment + "*/"};
+  ASSERT_EQ(comment_scanner.GetNext(), Lexeme{});
+  ASSERT_EQ(comment_scanner.GetLine(),
+            std::count(comment.begin(), comment.end(), '\n') + 1);
+}
+
+TEST(TestLexer, ErrorLines) {
+  const auto message = [](const std::string& program) {
+    try {
+      JustParse(program);
+    } catch (const LexicalError& error) {
+      return std::string{error.what()};
+    }
+    return std::string{};
+  };
+
+  ASSERT_EQ(message("a\n\n  /* \n */ b $"),
+            "Unrecognized symbol '36' at line 4");
+  ASSERT_EQ(message("a\n\"b\\\nc\"\n 12ab"), "Unexpected symbol at line 4");
+  ASSERT_EQ(message("\n\n\"abc\n\""), "Unexpected end of line at line 3");
+}
+
+TEST(TestLexer, StreamLeavesInput) {
+  const std::string program =
+      "program { /* block\n comment */ int x = 10;\n"
+      "  string s = \"a\\\nb\"; x = x <\n= 1; }  42\nnext";
+  const auto lexems = ScanLexems(program.substr(0, program.find("42")));
+  std::istringstream input_stream{program};
+
+  size_t count = 0;
+  for (const auto& lex : ParseLexems(input_stream)) {
+    ASSERT_EQ(lex, lexems[count++]);
+    if (lex.type == LexType::CLOSING_BRACE) {
+      break;
+    }
+  }
+  ASSERT_EQ(count + 1, lexems.size());
+
+  // the program reads the rest of the stream
+  int value = 0;
+  input_stream >> value;
+  ASSERT_EQ(value, 42);
+}
+
+TEST(TestLexer, TokenBuffer) {
+  const std::string program =
+      "program { int x = 10; real y = 0.5; string s = \"a\\\"b\";\n"
+      "  { x = x + 1; y = y * x; } write(s, x, y); }  42 $ \"";
+  const auto text = program.substr(0, program.find("42"));
+  const auto lexems = ScanLexems(text);
+
+  // the text after the program isn't scanned, the source may go away
+  auto tokens = Tokenize(std::string{program});
+  ASSERT_EQ(tokens.GetSize(), lexems.size());
+  for (size_t i = 0; i < lexems.size(); ++i) {
+    ASSERT_EQ(tokens.GetLexeme(i), lexems[i]);
+  }
+  ASSERT_EQ(tokens.GetString(15), R"(a\"b)");
+
+  // the same names are the same symbols
+  ASSERT_EQ(tokens.GetType(3), LexType::ID);
+  ASSERT_EQ(tokens.GetSymbol(3), 0);
+  ASSERT_EQ(tokens.GetSymbol(18), 0);
+  ASSERT_EQ(tokens.GetSymbol(20), 0);
+  ASSERT_EQ(tokens.GetSymbol(8), 1);
+  ASSERT_EQ(tokens.GetSymbol(13), 2);
+
+  std::istringstream input_stream{program};
+  tokens = Tokenize(input_stream);
+  ASSERT_EQ(tokens.GetSize(), lexems.size());
+  for (size_t i = 0; i < lexems.size(); ++i) {
+    ASSERT_EQ(tokens.GetLexeme(i), lexems[i]);
+  }
+  int value = 0;
+  input_stream >> value;
+  ASSERT_EQ(value, 42);
+
+  ASSERT_EQ(Tokenize("x }").GetSize(), 3);
+  ASSERT_EQ(Tokenize("x {").GetLexeme(2), Lexeme{});
+  ASSERT_THROW(Tokenize("program { $ }"), LexicalError);
+}
+
+static_assert(Tokenize("program { x = 1; }").GetInt(4) == 1);
+
+static_assert([] {
+  SymbolTable symbols;
+  return symbols.Intern("a") == 0 && symbols.Intern("b") == 1 &&
+         symbols.Intern("a") == 0 && symbols.GetName(1) == "b";
+}());
+
+TEST(TestLexer, Symbols) {
+  SymbolTable symbols;
+  std::vector<std::string> names;
+  for (size_t i = 0; i < 1000; ++i) {
+    names.push_back("name" + std::to_string(i));
+    ASSERT_EQ(symbols.Intern(names.back()), i);
+  }
+
+  // the symbols stay the same after the rehashes
+  ASSERT_EQ(symbols.GetSize(), names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    ASSERT_EQ(symbols.Intern(names[i]), i);
+    ASSERT_EQ(symbols.GetName(i), names[i]);
+  }
+}
+
 }  // namespace test